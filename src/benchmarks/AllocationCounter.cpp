@@ -0,0 +1,179 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "AllocationCounter.h"
+
+// STL
+#include <atomic>
+#include <cstddef>
+
+// The allocations are counted by interposing the glibc allocation
+// functions, so that the allocations made by Qt are counted as well
+#if defined(__GLIBC__)
+#include <malloc.h>
+
+extern "C" {
+    void *__libc_malloc(size_t size);
+    void *__libc_calloc(size_t count, size_t size);
+    void *__libc_realloc(void *pointer, size_t size);
+    void __libc_free(void *pointer);
+}
+
+namespace {
+    std::atomic<bool> countAllocations { false };
+    std::atomic<quint64> allocationCount { 0 };
+    std::atomic<quint64> allocatedBytes { 0 };
+    std::atomic<qint64> liveByteCount { 0 };
+
+    inline bool isCounting()
+    {
+        return countAllocations.load(std::memory_order_relaxed);
+    }
+
+    inline void countAllocation(size_t size, void *result)
+    {
+        allocationCount.fetch_add(1, std::memory_order_relaxed);
+        allocatedBytes.fetch_add(size, std::memory_order_relaxed);
+
+        if (result) {
+            liveByteCount.fetch_add(qint64(malloc_usable_size(result)), std::memory_order_relaxed);
+        }
+    }
+
+    inline void countRelease(void *pointer)
+    {
+        if (pointer) {
+            liveByteCount.fetch_sub(qint64(malloc_usable_size(pointer)), std::memory_order_relaxed);
+        }
+    }
+} // namespace
+
+extern "C" void *malloc(size_t size)
+{
+    void *result = __libc_malloc(size);
+
+    if (isCounting()) {
+        countAllocation(size, result);
+    }
+
+    return result;
+}
+
+extern "C" void *calloc(size_t count, size_t size)
+{
+    void *result = __libc_calloc(count, size);
+
+    if (isCounting()) {
+        countAllocation(count * size, result);
+    }
+
+    return result;
+}
+
+extern "C" void *realloc(void *pointer, size_t size)
+{
+    const bool counting = isCounting();
+
+    if (counting) {
+        countRelease(pointer);
+    }
+
+    void *result = __libc_realloc(pointer, size);
+
+    if (counting) {
+        countAllocation(size, result);
+    }
+
+    return result;
+}
+
+extern "C" void free(void *pointer)
+{
+    if (isCounting()) {
+        countRelease(pointer);
+    }
+
+    __libc_free(pointer);
+}
+
+AllocationCounter::AllocationCounter()
+{
+    allocationCount = 0;
+    allocatedBytes = 0;
+    liveByteCount = 0;
+    countAllocations = true;
+}
+
+AllocationCounter::~AllocationCounter()
+{
+    countAllocations = false;
+}
+
+bool AllocationCounter::isSupported()
+{
+    return true;
+}
+
+quint64 AllocationCounter::count() const
+{
+    return allocationCount;
+}
+
+quint64 AllocationCounter::bytes() const
+{
+    return allocatedBytes;
+}
+
+qint64 AllocationCounter::liveBytes() const
+{
+    return liveByteCount;
+}
+
+#else
+
+AllocationCounter::AllocationCounter()
+{
+}
+
+AllocationCounter::~AllocationCounter()
+{
+}
+
+bool AllocationCounter::isSupported()
+{
+    return false;
+}
+
+quint64 AllocationCounter::count() const
+{
+    return 0;
+}
+
+quint64 AllocationCounter::bytes() const
+{
+    return 0;
+}
+
+qint64 AllocationCounter::liveBytes() const
+{
+    return 0;
+}
+
+#endif
@@ -0,0 +1,55 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef BENCHMARKS_ALLOCATION_COUNTER_H
+#define BENCHMARKS_ALLOCATION_COUNTER_H
+
+#include <QtGlobal>
+
+/**
+ * Counts the heap allocations made while it is alive, including the
+ * ones made by Qt. The glibc allocation functions are interposed for
+ * this, on the other systems nothing is counted (see isSupported).
+ */
+class AllocationCounter {
+public:
+    AllocationCounter();
+    ~AllocationCounter();
+
+    static bool isSupported();
+
+    /**
+     * The number of the allocations
+     */
+    quint64 count() const;
+
+    /**
+     * The number of the allocated bytes
+     */
+    quint64 bytes() const;
+
+    /**
+     * How much the heap usage changed, the allocated
+     * bytes minus the released ones
+     */
+    qint64 liveBytes() const;
+};
+
+#endif // BENCHMARKS_ALLOCATION_COUNTER_H
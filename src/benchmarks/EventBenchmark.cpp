@@ -0,0 +1,367 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Benchmark of the event records on their way from the D-Bus interface
+// of Resources to the resources database.
+//
+// The events are created from the UTF-8 strings, the way they come in
+// the D-Bus messages, collected into a batch, and stored into the event
+// partition the way StatsPlugin::openResourceEvent does it for the
+// Accessed events. This is done with the current Event and EventList,
+// and with a copy of their previous layout (QDateTime timestamps, QList
+// batches, and a copy of the strings for each event) to compare them.
+//
+// For both, we report the heap memory the batch holds per event, and
+// the time per event spent creating the batch and storing it.
+
+// Qt
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QList>
+#include <QRandomGenerator>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QVector>
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+// Utils
+#include <utils/string_pool.h>
+
+// Local
+#include <common/database/Database.h>
+#include <common/database/schema/ResourcesDatabaseSchema.h>
+#include <service/Event.h>
+#include "AllocationCounter.h"
+
+using Common::Database;
+namespace Schema = Common::ResourcesDatabaseSchema;
+
+namespace {
+
+    // The layout of Event before the timestamps became milliseconds
+    // since the epoch and the strings were interned
+    class LegacyEvent {
+    public:
+        LegacyEvent(const QString &application, quintptr wid,
+                    const QString &uri, int type)
+            : application(application)
+            , wid(wid)
+            , uri(uri)
+            , type(type)
+            , timestamp(QDateTime::currentDateTime())
+            , traceId(++lastTraceId)
+        {
+        }
+
+        QString application;
+        quintptr wid;
+        QString uri;
+        int type;
+        QDateTime timestamp;
+        quint64 traceId;
+
+        static quint64 lastTraceId;
+    };
+
+    quint64 LegacyEvent::lastTraceId = 0;
+
+    typedef QList<LegacyEvent> LegacyEventList;
+
+    // The arguments of a RegisterResourceEvent call
+    struct Message {
+        QByteArray application;
+        QByteArray uri;
+    };
+
+    const char *const applications[] = {
+        "org.kde.kate", "org.kde.okular", "org.kde.dolphin",
+        "org.kde.gwenview", "libreoffice-writer", "firefox"
+    };
+
+    const int applicationCount = sizeof(applications) / sizeof(applications[0]);
+
+    QVector<Message> generateMessages(int count, int resources)
+    {
+        QRandomGenerator random(20261019);
+        QVector<Message> result;
+        result.reserve(count);
+
+        for (int i = 0; i < count; ++i) {
+            // A few resources are used much more often than the others
+            const int resource = int(resources * std::pow(random.generateDouble(), 3));
+
+            result << Message {
+                applications[random.bounded(applicationCount)],
+                QByteArray("/home/user/Documents/Projects/2026/report-")
+                    + QByteArray::number(resource) + ".odt"
+            };
+        }
+
+        return result;
+    }
+
+    struct Measurement {
+        qint64 createTime;
+        qint64 storeTime;
+        qint64 heapBytes;
+        quint64 allocations;
+    };
+
+    const QString activity = QStringLiteral("e2e4c9a5-5ea2-4f6e-a3b2-bd3f0c2e6d41");
+
+    // Stores the batch like StatsPlugin::openResourceEvent does for the
+    // Accessed events, the start and the end being the same
+    template <typename Batch, typename Start>
+    qint64 storeBatch(Database &database, const Batch &batch, Start start)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        DATABASE_TRANSACTION(database);
+
+        QString partition;
+        QSqlQuery query = database.createQuery();
+
+        for (const auto &event: batch) {
+            const auto time = start(event);
+            const auto eventPartition = Schema::eventPartitionName(time);
+
+            if (partition != eventPartition) {
+                partition = eventPartition;
+                database.execQueries(Schema::eventPartitionSchema(partition));
+                query.prepare(QStringLiteral(
+                    "INSERT INTO %1"
+                    "        (usedActivity,  initiatingAgent,  targettedResource,  start,  end) "
+                    "VALUES (:usedActivity, :initiatingAgent, :targettedResource, :start, :end)"
+                ).arg(partition));
+            }
+
+            query.bindValue(QStringLiteral(":usedActivity"), activity);
+            query.bindValue(QStringLiteral(":initiatingAgent"), event.application);
+            query.bindValue(QStringLiteral(":targettedResource"), event.uri);
+            query.bindValue(QStringLiteral(":start"), time);
+            query.bindValue(QStringLiteral(":end"), time);
+            query.exec();
+        }
+
+        return timer.nsecsElapsed();
+    }
+
+    void clearEvents(Database &database)
+    {
+        DATABASE_TRANSACTION(database);
+
+        for (const auto &partition: Schema::eventPartitions(database)) {
+            database.execQuery(QStringLiteral("DELETE FROM %1").arg(partition));
+        }
+    }
+
+    Measurement measureLegacy(Database &database, const QVector<Message> &messages)
+    {
+        Measurement measurement;
+        LegacyEventList batch;
+
+        {
+            AllocationCounter allocations;
+            QElapsedTimer timer;
+            timer.start();
+
+            for (const auto &message: messages) {
+                batch << LegacyEvent(QString::fromUtf8(message.application), 0,
+                                     QString::fromUtf8(message.uri), Event::Accessed);
+            }
+
+            measurement.createTime = timer.nsecsElapsed();
+            measurement.heapBytes = allocations.liveBytes();
+            measurement.allocations = allocations.count();
+        }
+
+        measurement.storeTime = storeBatch(database, batch,
+            [] (const LegacyEvent &event) {
+                return event.timestamp.toSecsSinceEpoch();
+            });
+
+        return measurement;
+    }
+
+    Measurement measureCurrent(Database &database, const QVector<Message> &messages)
+    {
+        Measurement measurement;
+        EventList batch;
+
+        {
+            AllocationCounter allocations;
+            QElapsedTimer timer;
+            timer.start();
+
+            // The pool is counted as well, Resources keeps it
+            // for as long as it runs
+            kamd::utils::string_pool strings;
+
+            for (const auto &message: messages) {
+                batch << Event(strings.intern(QString::fromUtf8(message.application)), 0,
+                               strings.intern(QString::fromUtf8(message.uri)), Event::Accessed);
+            }
+
+            measurement.createTime = timer.nsecsElapsed();
+            measurement.heapBytes = allocations.liveBytes();
+            measurement.allocations = allocations.count();
+        }
+
+        measurement.storeTime = storeBatch(database, batch,
+            [] (const Event &event) {
+                return event.dateTime().toSecsSinceEpoch();
+            });
+
+        return measurement;
+    }
+
+    QJsonObject summarize(const QString &variant, int eventSize, int events,
+                          std::vector<Measurement> measurements)
+    {
+        const auto median = [&] (const std::function<qint64(const Measurement &)> &value) {
+            std::vector<qint64> values;
+            for (const auto &measurement: measurements) {
+                values.push_back(value(measurement));
+            }
+            std::sort(values.begin(), values.end());
+            return values[values.size() / 2];
+        };
+
+        const auto createTime = median([] (const Measurement &m) { return m.createTime; });
+        const auto storeTime  = median([] (const Measurement &m) { return m.storeTime; });
+        const auto heapBytes  = median([] (const Measurement &m) { return m.heapBytes; });
+        const auto allocationCount =
+            median([] (const Measurement &m) { return qint64(m.allocations); });
+
+        QTextStream(stderr) << variant << ": "
+                            << double(heapBytes) / events << " bytes/event, "
+                            << double(createTime) / events << " ns/event to create, "
+                            << double(storeTime) / events << " ns/event to store\n";
+
+        return QJsonObject {
+            { QStringLiteral("variant"),               variant },
+            { QStringLiteral("event_size"),            eventSize },
+            { QStringLiteral("heap_bytes_per_event"),  double(heapBytes) / events },
+            { QStringLiteral("allocations_per_event"), double(allocationCount) / events },
+            { QStringLiteral("create_ns_per_event"),   double(createTime) / events },
+            { QStringLiteral("store_ns_per_event"),    double(storeTime) / events },
+            { QStringLiteral("ns_per_event"),          double(createTime + storeTime) / events }
+        };
+    }
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral(
+        "Benchmarks the event records from the D-Bus interface to the database"));
+    parser.addHelpOption();
+
+    const QCommandLineOption eventsOption(QStringLiteral("events"),
+        QStringLiteral("Number of the events in a batch"),
+        QStringLiteral("count"), QStringLiteral("10000"));
+    const QCommandLineOption resourcesOption(QStringLiteral("resources"),
+        QStringLiteral("Number of the distinct resources the events are for"),
+        QStringLiteral("count"), QStringLiteral("500"));
+    const QCommandLineOption iterationsOption(QStringLiteral("iterations"),
+        QStringLiteral("How many times each of the variants is measured"),
+        QStringLiteral("count"), QStringLiteral("5"));
+    const QCommandLineOption outputOption(QStringLiteral("output"),
+        QStringLiteral("File to write the JSON results to, instead of the standard output"),
+        QStringLiteral("file"));
+
+    parser.addOptions({ eventsOption, resourcesOption, iterationsOption, outputOption });
+    parser.process(app);
+
+    const int eventCount = std::max(1, parser.value(eventsOption).toInt());
+    const int resourceCount = std::max(1, parser.value(resourcesOption).toInt());
+    const int iterations = std::max(1, parser.value(iterationsOption).toInt());
+
+    QTemporaryDir directory;
+    Schema::overridePath(directory.filePath(QStringLiteral("resources.sqlite")));
+
+    auto database = Database::instance(Database::ResourcesDatabase, Database::ReadWrite);
+
+    if (!database) {
+        QTextStream(stderr) << "Can not open the database\n";
+        return 1;
+    }
+
+    Schema::initSchema(*database);
+
+    const auto messages = generateMessages(eventCount, resourceCount);
+
+    std::vector<Measurement> legacy;
+    std::vector<Measurement> current;
+
+    // The variants are interleaved, so that both
+    // are affected the same by the database growing
+    for (int i = 0; i < iterations; ++i) {
+        legacy.push_back(measureLegacy(*database, messages));
+        clearEvents(*database);
+
+        current.push_back(measureCurrent(*database, messages));
+        clearEvents(*database);
+    }
+
+    const auto json = QJsonDocument(QJsonObject {
+            { QStringLiteral("benchmark"),   QStringLiteral("event-ingest") },
+            { QStringLiteral("events"),      eventCount },
+            { QStringLiteral("resources"),   resourceCount },
+            { QStringLiteral("iterations"),  iterations },
+            { QStringLiteral("allocations_counted"), AllocationCounter::isSupported() },
+            { QStringLiteral("results"),     QJsonArray {
+                summarize(QStringLiteral("legacy"), int(sizeof(LegacyEvent)),
+                          eventCount, legacy),
+                summarize(QStringLiteral("current"), int(sizeof(Event)),
+                          eventCount, current)
+            } }
+        }).toJson();
+
+    if (parser.isSet(outputOption)) {
+        QFile output(parser.value(outputOption));
+
+        if (!output.open(QIODevice::WriteOnly) || output.write(json) != json.size()) {
+            QTextStream(stderr) << "Can not write " << output.fileName() << '\n';
+            return 1;
+        }
+
+    } else {
+        QTextStream(stdout) << json;
+    }
+
+    return 0;
+}
@@ -0,0 +1,452 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Replays the resource events recorded by the daemon (see the
+// KAMD_RECORD_EVENTS variable in Resources.cpp) and measures how long
+// it takes for the events to be reflected in the resource scores.
+//
+// The events are sent either to the daemon on the current session bus,
+// or to a daemon started on a private dbus-daemon with its own database.
+
+// Qt
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDBusConnection>
+#include <QDBusConnectionInterface>
+#include <QDBusMessage>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QHash>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QProcess>
+#include <QTemporaryDir>
+#include <QTextStream>
+#include <QThread>
+#include <QTimer>
+#include <QUrl>
+#include <QVector>
+
+// STL
+#include <algorithm>
+#include <memory>
+#include <vector>
+
+// Local
+#include <common/dbus/common.h>
+#include <common/eventtrace.h>
+
+using Common::EventTrace::Record;
+
+namespace {
+
+    // A dbus-daemon and kactivitymanagerd running on it, with the
+    // data and configuration directories of their own
+    class PrivateDaemon {
+    public:
+        bool start(const QString &daemonPath, const QString &windowEvents)
+        {
+            if (!m_directory.isValid()) {
+                return false;
+            }
+
+            m_bus.setProgram(QStringLiteral("dbus-daemon"));
+            m_bus.setArguments({ QStringLiteral("--session"),
+                                 QStringLiteral("--nofork"),
+                                 QStringLiteral("--print-address=1") });
+            m_bus.start();
+
+            if (!m_bus.waitForStarted() || !m_bus.waitForReadyRead(10000)) {
+                QTextStream(stderr) << "Can not start dbus-daemon\n";
+                return false;
+            }
+
+            m_address = QString::fromLocal8Bit(m_bus.readLine()).trimmed();
+
+            auto environment = QProcessEnvironment::systemEnvironment();
+            environment.insert(QStringLiteral("DBUS_SESSION_BUS_ADDRESS"), m_address);
+            environment.insert(QStringLiteral("XDG_DATA_HOME"),
+                               m_directory.filePath(QStringLiteral("data")));
+            environment.insert(QStringLiteral("XDG_CONFIG_HOME"),
+                               m_directory.filePath(QStringLiteral("config")));
+            environment.remove(QStringLiteral("KAMD_RECORD_EVENTS"));
+
+            // Without a window system session, the window events
+            // can come from a script, see WindowEventSource
+            if (!windowEvents.isEmpty()) {
+                environment.insert(QStringLiteral("QT_QPA_PLATFORM"),
+                                   QStringLiteral("offscreen"));
+                environment.insert(QStringLiteral("KAMD_WINDOW_EVENT_SOURCE"),
+                                   QStringLiteral("synthetic:")
+                                       + QFileInfo(windowEvents).absoluteFilePath());
+            }
+
+            m_daemon.setProcessEnvironment(environment);
+            m_daemon.setProcessChannelMode(QProcess::ForwardedErrorChannel);
+            m_daemon.setProgram(daemonPath);
+            m_daemon.start();
+
+            if (!m_daemon.waitForStarted()) {
+                QTextStream(stderr) << "Can not start " << daemonPath << '\n';
+                return false;
+            }
+
+            return true;
+        }
+
+        QString address() const
+        {
+            return m_address;
+        }
+
+        ~PrivateDaemon()
+        {
+            for (auto process: { &m_daemon, &m_bus }) {
+                if (process->state() != QProcess::NotRunning) {
+                    process->terminate();
+                    if (!process->waitForFinished(5000)) {
+                        process->kill();
+                        process->waitForFinished();
+                    }
+                }
+            }
+        }
+
+    private:
+        QTemporaryDir m_directory;
+        QProcess m_bus;
+        QProcess m_daemon;
+        QString m_address;
+    };
+
+    // The daemon stores the local files by their canonical paths, and
+    // ignores the files that do not exist, we need to do the same
+    // to match the score updates with the events
+    QString storedUri(const QString &uri)
+    {
+        auto result = uri.startsWith(QStringLiteral("file://"))
+                          ? QUrl(uri).toLocalFile() : uri;
+
+        if (result.startsWith(QLatin1Char('/'))) {
+            QFileInfo file(result);
+            result = file.exists() ? file.canonicalFilePath() : QString();
+        }
+
+        return result;
+    }
+
+    // Only these events lead to the score updates
+    bool updatesScore(quint32 type)
+    {
+        return type == 0 /* Accessed */ || type == 3 /* Closed */;
+    }
+
+} // namespace
+
+class Replayer: public QObject {
+    Q_OBJECT
+
+public:
+    Replayer(const QDBusConnection &connection, const QVector<Record> &records,
+             double speed, int drainTimeout)
+        : m_connection(connection)
+        , m_records(records)
+        , m_speed(speed)
+        , m_next(0)
+        , m_lastScoreUpdate(0)
+        , m_sendingFinished(0)
+        , m_unscored(0)
+    {
+        m_connection.connect(KAMD_DBUS_SERVICE,
+            QStringLiteral("/ActivityManager/Resources/Scoring"),
+            QStringLiteral("org.kde.ActivityManager.ResourcesScoring"),
+            QStringLiteral("ResourceScoreUpdated"),
+            this, SLOT(scoreUpdated(QString, QString, QString, double, uint, uint)));
+
+        m_sendTimer.setSingleShot(true);
+        connect(&m_sendTimer, &QTimer::timeout, this, &Replayer::sendEvents);
+
+        // We are done when there were no score updates for a while
+        m_drainTimer.setSingleShot(true);
+        m_drainTimer.setInterval(drainTimeout * 1000);
+        connect(&m_drainTimer, &QTimer::timeout,
+                QCoreApplication::instance(), &QCoreApplication::quit);
+    }
+
+    void start()
+    {
+        m_clock.start();
+        sendEvents();
+    }
+
+    QJsonObject report() const
+    {
+        auto latencies = m_latencies;
+        std::sort(latencies.begin(), latencies.end());
+
+        const auto percentile = [&] (double fraction) {
+            return latencies.empty() ? 0.0
+                 : latencies[std::min(latencies.size() - 1,
+                                      size_t(fraction * latencies.size()))] / 1e6;
+        };
+
+        int pending = 0;
+        for (const auto &times: m_pending) {
+            pending += times.size();
+        }
+
+        const auto sendingTime = m_sendingFinished / 1e9;
+        const auto totalTime = std::max(m_sendingFinished, m_lastScoreUpdate) / 1e9;
+
+        return QJsonObject {
+            { QStringLiteral("events"),             m_records.size() },
+            { QStringLiteral("speed"),              m_speed },
+            { QStringLiteral("sending_s"),          sendingTime },
+            { QStringLiteral("sent_per_s"),         sendingTime > 0 ? m_records.size() / sendingTime : 0.0 },
+            { QStringLiteral("total_s"),            totalTime },
+            { QStringLiteral("processed_per_s"),    totalTime > 0 ? m_records.size() / totalTime : 0.0 },
+            { QStringLiteral("scored_events"),      int(m_latencies.size()) },
+            { QStringLiteral("unscored_events"),    m_unscored },
+            { QStringLiteral("unmatched_events"),   pending },
+            { QStringLiteral("latency_p50_ms"),     percentile(0.50) },
+            { QStringLiteral("latency_p90_ms"),     percentile(0.90) },
+            { QStringLiteral("latency_p99_ms"),     percentile(0.99) },
+            { QStringLiteral("latency_max_ms"),     percentile(1.0) }
+        };
+    }
+
+private Q_SLOTS:
+    void sendEvents()
+    {
+        const auto firstTimestamp = m_records.first().timestamp;
+
+        while (m_next < m_records.size()) {
+            const auto &record = m_records[m_next];
+
+            if (m_speed > 0) {
+                const auto due = qint64((record.timestamp - firstTimestamp) / m_speed);
+                const auto now = m_clock.elapsed();
+
+                if (due > now) {
+                    m_sendTimer.start(int(due - now));
+                    return;
+                }
+            }
+
+            send(record);
+            ++m_next;
+
+            // Letting the score updates in when sending at full speed
+            if (m_speed <= 0 && m_next % 1000 == 0) {
+                m_sendTimer.start(0);
+                return;
+            }
+        }
+
+        m_sendingFinished = m_clock.nsecsElapsed();
+        m_drainTimer.start();
+    }
+
+    void scoreUpdated(const QString &activity, const QString &client,
+                      const QString &resource, double score,
+                      uint lastUpdate, uint firstUpdate)
+    {
+        Q_UNUSED(activity);
+        Q_UNUSED(score);
+        Q_UNUSED(lastUpdate);
+        Q_UNUSED(firstUpdate);
+
+        const auto now = m_clock.nsecsElapsed();
+        m_lastScoreUpdate = now;
+
+        // The score updates are coalesced, one update covers all
+        // the events for the resource that were sent before it
+        const auto times = m_pending.take(qMakePair(client, resource));
+        for (const auto time: times) {
+            m_latencies.push_back(now - time);
+        }
+
+        if (m_drainTimer.isActive()) {
+            m_drainTimer.start();
+        }
+    }
+
+private:
+    void send(const Record &record)
+    {
+        auto message = QDBusMessage::createMethodCall(KAMD_DBUS_SERVICE,
+            KAMD_DBUS_OBJECT_PATH(Resources), KAMD_DBUS_OBJECT(Resources),
+            QStringLiteral("RegisterResourceEvent"));
+        message << record.application << record.windowId << record.uri << record.type;
+        message.setAutoStartService(false);
+
+        m_connection.send(message);
+
+        const auto uri = storedUri(record.uri);
+
+        if (updatesScore(record.type) && !uri.isEmpty()) {
+            m_pending[qMakePair(record.application, uri)] << m_clock.nsecsElapsed();
+        } else {
+            ++m_unscored;
+        }
+    }
+
+    QDBusConnection m_connection;
+    const QVector<Record> m_records;
+    const double m_speed;
+
+    QElapsedTimer m_clock;
+    QTimer m_sendTimer;
+    QTimer m_drainTimer;
+    int m_next;
+
+    QHash<QPair<QString, QString>, QVector<qint64>> m_pending;
+    std::vector<qint64> m_latencies;
+    qint64 m_lastScoreUpdate;
+    qint64 m_sendingFinished;
+    int m_unscored;
+};
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral(
+        "Replays the recorded resource events and measures their processing"));
+    parser.addHelpOption();
+    parser.addPositionalArgument(QStringLiteral("trace"),
+        QStringLiteral("The trace recorded with KAMD_RECORD_EVENTS"));
+
+    const QCommandLineOption speedOption(QStringLiteral("speed"),
+        QStringLiteral("How many times faster than recorded the events are sent, "
+                       "0 means as fast as possible"),
+        QStringLiteral("factor"), QStringLiteral("1"));
+    const QCommandLineOption daemonOption(QStringLiteral("daemon"),
+        QStringLiteral("Starts the specified kactivitymanagerd on a private bus, "
+                       "instead of using the one on the session bus"),
+        QStringLiteral("path"));
+    const QCommandLineOption windowEventsOption(QStringLiteral("window-events"),
+        QStringLiteral("Makes the private daemon run without a window system, "
+                       "with the window events generated by the specified script"),
+        QStringLiteral("script"));
+    const QCommandLineOption drainOption(QStringLiteral("drain-timeout"),
+        QStringLiteral("Seconds to wait for the score updates after the last event"),
+        QStringLiteral("seconds"), QStringLiteral("10"));
+    const QCommandLineOption outputOption(QStringLiteral("output"),
+        QStringLiteral("File to write the JSON results to, instead of the standard output"),
+        QStringLiteral("file"));
+
+    parser.addOptions({ speedOption, daemonOption, windowEventsOption,
+                        drainOption, outputOption });
+    parser.process(app);
+
+    if (parser.positionalArguments().size() != 1) {
+        parser.showHelp(1);
+    }
+
+    // Reading the trace
+
+    QFile traceFile(parser.positionalArguments().first());
+    if (!traceFile.open(QIODevice::ReadOnly)) {
+        QTextStream(stderr) << "Can not open " << traceFile.fileName() << '\n';
+        return 1;
+    }
+
+    QDataStream trace(&traceFile);
+    if (!Common::EventTrace::readHeader(trace)) {
+        QTextStream(stderr) << traceFile.fileName() << " is not an event trace\n";
+        return 1;
+    }
+
+    QVector<Record> records;
+    while (!trace.atEnd()) {
+        Record record;
+        Common::EventTrace::operator>>(trace, record);
+
+        if (trace.status() != QDataStream::Ok) {
+            // The daemon might have been killed while recording
+            break;
+        }
+
+        records << record;
+    }
+
+    if (records.isEmpty()) {
+        QTextStream(stderr) << "The trace is empty\n";
+        return 1;
+    }
+
+    // Connecting to the daemon
+
+    std::unique_ptr<PrivateDaemon> privateDaemon;
+    auto connection = QDBusConnection::sessionBus();
+
+    if (parser.isSet(daemonOption)) {
+        privateDaemon.reset(new PrivateDaemon());
+
+        if (!privateDaemon->start(parser.value(daemonOption),
+                                  parser.value(windowEventsOption))) {
+            return 1;
+        }
+
+        connection = QDBusConnection::connectToBus(privateDaemon->address(),
+                                                   QStringLiteral("kamd_replay"));
+    }
+
+    QElapsedTimer waiting;
+    waiting.start();
+    while (!connection.interface()->isServiceRegistered(KAMD_DBUS_SERVICE)) {
+        if (waiting.elapsed() > 30000) {
+            QTextStream(stderr) << "The daemon is not running\n";
+            return 1;
+        }
+        QThread::msleep(100);
+    }
+
+    // The plugins are loaded after the service is registered
+    QThread::sleep(1);
+
+    Replayer replayer(connection, records,
+                      parser.value(speedOption).toDouble(),
+                      parser.value(drainOption).toInt());
+    replayer.start();
+
+    app.exec();
+
+    const auto json = QJsonDocument(replayer.report()).toJson();
+
+    if (parser.isSet(outputOption)) {
+        QFile output(parser.value(outputOption));
+
+        if (!output.open(QIODevice::WriteOnly) || output.write(json) != json.size()) {
+            QTextStream(stderr) << "Can not write " << output.fileName() << '\n';
+            return 1;
+        }
+
+    } else {
+        QTextStream(stdout) << json;
+    }
+
+    return 0;
+}
+
+#include "ReplayEvents.moc"
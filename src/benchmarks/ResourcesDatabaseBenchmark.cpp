@@ -0,0 +1,765 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Benchmark of the SQL statements used by the resources database
+// plugin on the synthetic databases of different sizes.
+//
+// The statements are the ones the plugin in src/service/plugins/sqlite
+// executes, they are shared through ResourcesDatabaseStatements.h.
+//
+// The results are written as JSON, so that the runs before and after
+// a schema or an index change can be compared.
+
+// Qt
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QSqlError>
+#include <QSqlQuery>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+// STL
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <vector>
+
+// Local
+#include <common/database/Database.h>
+#include <common/database/schema/ResourcesDatabaseSchema.h>
+#include <common/database/schema/ResourcesDatabaseStatements.h>
+
+using Common::Database;
+namespace Schema = Common::ResourcesDatabaseSchema;
+namespace Statements = Common::ResourcesDatabaseStatements;
+
+namespace {
+
+    struct Scale {
+        QString name;
+        int events;
+        int resources;
+    };
+
+    const QList<Scale> scales {
+        { QStringLiteral("10k"),     10000,    100 },
+        { QStringLiteral("1M"),    1000000,  10000 },
+        { QStringLiteral("10M"),  10000000, 100000 }
+    };
+
+    const int agentCount = 20;
+    const int resourcesPerFolder = 100;
+    const int months = 12;
+
+    // Same as in ResourceStatsDeletion
+    const int rowsPerChunk = 2000;
+
+    QString activityName(int activity)
+    {
+        return QStringLiteral("00000000-0000-0000-0000-%1")
+                   .arg(activity, 12, 10, QLatin1Char('0'));
+    }
+
+    QString agentName(int agent)
+    {
+        return QStringLiteral("org.kde.application%1").arg(agent);
+    }
+
+    QString folderName(int resource)
+    {
+        return QStringLiteral("file:///home/user/Documents/folder%1/")
+                   .arg(resource / resourcesPerFolder);
+    }
+
+    QString resourceName(int resource)
+    {
+        return folderName(resource)
+               + QStringLiteral("document%1.odt").arg(resource);
+    }
+
+    // The usage of the resources is skewed, a few of them are used a lot
+    int randomResource(QRandomGenerator &random, int resources)
+    {
+        return std::min(resources - 1,
+                        int(resources * std::pow(random.generateDouble(), 3)));
+    }
+
+    bool exec(QSqlQuery &query)
+    {
+        if (!query.exec()) {
+            QTextStream(stderr) << "Query failed: " << query.lastQuery() << "\n    "
+                                << query.lastError().text() << '\n';
+            return false;
+        }
+
+        // Fetching the results, the daemon needs them as well
+        while (query.isSelect() && query.next()) {
+        }
+
+        query.finish();
+        return true;
+    }
+
+    class Generator {
+    public:
+        Generator(Database &database, const Scale &scale, int activities, qint64 now)
+            : m_database(database)
+            , m_scale(scale)
+            , m_activities(activities)
+            , m_now(now)
+            , m_random(20261019)
+        {
+        }
+
+        void generate()
+        {
+            Schema::initSchema(m_database);
+
+            // We do not care about durability while generating
+            m_database.setPragma(QStringLiteral("synchronous = 0"));
+
+            const auto thisMonth = QDateTime::fromSecsSinceEpoch(m_now, Qt::UTC).date();
+            const QDate firstMonth(thisMonth.year(), thisMonth.month(), 1);
+
+            for (int month = 0; month < months; ++month) {
+                const auto monthStart =
+                    QDateTime(firstMonth.addMonths(month - months + 1),
+                              QTime(0, 0), Qt::UTC).toSecsSinceEpoch();
+
+                generateEvents(monthStart, m_scale.events / months
+                    + (month < m_scale.events % months ? 1 : 0));
+            }
+
+            m_database.execQueries(Schema::eventViewSchema(Schema::eventPartitions(m_database)));
+
+            {
+                DATABASE_TRANSACTION(m_database);
+
+                // A score for every combination that was used
+                m_database.execQuery(QStringLiteral(
+                    "INSERT OR REPLACE INTO ResourceScoreCache "
+                    "SELECT usedActivity, initiatingAgent, targettedResource, "
+                    "       0, count(*), min(start), max(start) "
+                    "FROM ResourceEvent "
+                    "GROUP BY usedActivity, initiatingAgent, targettedResource"));
+
+                // The daily aggregates of the year before the events
+                m_database.execQuery(QStringLiteral(
+                    "INSERT OR REPLACE INTO ResourceEventDaily "
+                    "SELECT usedActivity, initiatingAgent, targettedResource, "
+                    "       (start / 86400) * 86400 - 365 * 86400, count(*), "
+                    "       sum(end = start), sum(CASE WHEN end > start THEN end - start ELSE 0 END) "
+                    "FROM ResourceEvent "
+                    "GROUP BY 1, 2, 3, 4"));
+
+                // The focus time of the year before the events, the
+                // focus events are not stored, the accesses stand in for them
+                m_database.execQuery(QStringLiteral(
+                    "INSERT OR REPLACE INTO ResourceFocusDaily "
+                    "SELECT usedActivity, initiatingAgent, targettedResource, "
+                    "       (start / 86400) * 86400 - 365 * 86400, count(*), "
+                    "       1000 * sum(CASE WHEN end > start THEN end - start ELSE 0 END) "
+                    "FROM ResourceEvent "
+                    "GROUP BY 1, 2, 3, 4"));
+
+                // The days the resources were modified on
+                m_database.execQuery(QStringLiteral(
+                    "INSERT OR REPLACE INTO ResourceEditStats "
+                    "SELECT usedActivity, initiatingAgent, targettedResource, "
+                    "       (end / 86400) * 86400, count(*), max(end) "
+                    "FROM ResourceEvent "
+                    "WHERE end > start "
+                    "GROUP BY 1, 2, 3, 4"));
+
+                m_database.execQuery(QStringLiteral(
+                    "INSERT OR REPLACE INTO ResourceInfo "
+                    "SELECT DISTINCT targettedResource, targettedResource, "
+                    "       'application/vnd.oasis.opendocument.text', 1, 1 "
+                    "FROM ResourceScoreCache"));
+
+                // Every tenth resource is linked to an activity
+                m_database.execQuery(QStringLiteral(
+                    "INSERT OR REPLACE INTO ResourceLink "
+                    "SELECT usedActivity, initiatingAgent, targettedResource "
+                    "FROM ResourceScoreCache "
+                    "WHERE abs(cachedScore) % 10 = 0"));
+            }
+
+            m_database.execQuery(QStringLiteral("ANALYZE"));
+            m_database.setPragma(QStringLiteral("synchronous = 2"));
+        }
+
+    private:
+        void generateEvents(qint64 monthStart, int count)
+        {
+            const auto partition = Schema::eventPartitionName(monthStart);
+            const auto monthEnd = std::min(Schema::eventPartitionEnd(partition), m_now);
+
+            // The indices are created after the events are inserted, the first
+            // statement of the partition schema creates the table
+            const auto schema = Schema::eventPartitionSchema(partition);
+            m_database.execQuery(schema.first());
+
+            auto insert = m_database.createQuery();
+            insert.prepare(Statements::openResourceEvent().arg(partition));
+
+            for (int inserted = 0; inserted < count; ) {
+                DATABASE_TRANSACTION(m_database);
+
+                for (int batch = 0; batch < 100000 && inserted < count; ++batch, ++inserted) {
+                    const auto resource = randomResource(m_random, m_scale.resources);
+                    const auto start = monthStart
+                        + qint64(m_random.bounded(double(monthEnd - monthStart)));
+
+                    // Half of the events are accessed, and a few are still open
+                    const auto kind = m_random.bounded(100);
+                    const auto end = kind < 50 ? QVariant(start)
+                                   : kind < 95 ? QVariant(start + m_random.bounded(2 * 60 * 60))
+                                               : QVariant();
+
+                    insert.bindValue(QStringLiteral(":usedActivity"),
+                                     activityName(m_random.bounded(m_activities)));
+                    insert.bindValue(QStringLiteral(":initiatingAgent"),
+                                     agentName(resource % agentCount));
+                    insert.bindValue(QStringLiteral(":targettedResource"),
+                                     resourceName(resource));
+                    insert.bindValue(QStringLiteral(":start"), start);
+                    insert.bindValue(QStringLiteral(":end"), end);
+                    exec(insert);
+                }
+            }
+
+            m_database.execQueries(schema.mid(1));
+        }
+
+        Database &m_database;
+        const Scale m_scale;
+        const int m_activities;
+        const qint64 m_now;
+        QRandomGenerator m_random;
+    };
+
+    class Benchmark {
+    public:
+        struct Parameters {
+            QString activity;
+            QString agent;
+            QString resource;
+            int resourceIndex;
+        };
+
+        typedef std::function<void(const Parameters &)> Operation;
+
+        Benchmark(Database &database, const Scale &scale, int activities,
+                  int iterations, qint64 now)
+            : m_database(database)
+            , m_scale(scale)
+            , m_activities(activities)
+            , m_iterations(iterations)
+            , m_now(now)
+            , m_random(20261020)
+        {
+            m_partitions = Schema::eventPartitions(m_database);
+        }
+
+        // Measures the operation, the operations that modify the database
+        // are executed in a transaction which is rolled back afterwards
+        void measure(const QString &name, bool modifies, const Operation &operation)
+        {
+            std::vector<qint64> samples;
+            samples.reserve(m_iterations);
+
+            for (int i = 0; i < m_iterations; ++i) {
+                const auto parameters = randomParameters();
+
+                if (modifies) {
+                    m_database.execQuery(QStringLiteral("BEGIN"));
+                }
+
+                QElapsedTimer timer;
+                timer.start();
+
+                operation(parameters);
+
+                samples.push_back(timer.nsecsElapsed());
+
+                if (modifies) {
+                    m_database.execQuery(QStringLiteral("ROLLBACK"));
+                }
+            }
+
+            std::sort(samples.begin(), samples.end());
+
+            const auto percentile = [&] (double fraction) {
+                return samples[std::min(samples.size() - 1,
+                                        size_t(fraction * samples.size()))] / 1000.0;
+            };
+
+            double total = 0;
+            for (const auto sample: samples) {
+                total += sample;
+            }
+
+            m_results.append(QJsonObject {
+                { QStringLiteral("name"),       name },
+                { QStringLiteral("modifies"),   modifies },
+                { QStringLiteral("iterations"), m_iterations },
+                { QStringLiteral("mean_us"),    total / samples.size() / 1000.0 },
+                { QStringLiteral("min_us"),     samples.front() / 1000.0 },
+                { QStringLiteral("p50_us"),     percentile(0.50) },
+                { QStringLiteral("p90_us"),     percentile(0.90) },
+                { QStringLiteral("p99_us"),     percentile(0.99) },
+                { QStringLiteral("max_us"),     samples.back() / 1000.0 }
+            });
+
+            QTextStream(stderr) << "    " << name << ": "
+                                << percentile(0.50) << " us (median)\n";
+        }
+
+        QSqlQuery &query(const QString &queryString)
+        {
+            auto query = m_queries.find(queryString);
+
+            if (query == m_queries.end()) {
+                query = m_queries.insert(queryString, m_database.createQuery());
+                query->prepare(queryString);
+            }
+
+            return *query;
+        }
+
+        void deleteFromAll(const Statements::DeletionFilters &filters,
+                           const QVariantHash &values)
+        {
+            const auto run = [&] (const QString &table, const QString &filter) {
+                auto &delete_ = query(Statements::deleteRows(table, filter));
+                for (auto it = values.cbegin(); it != values.cend(); ++it) {
+                    delete_.bindValue(it.key(), it.value());
+                }
+                exec(delete_);
+            };
+
+            for (const auto &partition: m_partitions) {
+                run(partition, filters.events);
+            }
+
+            run(QStringLiteral("ResourceEventDaily"), filters.dailyEvents);
+            run(QStringLiteral("ResourceFocusDaily"), filters.focusDaily);
+            run(QStringLiteral("ResourceEditStats"), filters.editStats);
+            run(QStringLiteral("ResourceScoreCache"), filters.scores);
+        }
+
+        void run()
+        {
+            const auto bindKey = [] (QSqlQuery &query, const Parameters &p) {
+                query.bindValue(QStringLiteral(":usedActivity"), p.activity);
+                query.bindValue(QStringLiteral(":initiatingAgent"), p.agent);
+                query.bindValue(QStringLiteral(":targettedResource"), p.resource);
+            };
+
+            // ResourceScoreCache
+
+            measure(QStringLiteral("ResourceScoreCache/dailyScoreAddition"), false,
+                [&] (const Parameters &p) {
+                    auto &q = query(Statements::dailyScoreAddition());
+                    bindKey(q, p);
+                    q.bindValue(QStringLiteral(":start"), m_now - 2 * 365 * 86400);
+                    exec(q);
+                });
+
+            measure(QStringLiteral("ResourceScoreCache/scoreAddition"), false,
+                [&] (const Parameters &p) {
+                    const auto since = m_now - 30 * 86400;
+                    for (const auto &partition: m_partitions) {
+                        if (Schema::eventPartitionEnd(partition) <= since) continue;
+
+                        auto &q = query(Statements::scoreAddition().arg(partition));
+                        bindKey(q, p);
+                        q.bindValue(QStringLiteral(":start"), since);
+                        exec(q);
+                    }
+                });
+
+            measure(QStringLiteral("ResourceScoreStore/saveScore"), true,
+                [&] (const Parameters &p) {
+                    auto &q = query(Statements::saveScore());
+                    bindKey(q, p);
+                    q.bindValue(QStringLiteral(":cachedScore"), 42.0);
+                    q.bindValue(QStringLiteral(":firstUpdate"), m_now - 86400);
+                    q.bindValue(QStringLiteral(":lastUpdate"), m_now);
+                    exec(q);
+                });
+
+            // StatsPlugin
+
+            measure(QStringLiteral("StatsPlugin/openResourceEvent"), true,
+                [&] (const Parameters &p) {
+                    auto &q = query(Statements::openResourceEvent().arg(Schema::eventPartitionName(m_now)));
+                    bindKey(q, p);
+                    q.bindValue(QStringLiteral(":start"), m_now);
+                    q.bindValue(QStringLiteral(":end"), QVariant());
+                    exec(q);
+                });
+
+            measure(QStringLiteral("StatsPlugin/closeResourceEvent"), true,
+                [&] (const Parameters &p) {
+                    for (const auto &partition: m_partitions) {
+                        auto &q = query(Statements::closeResourceEvent().arg(partition));
+                        bindKey(q, p);
+                        q.bindValue(QStringLiteral(":end"), m_now);
+                        exec(q);
+                    }
+                });
+
+            measure(QStringLiteral("StatsPlugin/getResourceInfo"), false,
+                [&] (const Parameters &p) {
+                    auto &q = query(Statements::getResourceInfo());
+                    q.bindValue(QStringLiteral(":targettedResource"), p.resource);
+                    exec(q);
+                });
+
+            measure(QStringLiteral("StatsPlugin/insertResourceInfo"), true,
+                [&] (const Parameters &p) {
+                    auto &q = query(Statements::insertResourceInfo());
+                    q.bindValue(QStringLiteral(":targettedResource"),
+                                p.resource + QStringLiteral(".new"));
+                    exec(q);
+                });
+
+            measure(QStringLiteral("StatsPlugin/saveResourceTitle"), true,
+                [&] (const Parameters &p) {
+                    auto &q = query(Statements::saveResourceTitle());
+                    q.bindValue(QStringLiteral(":targettedResource"), p.resource);
+                    q.bindValue(QStringLiteral(":title"), QStringLiteral("Title"));
+                    q.bindValue(QStringLiteral(":autoTitle"), 0);
+                    exec(q);
+                });
+
+            measure(QStringLiteral("StatsPlugin/saveResourceMimetype"), true,
+                [&] (const Parameters &p) {
+                    auto &q = query(Statements::saveResourceMimetype());
+                    q.bindValue(QStringLiteral(":targettedResource"), p.resource);
+                    q.bindValue(QStringLiteral(":mimetype"), QStringLiteral("text/plain"));
+                    q.bindValue(QStringLiteral(":autoMimetype"), 0);
+                    exec(q);
+                });
+
+            measure(QStringLiteral("StatsPlugin/deleteStatsForResource"), true,
+                [&] (const Parameters &p) {
+                    deleteFromAll(Statements::deleteResourceFilters(false), {
+                            { QStringLiteral(":usedActivity"), p.activity },
+                            { QStringLiteral(":initiatingAgent"), p.agent },
+                            { QStringLiteral(":resource"), p.resource }
+                        });
+                });
+
+            measure(QStringLiteral("StatsPlugin/deleteStatsForResourcePrefix"), true,
+                [&] (const Parameters &p) {
+                    // Deleting all the resources in a folder, the successor
+                    // of the prefix ending with a slash ends with a zero
+                    const auto folder = folderName(p.resourceIndex);
+                    deleteFromAll(Statements::deleteResourceFilters(true), {
+                            { QStringLiteral(":usedActivity"), QVariant(QVariant::String) },
+                            { QStringLiteral(":initiatingAgent"), QVariant(QVariant::String) },
+                            { QStringLiteral(":resource"), folder },
+                            { QStringLiteral(":resourceSuccessor"),
+                              folder.left(folder.size() - 1) + QLatin1Char('0') }
+                        });
+                });
+
+            measure(QStringLiteral("StatsPlugin/deleteRecentStats"), true,
+                [&] (const Parameters &p) {
+                    deleteFromAll(Statements::deleteRecentFilters(), {
+                            { QStringLiteral(":usedActivity"), p.activity },
+                            { QStringLiteral(":since"), m_now - 86400 }
+                        });
+                });
+
+            measure(QStringLiteral("StatsPlugin/deleteEarlierStats"), true,
+                [&] (const Parameters &p) {
+                    deleteFromAll(Statements::deleteEarlierFilters(), {
+                            { QStringLiteral(":usedActivity"), p.activity },
+                            { QStringLiteral(":time"), m_now - 6 * 30 * 86400 }
+                        });
+                });
+
+            measure(QStringLiteral("ResourceStatsDeletion/deleteChunk"), true,
+                [&] (const Parameters &p) {
+                    const auto &partition = m_partitions.last();
+                    auto &q = query(Statements::deleteChunk(
+                            partition, Statements::deleteEarlierFilters().events));
+                    q.bindValue(QStringLiteral(":firstRowId"), 1);
+                    q.bindValue(QStringLiteral(":lastRowId"), 1 + rowsPerChunk);
+                    q.bindValue(QStringLiteral(":usedActivity"), p.activity);
+                    q.bindValue(QStringLiteral(":time"), m_now);
+                    exec(q);
+                });
+
+            // ResourceFocusTime, each flush updates the existing row
+            // of the day, or inserts one when there is none
+
+            measure(QStringLiteral("ResourceFocusTime/updateFocusTime"), true,
+                [&] (const Parameters &p) {
+                    auto &q = query(Statements::updateFocusTime());
+                    bindKey(q, p);
+                    q.bindValue(QStringLiteral(":day"), (m_now / 86400) * 86400 - 365 * 86400);
+                    q.bindValue(QStringLiteral(":focusCount"), 1);
+                    q.bindValue(QStringLiteral(":focusDuration"), 60000);
+                    exec(q);
+                });
+
+            measure(QStringLiteral("ResourceFocusTime/insertFocusTime"), true,
+                [&] (const Parameters &p) {
+                    auto &q = query(Statements::insertFocusTime());
+                    bindKey(q, p);
+                    q.bindValue(QStringLiteral(":day"), (m_now / 86400) * 86400);
+                    q.bindValue(QStringLiteral(":focusCount"), 1);
+                    q.bindValue(QStringLiteral(":focusDuration"), 60000);
+                    exec(q);
+                });
+
+            // ResourceEditTracker
+
+            measure(QStringLiteral("ResourceEditTracker/updateEditStats"), true,
+                [&] (const Parameters &p) {
+                    auto &q = query(Statements::updateEditStats());
+                    bindKey(q, p);
+                    q.bindValue(QStringLiteral(":day"), (m_now / 86400) * 86400);
+                    q.bindValue(QStringLiteral(":lastEdit"), m_now);
+                    exec(q);
+                });
+
+            measure(QStringLiteral("ResourceEditTracker/insertEditStats"), true,
+                [&] (const Parameters &p) {
+                    auto &q = query(Statements::insertEditStats());
+                    q.bindValue(QStringLiteral(":usedActivity"), p.activity);
+                    q.bindValue(QStringLiteral(":initiatingAgent"), p.agent);
+                    q.bindValue(QStringLiteral(":targettedResource"),
+                                p.resource + QStringLiteral(".new"));
+                    q.bindValue(QStringLiteral(":day"), (m_now / 86400) * 86400);
+                    q.bindValue(QStringLiteral(":lastEdit"), m_now);
+                    exec(q);
+                });
+
+            // ResourceLinking
+
+            measure(QStringLiteral("ResourceLinking/linkResourceToActivity"), true,
+                [&] (const Parameters &p) {
+                    auto &q = query(Statements::linkResourceToActivity());
+                    bindKey(q, p);
+                    exec(q);
+                });
+
+            measure(QStringLiteral("ResourceLinking/unlinkResourceFromActivity"), true,
+                [&] (const Parameters &p) {
+                    auto &q = query(Statements::unlinkResourceFromActivity());
+                    bindKey(q, p);
+                    exec(q);
+                });
+
+            measure(QStringLiteral("ResourceLinking/unlinkResourceFromAllActivities"), true,
+                [&] (const Parameters &p) {
+                    auto &q = query(Statements::unlinkResourceFromAllActivities());
+                    q.bindValue(QStringLiteral(":initiatingAgent"), p.agent);
+                    q.bindValue(QStringLiteral(":targettedResource"), p.resource);
+                    exec(q);
+                });
+
+            measure(QStringLiteral("ResourceLinking/isResourceLinkedToActivity"), false,
+                [&] (const Parameters &p) {
+                    auto &q = query(Statements::isResourceLinkedToActivity());
+                    bindKey(q, p);
+                    exec(q);
+                });
+        }
+
+        QJsonArray results() const
+        {
+            return m_results;
+        }
+
+    private:
+        Parameters randomParameters()
+        {
+            const auto resource = randomResource(m_random, m_scale.resources);
+
+            return {
+                activityName(m_random.bounded(m_activities)),
+                agentName(resource % agentCount),
+                resourceName(resource),
+                resource
+            };
+        }
+
+        Database &m_database;
+        const Scale m_scale;
+        const int m_activities;
+        const int m_iterations;
+        const qint64 m_now;
+        QRandomGenerator m_random;
+
+        QStringList m_partitions;
+        QHash<QString, QSqlQuery> m_queries;
+        QJsonArray m_results;
+    };
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral(
+        "Benchmarks the resources database statements on synthetic databases"));
+    parser.addHelpOption();
+
+    const QCommandLineOption scalesOption(QStringLiteral("scales"),
+        QStringLiteral("Comma-separated list of the database sizes (10k, 1M, 10M)"),
+        QStringLiteral("scales"), QStringLiteral("10k"));
+    const QCommandLineOption activitiesOption(QStringLiteral("activities"),
+        QStringLiteral("Number of activities"),
+        QStringLiteral("count"), QStringLiteral("4"));
+    const QCommandLineOption iterationsOption(QStringLiteral("iterations"),
+        QStringLiteral("Number of times each statement is executed"),
+        QStringLiteral("count"), QStringLiteral("50"));
+    const QCommandLineOption directoryOption(QStringLiteral("directory"),
+        QStringLiteral("Directory for the generated databases. The existing "
+                       "databases in it are reused instead of generated again"),
+        QStringLiteral("path"));
+    const QCommandLineOption pragmasOption(QStringLiteral("pragmas"),
+        QStringLiteral("Semicolon-separated list of the pragmas applied to the connection, "
+                       "like the [Database] settings of kactivitymanagerdrc "
+                       "(for example \"cache_size = -8192;mmap_size = 67108864\")"),
+        QStringLiteral("pragmas"));
+    const QCommandLineOption outputOption(QStringLiteral("output"),
+        QStringLiteral("File to write the JSON results to, instead of the standard output"),
+        QStringLiteral("file"));
+
+    parser.addOptions({ scalesOption, activitiesOption, iterationsOption,
+                        directoryOption, pragmasOption, outputOption });
+    parser.process(app);
+
+    const auto pragmas = parser.value(pragmasOption).split(QLatin1Char(';'),
+                                                           QString::SkipEmptyParts);
+    Database::setConnectionPragmas(pragmas);
+
+    const auto activities = std::max(1, parser.value(activitiesOption).toInt());
+    const auto iterations = std::max(1, parser.value(iterationsOption).toInt());
+
+    QTemporaryDir temporaryDirectory;
+    const auto directory = parser.isSet(directoryOption)
+                               ? parser.value(directoryOption)
+                               : temporaryDirectory.path();
+    QDir().mkpath(directory);
+
+    const auto now = QDateTime::currentSecsSinceEpoch();
+
+    QJsonArray runs;
+
+    for (const auto &scaleName: parser.value(scalesOption).split(QLatin1Char(','))) {
+        const auto scale = std::find_if(scales.cbegin(), scales.cend(),
+            [&] (const Scale &scale) { return scale.name == scaleName.trimmed(); });
+
+        if (scale == scales.cend()) {
+            QTextStream(stderr) << "Unknown scale: " << scaleName << '\n';
+            return 1;
+        }
+
+        const auto path = QStringLiteral("%1/resources-%2-%3.sqlite")
+                              .arg(directory, scale->name).arg(activities);
+        const bool exists = QFile::exists(path);
+
+        Schema::overridePath(path);
+
+        QJsonObject run {
+            { QStringLiteral("scale"),      scale->name },
+            { QStringLiteral("events"),     scale->events },
+            { QStringLiteral("resources"),  scale->resources },
+            { QStringLiteral("activities"), activities },
+            { QStringLiteral("agents"),     agentCount },
+            { QStringLiteral("pragmas"),    QJsonArray::fromStringList(pragmas) }
+        };
+
+        {
+            auto database = Database::instance(Database::ResourcesDatabase,
+                                               Database::ReadWrite);
+
+            if (!database) {
+                QTextStream(stderr) << "Can not open the database " << path << '\n';
+                return 1;
+            }
+
+            QTextStream(stderr) << "Scale " << scale->name << '\n';
+
+            if (!exists) {
+                QElapsedTimer timer;
+                timer.start();
+
+                Generator(*database, *scale, activities, now).generate();
+
+                run[QStringLiteral("generation_ms")] = timer.elapsed();
+            }
+
+            Schema::initSchema(*database);
+
+            run[QStringLiteral("schema")] = Schema::version();
+            run[QStringLiteral("sqlite")] =
+                database->value(QStringLiteral("SELECT sqlite_version()")).toString();
+
+            Benchmark benchmark(*database, *scale, activities, iterations, now);
+            benchmark.run();
+
+            run[QStringLiteral("statements")] = benchmark.results();
+        }
+
+        run[QStringLiteral("database_size")] = QFileInfo(path).size();
+        runs.append(run);
+    }
+
+    const auto json = QJsonDocument(QJsonObject {
+            { QStringLiteral("benchmark"), QStringLiteral("resources-database") },
+            { QStringLiteral("timestamp"), now },
+            { QStringLiteral("runs"), runs }
+        }).toJson();
+
+    if (parser.isSet(outputOption)) {
+        QFile output(parser.value(outputOption));
+
+        if (!output.open(QIODevice::WriteOnly) || output.write(json) != json.size()) {
+            QTextStream(stderr) << "Can not write " << output.fileName() << '\n';
+            return 1;
+        }
+
+    } else {
+        QTextStream(stdout) << json;
+    }
+
+    return 0;
+}
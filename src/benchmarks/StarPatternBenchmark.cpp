@@ -0,0 +1,353 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Microbenchmarks of the star pattern helpers from common/database,
+// and of the URL filtering done by StatsPlugin::acceptedEvent.
+//
+// The helpers are compared against the previous implementation of
+// parseStarPattern which is kept here as the reference. The benchmark
+// fails if the results differ, or if the current implementation is
+// slower than the reference by more than the allowed ratio.
+
+// Qt
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QRegExp>
+#include <QTextStream>
+
+// STL
+#include <algorithm>
+#include <functional>
+
+// Local
+#include <common/database/Database.h>
+
+namespace {
+
+    // The implementation of parseStarPattern before it was rewritten,
+    // allocating a string for each of the parts between the stars
+    template <typename EscapeFunction>
+    QString referenceParseStarPattern(const QString &pattern, const QString &joker,
+                                      EscapeFunction escape)
+    {
+        const auto begin     = pattern.constBegin();
+        const auto end       = pattern.constEnd();
+
+        auto currentStart    = pattern.constBegin();
+        auto currentPosition = pattern.constBegin();
+
+        bool isEscaped = false;
+
+        auto stringFromIterators = [&](const QString::const_iterator &currentStart,
+                                       const QString::const_iterator &currentPosition) {
+            return pattern.mid(
+                    std::distance(begin, currentStart),
+                    std::distance(currentStart, currentPosition));
+        };
+
+        QString resultPattern;
+        resultPattern.reserve(pattern.size() * 1.5);
+
+        for (; currentPosition != end; ++currentPosition) {
+            if (isEscaped) {
+                isEscaped = false;
+
+            } else if (*currentPosition == QLatin1Char('\\')) {
+                isEscaped = true;
+
+            } else if (*currentPosition == QLatin1Char('*')) {
+                resultPattern.append(escape(stringFromIterators(
+                                        currentStart, currentPosition)) + joker);
+                currentStart = currentPosition + 1;
+            }
+        }
+
+        if (currentStart != currentPosition) {
+            resultPattern.append(escape(stringFromIterators(
+                                    currentStart, currentPosition)));
+        }
+
+        return resultPattern;
+    }
+
+    QString referenceEscapeSqliteLikePattern(QString pattern)
+    {
+        return pattern.replace(QLatin1String("%"), QLatin1String("\\%"))
+                      .replace(QLatin1String("_"), QLatin1String("\\_"));
+    }
+
+    QString referenceStarPatternToLike(const QString &pattern)
+    {
+        return referenceParseStarPattern(pattern, QStringLiteral("%"),
+                                         referenceEscapeSqliteLikePattern);
+    }
+
+    QString referenceStarPatternToRegex(const QString &pattern)
+    {
+        return referenceParseStarPattern(pattern, QStringLiteral(".*"), QRegExp::escape);
+    }
+
+    QString currentStarPatternToRegex(const QString &pattern)
+    {
+        return Common::parseStarPattern(pattern, QStringLiteral(".*"),
+                                        Common::escapeRegExpCharacter);
+    }
+
+    // The default url-filters of the sqlite plugin, and the ones
+    // the users tend to add
+    const QStringList filters {
+        QStringLiteral("about:*"),
+        QStringLiteral("*/.*"),
+        QStringLiteral("/"),
+        QStringLiteral("/tmp/*"),
+        QStringLiteral("*/.cache/*"),
+        QStringLiteral("*/node_modules/*"),
+        QStringLiteral("*/.git/*"),
+        QStringLiteral("*~"),
+        QStringLiteral("*.tmp"),
+        QStringLiteral("*.part"),
+        QStringLiteral("smb://*"),
+        QStringLiteral("/home/*/Downloads/*.iso"),
+        QStringLiteral("/media/*"),
+        QStringLiteral("*/build_*/*"),
+        QStringLiteral("*/100%_done/*"),
+        QStringLiteral("/home/user/Private\\*/*")
+    };
+
+    QStringList uriCorpus(int count)
+    {
+        QRandomGenerator random(20261019);
+
+        const QStringList folders {
+            QStringLiteral("/home/user/Documents/"),
+            QStringLiteral("/home/user/Documents/projects/kactivities/src/"),
+            QStringLiteral("/home/user/Pictures/2026/holidays/"),
+            QStringLiteral("/home/user/Downloads/"),
+            QStringLiteral("/home/user/.config/"),
+            QStringLiteral("/home/user/src/app/node_modules/lodash/"),
+            QStringLiteral("/tmp/"),
+            QStringLiteral("/media/usb/"),
+            QStringLiteral("file:///home/user/Music/"),
+            QStringLiteral("https://kde.org/"),
+            QStringLiteral("applications:")
+        };
+
+        const QStringList names {
+            QStringLiteral("report.odt"),
+            QStringLiteral("photo_%1.jpg"),
+            QStringLiteral("main.cpp"),
+            QStringLiteral("notes.txt~"),
+            QStringLiteral("download.part"),
+            QStringLiteral("image.iso"),
+            QStringLiteral("org.kde.dolphin.desktop")
+        };
+
+        QStringList result;
+        result.reserve(count);
+
+        for (int i = 0; i < count; ++i) {
+            result << folders[random.bounded(folders.size())]
+                          + names[random.bounded(names.size())].arg(i);
+        }
+
+        result << QStringLiteral("/") << QStringLiteral("about:blank");
+
+        return result;
+    }
+
+    // Runs the function until it took at least the minimum time,
+    // and returns the time per call in nanoseconds
+    template <typename Function>
+    double measure(Function function, int calls, qint64 minimumTime)
+    {
+        QElapsedTimer timer;
+        timer.start();
+
+        qint64 rounds = 0;
+        do {
+            for (int i = 0; i < calls; ++i) {
+                function(i);
+            }
+            ++rounds;
+        } while (timer.nsecsElapsed() < minimumTime);
+
+        return double(timer.nsecsElapsed()) / (rounds * calls);
+    }
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral(
+        "Benchmarks the star pattern helpers and the URL filtering"));
+    parser.addHelpOption();
+
+    const QCommandLineOption ratioOption(QStringLiteral("max-ratio"),
+        QStringLiteral("The largest allowed ratio of the time of the current "
+                       "parseStarPattern and the reference one"),
+        QStringLiteral("ratio"), QStringLiteral("1.2"));
+    const QCommandLineOption timeOption(QStringLiteral("time"),
+        QStringLiteral("Minimum time spent in each benchmark, in milliseconds"),
+        QStringLiteral("ms"), QStringLiteral("500"));
+    const QCommandLineOption outputOption(QStringLiteral("output"),
+        QStringLiteral("File to write the JSON results to, instead of the standard output"),
+        QStringLiteral("file"));
+
+    parser.addOptions({ ratioOption, timeOption, outputOption });
+    parser.process(app);
+
+    const auto maxRatio = parser.value(ratioOption).toDouble();
+    const auto minimumTime = parser.value(timeOption).toLongLong() * 1000000;
+
+    // The patterns are the filters, and the resource patterns passed
+    // to DeleteStatsForResource which are the URIs with stars
+    auto patterns = filters;
+    const auto uris = uriCorpus(10000);
+    for (int i = 0; i < 1000; ++i) {
+        auto pattern = uris[i];
+        patterns << pattern.replace(QLatin1Char('/'), QStringLiteral("/*"));
+    }
+
+    // The results need to be the same as with the reference implementation
+
+    int failures = 0;
+
+    for (const auto &pattern: patterns) {
+        const auto like = Common::starPatternToLike(pattern);
+        const auto regex = currentStarPatternToRegex(pattern);
+
+        if (like != referenceStarPatternToLike(pattern)) {
+            QTextStream(stderr) << "starPatternToLike differs for " << pattern << ": "
+                                << like << " != " << referenceStarPatternToLike(pattern) << '\n';
+            ++failures;
+        }
+
+        if (regex != referenceStarPatternToRegex(pattern)) {
+            QTextStream(stderr) << "starPatternToRegex differs for " << pattern << ": "
+                                << regex << " != " << referenceStarPatternToRegex(pattern) << '\n';
+            ++failures;
+        }
+    }
+
+    // The timings
+
+    QJsonArray results;
+    const auto report = [&] (const QString &name, double time) {
+        results.append(QJsonObject {
+            { QStringLiteral("name"),    name },
+            { QStringLiteral("ns_per_call"), time }
+        });
+        QTextStream(stderr) << name << ": " << time << " ns\n";
+    };
+
+    const int patternCount = patterns.size();
+
+    const auto likeTime = measure([&] (int i) {
+            Common::starPatternToLike(patterns[i]);
+        }, patternCount, minimumTime);
+    const auto referenceLikeTime = measure([&] (int i) {
+            referenceStarPatternToLike(patterns[i]);
+        }, patternCount, minimumTime);
+    const auto regexTime = measure([&] (int i) {
+            currentStarPatternToRegex(patterns[i]);
+        }, patternCount, minimumTime);
+    const auto referenceRegexTime = measure([&] (int i) {
+            referenceStarPatternToRegex(patterns[i]);
+        }, patternCount, minimumTime);
+
+    report(QStringLiteral("starPatternToLike"), likeTime);
+    report(QStringLiteral("starPatternToLike/reference"), referenceLikeTime);
+    report(QStringLiteral("parseStarPattern/regex"), regexTime);
+    report(QStringLiteral("parseStarPattern/regex/reference"), referenceRegexTime);
+
+    report(QStringLiteral("starPatternToRegex"), measure([&] (int i) {
+            Common::starPatternToRegex(patterns[i]);
+        }, patternCount, minimumTime));
+
+    report(QStringLiteral("StarPattern"), measure([&] (int i) {
+            Common::StarPattern pattern(patterns[i]);
+        }, patternCount, minimumTime));
+
+    // The URL filtering of StatsPlugin::acceptedEvent, for every
+    // event, all the filters are matched against the URI
+
+    QList<QRegExp> urlFilters;
+    for (const auto &filter: filters) {
+        urlFilters << Common::starPatternToRegex(filter);
+    }
+
+    int accepted = 0;
+    report(QStringLiteral("acceptedEvent/urlFilters"), measure([&] (int i) {
+            accepted += !Common::matchesAnyFilter(urlFilters, uris[i]);
+        }, uris.size(), minimumTime));
+
+    QList<Common::StarPattern> starFilters;
+    for (const auto &filter: filters) {
+        starFilters << Common::StarPattern(filter);
+    }
+
+    report(QStringLiteral("acceptedEvent/starPatterns"), measure([&] (int i) {
+            accepted += std::none_of(starFilters.cbegin(), starFilters.cend(),
+                [&] (const Common::StarPattern &filter) { return filter.matches(uris[i]); });
+        }, uris.size(), minimumTime));
+
+    // Regression guard
+
+    const auto likeRatio = likeTime / referenceLikeTime;
+    const auto regexRatio = regexTime / referenceRegexTime;
+
+    if (likeRatio > maxRatio || regexRatio > maxRatio) {
+        QTextStream(stderr) << "parseStarPattern is slower than the reference: "
+                            << likeRatio << ", " << regexRatio << '\n';
+        ++failures;
+    }
+
+    const auto json = QJsonDocument(QJsonObject {
+            { QStringLiteral("benchmark"), QStringLiteral("star-patterns") },
+            { QStringLiteral("patterns"),  patternCount },
+            { QStringLiteral("uris"),      uris.size() },
+            { QStringLiteral("accepted"),  accepted },
+            { QStringLiteral("failures"),  failures },
+            { QStringLiteral("results"),   results }
+        }).toJson();
+
+    if (parser.isSet(outputOption)) {
+        QFile output(parser.value(outputOption));
+
+        if (!output.open(QIODevice::WriteOnly) || output.write(json) != json.size()) {
+            QTextStream(stderr) << "Can not write " << output.fileName() << '\n';
+            return 1;
+        }
+
+    } else {
+        QTextStream(stdout) << json;
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -0,0 +1,347 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Benchmark of the parser of the recently-used.xbel file that the GTK
+// event spy plugin reparses each time the file changes.
+//
+// The files with the specified numbers of bookmarks are generated,
+// a small part of them changed after the time of the last update.
+// For each of the files, we measure the time it takes to parse it,
+// the number of heap allocations done while parsing, and the number
+// of events the plugin would produce.
+
+// Qt
+#include <QCommandLineParser>
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QDir>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QFileInfo>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QRandomGenerator>
+#include <QTemporaryDir>
+#include <QTextStream>
+
+// STL
+#include <algorithm>
+#include <vector>
+
+// Local
+#include <service/plugins/gtk-eventspy/XbelParser.h>
+#include "AllocationCounter.h"
+
+namespace {
+
+    // The time of the last update of the plugin, the bookmarks
+    // changed after it produce the events
+    const QDateTime lastUpdate(QDate(2026, 10, 1), QTime(12, 0), Qt::UTC);
+
+    struct GeneratedApplication {
+        const char *exec;
+        const char *mimetype;
+        const char *extension;
+    };
+
+    const GeneratedApplication applications[] = {
+        { "gedit %U",                 "text/plain",      "txt"  },
+        { "org.gnome.TextEditor %U",  "text/markdown",   "md"   },
+        { "eog %U",                   "image/png",       "png"  },
+        { "evince %U",                "application/pdf", "pdf"  },
+        { "libreoffice --writer %U",  "application/vnd.oasis.opendocument.text", "odt" },
+        { "inkscape %F",              "image/svg+xml",   "svg"  },
+        { "totem %U",                 "video/mp4",       "mp4"  },
+        { "gimp-2.10 %U",             "image/x-xcf",     "xcf"  }
+    };
+
+    const int applicationCount = sizeof(applications) / sizeof(applications[0]);
+
+    const char *const folders[] = {
+        "Documents", "Documents/Work%20Reports", "Pictures/2026", "Downloads",
+        "src/kactivities/src/service", "Music/Albums", "Videos", "Desktop"
+    };
+
+    QString timestamp(const QDateTime &time)
+    {
+        // GTK writes the timestamps with microseconds
+        return time.toString(QStringLiteral("yyyy-MM-ddTHH:mm:ss.zzz"))
+               + QStringLiteral("000Z");
+    }
+
+    // Generates the file in the format used by GtkRecentManager,
+    // returns the number of the bookmarks that changed after lastUpdate
+    int generateXbel(const QString &path, int count, double recentRatio)
+    {
+        QFile file(path);
+        if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+            return -1;
+        }
+
+        QRandomGenerator random(quint32(count));
+        QTextStream out(&file);
+        out.setCodec("UTF-8");
+
+        out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\n"
+               "<xbel version=\"1.0\"\n"
+               "      xmlns:bookmark=\"http://www.freedesktop.org/standards/desktop-bookmarks\"\n"
+               "      xmlns:mime=\"http://www.freedesktop.org/standards/shared-mime-info\"\n"
+               ">\n";
+
+        int recent = 0;
+        const auto oldest = lastUpdate.addDays(-365);
+
+        for (int i = 0; i < count; ++i) {
+            const bool isRecent = random.generateDouble() < recentRatio;
+            recent += isRecent;
+
+            const auto added = oldest.addSecs(random.bounded(300 * 24 * 3600));
+            const auto modified = isRecent
+                ? lastUpdate.addSecs(1 + random.bounded(3600))
+                : added.addSecs(random.bounded(30 * 24 * 3600));
+
+            const auto &application = applications[random.bounded(applicationCount)];
+
+            out << "  <bookmark href=\"file:///home/user/"
+                << folders[random.bounded(int(sizeof(folders) / sizeof(folders[0])))]
+                << "/file_" << i << '.' << application.extension << "\""
+                << " added=\"" << timestamp(added) << "\""
+                << " modified=\"" << timestamp(modified) << "\""
+                << " visited=\"" << timestamp(added) << "\">\n"
+                   "    <info>\n"
+                   "      <metadata owner=\"http://freedesktop.org\">\n"
+                   "        <mime:mime-type type=\"" << application.mimetype << "\"/>\n"
+                   "        <bookmark:applications>\n";
+
+            // Most of the files have been opened by one application,
+            // some of them by the file manager as well
+            const int applicationsForFile = 1 + (random.bounded(4) == 0);
+            for (int a = 0; a < applicationsForFile; ++a) {
+                const auto &used = a == 0 ? application
+                                          : applications[random.bounded(applicationCount)];
+                out << "          <bookmark:application name=\"" << used.exec
+                    << "\" exec=\"&apos;" << used.exec << "&apos;\""
+                    << " modified=\"" << timestamp(modified.addSecs(-a)) << "\""
+                    << " count=\"" << 1 + random.bounded(20) << "\"/>\n";
+            }
+
+            out << "        </bookmark:applications>\n"
+                   "      </metadata>\n"
+                   "    </info>\n"
+                   "  </bookmark>\n";
+        }
+
+        out << "</xbel>\n";
+        out.flush();
+
+        return file.error() == QFile::NoError ? recent : -1;
+    }
+
+    struct Measurement {
+        qint64 time;
+        quint64 allocations;
+        quint64 allocatedBytes;
+        int bookmarks;
+        int events;
+    };
+
+    // Does what GtkEventSpyPlugin::fileUpdated does,
+    // without sending the events
+    bool parseXbel(const QString &path, const XbelParser::ApplicationResolver &resolver,
+                   Measurement &measurement)
+    {
+        AllocationCounter allocations;
+        QElapsedTimer timer;
+        timer.start();
+
+        QFile file(path);
+        if (!file.open(QFile::ReadOnly | QFile::Text)) {
+            return false;
+        }
+
+        XbelParser parser(resolver);
+
+        if (!parser.parse(&file)) {
+            QTextStream(stderr) << "Can not parse " << path << ": "
+                                << parser.errorString() << '\n';
+            return false;
+        }
+
+        int events = 0;
+        const QList<Bookmark> bookmarks = parser.bookmarks();
+        for (const Bookmark &mark : bookmarks) {
+            if (mark.changedSince(lastUpdate)) {
+                // The plugin sends the latest application with the event
+                mark.latestApplication();
+                ++events;
+            }
+        }
+
+        measurement.time = timer.nsecsElapsed();
+        measurement.allocations = allocations.count();
+        measurement.allocatedBytes = allocations.bytes();
+        measurement.bookmarks = bookmarks.size();
+        measurement.events = events;
+
+        return true;
+    }
+
+} // namespace
+
+int main(int argc, char *argv[])
+{
+    QCoreApplication app(argc, argv);
+
+    QCommandLineParser parser;
+    parser.setApplicationDescription(QStringLiteral(
+        "Benchmarks the parser of the GTK recently-used.xbel file"));
+    parser.addHelpOption();
+
+    const QCommandLineOption sizesOption(QStringLiteral("sizes"),
+        QStringLiteral("Comma-separated numbers of the bookmarks in the generated files"),
+        QStringLiteral("sizes"), QStringLiteral("1000,10000,100000"));
+    const QCommandLineOption iterationsOption(QStringLiteral("iterations"),
+        QStringLiteral("How many times each of the files is parsed"),
+        QStringLiteral("count"), QStringLiteral("5"));
+    const QCommandLineOption recentOption(QStringLiteral("recent"),
+        QStringLiteral("Ratio of the bookmarks changed since the last update"),
+        QStringLiteral("ratio"), QStringLiteral("0.01"));
+    const QCommandLineOption noServicesOption(QStringLiteral("no-services"),
+        QStringLiteral("Do not look the applications up through KService, "
+                       "to measure only the XML parsing"));
+    const QCommandLineOption directoryOption(QStringLiteral("directory"),
+        QStringLiteral("Directory for the generated files, they are kept after the run"),
+        QStringLiteral("path"));
+    const QCommandLineOption outputOption(QStringLiteral("output"),
+        QStringLiteral("File to write the JSON results to, instead of the standard output"),
+        QStringLiteral("file"));
+
+    parser.addOptions({ sizesOption, iterationsOption, recentOption,
+                        noServicesOption, directoryOption, outputOption });
+    parser.process(app);
+
+    QTemporaryDir temporaryDirectory;
+    const auto directory = parser.isSet(directoryOption)
+                               ? parser.value(directoryOption)
+                               : temporaryDirectory.path();
+
+    if (!QDir().mkpath(directory)) {
+        QTextStream(stderr) << "Can not create " << directory << '\n';
+        return 1;
+    }
+
+    const int iterations = std::max(1, parser.value(iterationsOption).toInt());
+    const auto recentRatio = parser.value(recentOption).toDouble();
+
+    const XbelParser::ApplicationResolver resolver =
+        parser.isSet(noServicesOption) ? &XbelParser::applicationFromExec
+                                       : &XbelParser::resolveApplication;
+
+    QJsonArray results;
+    int failures = 0;
+
+    for (const auto &sizeString: parser.value(sizesOption).split(QLatin1Char(','))) {
+        const int size = sizeString.toInt();
+        if (size <= 0) {
+            continue;
+        }
+
+        const auto path = QDir(directory).filePath(
+            QStringLiteral("recently-used-%1.xbel").arg(size));
+
+        const int expectedEvents = generateXbel(path, size, recentRatio);
+        if (expectedEvents < 0) {
+            QTextStream(stderr) << "Can not write " << path << '\n';
+            return 1;
+        }
+
+        std::vector<Measurement> measurements;
+
+        for (int i = 0; i < iterations; ++i) {
+            Measurement measurement;
+
+            if (!parseXbel(path, resolver, measurement)) {
+                ++failures;
+                break;
+            }
+
+            measurements.push_back(measurement);
+        }
+
+        if (measurements.empty()) {
+            continue;
+        }
+
+        // The first run includes loading the service database
+        std::sort(measurements.begin(), measurements.end(),
+                  [] (const Measurement &left, const Measurement &right) {
+                      return left.time < right.time;
+                  });
+
+        const auto &fastest = measurements.front();
+        const auto &median = measurements[measurements.size() / 2];
+
+        if (fastest.bookmarks != size || fastest.events != expectedEvents) {
+            QTextStream(stderr) << "Expected " << size << " bookmarks and "
+                                << expectedEvents << " events, got "
+                                << fastest.bookmarks << " and " << fastest.events << '\n';
+            ++failures;
+        }
+
+        results.append(QJsonObject {
+            { QStringLiteral("bookmarks"),       fastest.bookmarks },
+            { QStringLiteral("file_size"),       QFileInfo(path).size() },
+            { QStringLiteral("events"),          fastest.events },
+            { QStringLiteral("min_ms"),          fastest.time / 1e6 },
+            { QStringLiteral("median_ms"),       median.time / 1e6 },
+            { QStringLiteral("us_per_bookmark"), median.time / 1e3 / size },
+            { QStringLiteral("allocations"),     qint64(median.allocations) },
+            { QStringLiteral("allocated_bytes"), qint64(median.allocatedBytes) }
+        });
+
+        QTextStream(stderr) << size << " bookmarks: " << median.time / 1e6 << " ms, "
+                            << median.allocations << " allocations, "
+                            << median.events << " events\n";
+    }
+
+    const auto json = QJsonDocument(QJsonObject {
+            { QStringLiteral("benchmark"),   QStringLiteral("xbel-parser") },
+            { QStringLiteral("iterations"),  iterations },
+            { QStringLiteral("services"),    !parser.isSet(noServicesOption) },
+            { QStringLiteral("allocations_counted"), AllocationCounter::isSupported() },
+            { QStringLiteral("failures"),    failures },
+            { QStringLiteral("results"),     results }
+        }).toJson();
+
+    if (parser.isSet(outputOption)) {
+        QFile output(parser.value(outputOption));
+
+        if (!output.open(QIODevice::WriteOnly) || output.write(json) != json.size()) {
+            QTextStream(stderr) << "Can not write " << output.fileName() << '\n';
+            return 1;
+        }
+
+    } else {
+        QTextStream(stdout) << json;
+    }
+
+    return failures == 0 ? 0 : 1;
+}
@@ -60,6 +60,9 @@ namespace {
     }
 
     std::map<DatabaseInfo, std::weak_ptr<Database>> databases;
+
+    // Additional pragmas for the new connections, see setConnectionPragmas
+    QStringList connectionPragmas;
 }
 
 class QSqlDatabaseWrapper {
@@ -134,6 +137,7 @@ public:
 class Database::Private {
 public:
     Private()
+        : transactionDepth(0)
     {
     }
 
@@ -148,17 +152,48 @@ public:
     }
 
     QScopedPointer<QSqlDatabaseWrapper> database;
+
+    // Number of currently alive lockers for this connection
+    int transactionDepth;
 };
 
 Database::Locker::Locker(Database &database)
-    : m_database(database.d->database->get())
+    : m_database(database)
+    , m_depth(database.d->transactionDepth++)
+    , m_rollback(false)
 {
-    m_database.transaction();
+    if (m_depth == 0) {
+        m_database.d->database->get().transaction();
+    } else {
+        m_database.execQuery(
+            QStringLiteral("SAVEPOINT kamd_locker_%1").arg(m_depth));
+    }
 }
 
 Database::Locker::~Locker()
 {
-    m_database.commit();
+    if (m_depth == 0) {
+        if (m_rollback) {
+            m_database.d->database->get().rollback();
+        } else {
+            m_database.d->database->get().commit();
+        }
+    } else {
+        if (m_rollback) {
+            m_database.execQuery(
+                QStringLiteral("ROLLBACK TO SAVEPOINT kamd_locker_%1").arg(m_depth));
+        }
+
+        m_database.execQuery(
+            QStringLiteral("RELEASE SAVEPOINT kamd_locker_%1").arg(m_depth));
+    }
+
+    --m_database.d->transactionDepth;
+}
+
+void Database::Locker::rollback()
+{
+    m_rollback = true;
 }
 
 Database::Ptr Database::instance(Source source, OpenMode openMode)
@@ -208,15 +243,28 @@ Database::Ptr Database::instance(Source source, OpenMode openMode)
     // WSL Fixup - Don't use Write-Ahead Logging
     auto walResult = ptr->pragma(QStringLiteral("journal_mode = TRUNCATE"));
 
+    for (const auto &pragma: connectionPragmas) {
+        ptr->setPragma(pragma);
+    }
+
     qCDebug(KAMD_LOG_RESOURCES) << "KActivities: Database connection: " << ptr->d->database->connectionName()
         << "\n    query_only:         " << ptr->pragma(QStringLiteral("query_only"))
         << "\n    journal_mode:       " << ptr->pragma(QStringLiteral("journal_mode"))
         << "\n    synchronous:        " << ptr->pragma(QStringLiteral("synchronous"))
+        << "\n    cache_size:         " << ptr->pragma(QStringLiteral("cache_size"))
+        << "\n    mmap_size:          " << ptr->pragma(QStringLiteral("mmap_size"))
         ;
 
     return ptr;
 }
 
+void Database::setConnectionPragmas(const QStringList &pragmas)
+{
+    std::lock_guard<std::mutex> lock(databases_mutex);
+
+    connectionPragmas = pragmas;
+}
+
 Database::Database()
 {
 }
@@ -290,10 +338,173 @@ QVariant Database::pragma(const QString &pragma) const
     return value("PRAGMA " + pragma);
 }
 
+QVariant Database::driverHandle() const
+{
+    return d->database ? d->database->get().driver()->handle() : QVariant();
+}
+
 QVariant Database::value(const QString &query) const
 {
     auto result = execQuery(query);
     return result.next() ? result.value(0) : QVariant();
 }
 
+namespace {
+    inline ushort foldAsciiCharacter(ushort c)
+    {
+        return (c >= 'A' && c <= 'Z') ? c + ('a' - 'A') : c;
+    }
+
+    // Increments the last character of the (case folded) prefix, unless
+    // that would end up in (or skip over) the surrogate range, in which
+    // case we can not tell what the successor is
+    QString successorOf(const QString &prefix)
+    {
+        if (prefix.isEmpty()) {
+            return QString();
+        }
+
+        const auto last = prefix.at(prefix.size() - 1).unicode();
+
+        if (!(last < 0xD7FF || (last >= 0xE000 && last < 0xFFFF))) {
+            return QString();
+        }
+
+        // The upper case letters are equal to the lower case ones
+        // in the NOCASE collation, the character after '@' is '['
+        const ushort next = last + 1;
+
+        QString result = prefix;
+        result[result.size() - 1] = QChar(next == 'A' ? '[' : next);
+        return result;
+    }
+} // namespace
+
+QString foldAsciiCase(const QString &value)
+{
+    QString result = value;
+
+    for (auto &c: result) {
+        c = QChar(foldAsciiCharacter(c.unicode()));
+    }
+
+    return result;
+}
+
+int compareIgnoringAsciiCase(const QString &left, const QString &right)
+{
+    const int size = qMin(left.size(), right.size());
+
+    for (int i = 0; i < size; ++i) {
+        const auto l = foldAsciiCharacter(left.at(i).unicode());
+        const auto r = foldAsciiCharacter(right.at(i).unicode());
+
+        if (l != r) {
+            return l < r ? -1 : 1;
+        }
+    }
+
+    return left.size() - right.size();
+}
+
+StarPattern::StarPattern(const QString &pattern)
+{
+    QString current;
+    bool isEscaped = false;
+
+    for (const auto &c: pattern) {
+        if (isEscaped) {
+            current.append(c);
+            isEscaped = false;
+
+        } else if (c == QLatin1Char('\\')) {
+            isEscaped = true;
+
+        } else if (c == QLatin1Char('*')) {
+            m_parts << current;
+            current.clear();
+
+        } else {
+            current.append(c);
+        }
+    }
+
+    // A trailing backslash does not escape anything
+    if (isEscaped) {
+        current.append(QLatin1Char('\\'));
+    }
+
+    m_parts << current;
+
+    for (auto &part: m_parts) {
+        part = foldAsciiCase(part);
+    }
+
+    if (m_parts.size() == 1) {
+        m_type = Exact;
+
+    } else if (m_parts.size() == 2 && m_parts[1].isEmpty()
+               && !(m_prefixSuccessor = successorOf(m_parts[0])).isEmpty()) {
+        m_type = Prefix;
+
+    } else {
+        m_type = Glob;
+    }
+}
+
+StarPattern::Type StarPattern::type() const
+{
+    return m_type;
+}
+
+QString StarPattern::prefix() const
+{
+    return m_parts.first();
+}
+
+QString StarPattern::prefixSuccessor() const
+{
+    return m_prefixSuccessor;
+}
+
+bool StarPattern::matches(const QString &originalValue) const
+{
+    const auto value = foldAsciiCase(originalValue);
+
+    switch (m_type) {
+        case Exact:
+            return value == m_parts.first();
+
+        case Prefix:
+            return value.startsWith(m_parts.first());
+
+        case Glob:
+            break;
+    }
+
+    const auto &first = m_parts.first();
+    const auto &last  = m_parts.last();
+
+    if (!value.startsWith(first)) {
+        return false;
+    }
+
+    // The middle parts need to appear in order, and must not
+    // overlap with the first and the last one
+    int position = first.size();
+
+    for (int i = 1; i < m_parts.size() - 1; ++i) {
+        const auto &part = m_parts[i];
+        const int found = value.indexOf(part, position);
+
+        if (found == -1) {
+            return false;
+        }
+
+        position = found + part.size();
+    }
+
+    return value.size() - last.size() >= position && value.endsWith(last);
+}
+
 } // namespace Common
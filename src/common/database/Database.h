@@ -22,6 +22,7 @@
 #define COMMON_DATABASE_H
 
 #include <utils/d_ptr.h>
+#include <algorithm>
 #include <memory>
 #include <QSqlQuery>
 #include <QRegExp>
@@ -46,6 +47,13 @@ public:
 
     static Ptr instance(Source source, OpenMode openMode);
 
+    /**
+     * Sets the pragmas (for example "cache_size = -8000") that are
+     * applied to the connections opened from now on, after the
+     * default ones
+     */
+    static void setConnectionPragmas(const QStringList &pragmas);
+
     QSqlQuery execQueries(const QStringList &queries) const;
     QSqlQuery execQuery(const QString &query, bool ignoreErrors = false) const;
     QSqlQuery createQuery() const;
@@ -54,20 +62,35 @@ public:
     QVariant pragma(const QString &pragma) const;
     QVariant value(const QString &query) const;
 
+    /**
+     * The low-level handle of the connection, see QSqlDriver::handle
+     */
+    QVariant driverHandle() const;
+
     // For debugging purposes only
     QString lastQuery() const;
 
     ~Database();
     Database();
 
+    // Lockers can be nested. Only the outermost one opens and commits
+    // the real transaction, the inner ones are mapped to savepoints
+    // so that they can not commit a half-finished outer batch.
+    // A rolled back locker discards only its own changes.
     friend class Locker;
     class Locker {
     public:
         explicit Locker(Database &database);
         ~Locker();
 
+        // The changes are discarded instead of committed
+        // when the locker goes out of scope
+        void rollback();
+
     private:
-        QSqlDatabase &m_database;
+        Database &m_database;
+        const int m_depth;
+        bool m_rollback;
     };
 
     void reportError(const QSqlError &error);
@@ -83,77 +106,169 @@ private:
     D_PTR;
 };
 
-template <typename EscapeFunction>
+/**
+ * Converts the star pattern into a pattern of a different syntax,
+ * replacing the stars with the joker, and escaping the other characters
+ * with the escape function which appends the escaped character
+ * to the result.
+ *
+ * The characters escaped with a backslash in the star pattern are
+ * passed to the escape function together with the backslash.
+ *
+ * The pattern is processed in a single pass, and the result is built
+ * in a buffer which is allocated only once.
+ */
+template <typename EscapeCharacter>
 QString parseStarPattern(const QString &pattern, const QString &joker,
-                                   EscapeFunction escape)
+                         EscapeCharacter escape)
 {
-    const auto begin     = pattern.constBegin();
-    const auto end       = pattern.constEnd();
+    QString resultPattern;
 
-    auto currentStart    = pattern.constBegin();
-    auto currentPosition = pattern.constBegin();
+    // Each character is escaped with at most one additional character
+    resultPattern.reserve(pattern.size() * qMax(2, joker.size()));
 
     bool isEscaped = false;
 
-    // This should be available in the QString class...
-    auto stringFromIterators = [&](const QString::const_iterator &currentStart,
-                                   const QString::const_iterator &currentPosition) {
-        return pattern.mid(
-                std::distance(begin, currentStart),
-                std::distance(currentStart, currentPosition));
-    };
-
-    // Escaping % and _ for sql like
-    // auto escape = [] (QString str) {
-    //     return str.replace("%", "\\%").replace("_", "\\_");
-    // };
-
-    QString resultPattern;
-    resultPattern.reserve(pattern.size() * 1.5);
-
-    for (; currentPosition != end; ++currentPosition) {
+    for (const QChar c: pattern) {
         if (isEscaped) {
-            // Just skip the current character
+            // Just pass the current character on
             isEscaped = false;
+            escape(resultPattern, c);
 
-        } else if (*currentPosition == QLatin1Char('\\')) {
-            // Skip two characters
+        } else if (c == QLatin1Char('\\')) {
+            // Pass two characters on
             isEscaped = true;
+            escape(resultPattern, c);
 
-        } else if (*currentPosition == QLatin1Char('*')) {
-            // Replacing the star with the sql like joker - %
-            resultPattern.append(escape(stringFromIterators(
-                                    currentStart, currentPosition)) + joker);
-            currentStart = currentPosition + 1;
+        } else if (c == QLatin1Char('*')) {
+            // Replacing the star with the joker
+            resultPattern.append(joker);
 
         } else {
-            // This one is boring, nothing to do
+            escape(resultPattern, c);
         }
     }
 
-    if (currentStart != currentPosition) {
-        resultPattern.append(escape(stringFromIterators(
-                                currentStart, currentPosition)));
+    return resultPattern;
+}
+
+// Escaping % and _ for sql like
+inline void escapeSqliteLikeCharacter(QString &result, QChar c)
+{
+    if (c == QLatin1Char('%') || c == QLatin1Char('_')) {
+        result.append(QLatin1Char('\\'));
     }
 
-    return resultPattern;
+    result.append(c);
 }
 
-inline QString escapeSqliteLikePattern(QString pattern)
+// Escaping the same characters as QRegExp::escape does
+inline void escapeRegExpCharacter(QString &result, QChar c)
 {
-    return pattern.replace(QLatin1String("%"), QLatin1String("\\%")).replace(QLatin1String("_"), QLatin1String("\\_"));
+    switch (c.unicode()) {
+        case '$': case '(': case ')': case '*': case '+': case '.': case '?':
+        case '[': case '\\': case ']': case '^': case '{': case '|': case '}':
+            result.append(QLatin1Char('\\'));
+            break;
+
+        default:
+            break;
+    }
+
+    result.append(c);
 }
 
 inline QString starPatternToLike(const QString &pattern)
 {
-    return parseStarPattern(pattern, QStringLiteral("%"), escapeSqliteLikePattern);
+    return parseStarPattern(pattern, QStringLiteral("%"), escapeSqliteLikeCharacter);
 }
 
 inline QRegExp starPatternToRegex(const QString &pattern)
 {
-    return QRegExp(parseStarPattern(pattern, QStringLiteral(".*"), QRegExp::escape));
+    return QRegExp(parseStarPattern(pattern, QStringLiteral(".*"), escapeRegExpCharacter));
+}
+
+/**
+ * Returns whether the URI matches any of the filters created with
+ * starPatternToRegex. This is how the sqlite plugin skips the resources
+ * matching its url-filters.
+ */
+inline bool matchesAnyFilter(const QList<QRegExp> &filters, const QString &uri)
+{
+    return std::any_of(filters.cbegin(), filters.cend(),
+                       [&uri] (const QRegExp &filter) { return filter.exactMatch(uri); });
 }
 
+/**
+ * Converts the ASCII letters to lower case, leaving the other
+ * characters as they are. This is how SQLite LIKE and the NOCASE
+ * collation compare the strings.
+ */
+QString foldAsciiCase(const QString &value);
+
+/**
+ * Compares the strings with the ASCII letters folded to lower case
+ */
+int compareIgnoringAsciiCase(const QString &left, const QString &right);
+
+/**
+ * Orders the strings ignoring the case of the ASCII letters. The strings
+ * that differ only in case are ordered by their exact value, so that
+ * they can all be kept in the same set.
+ */
+struct AsciiCaseInsensitiveLess {
+    bool operator()(const QString &left, const QString &right) const
+    {
+        const int result = compareIgnoringAsciiCase(left, right);
+        return result != 0 ? result < 0 : left < right;
+    }
+};
+
+/**
+ * Star pattern split into the literal parts between the stars.
+ *
+ * The patterns that have no stars, or only a trailing one, do not need
+ * a LIKE scan -- they can be matched with an equality or a range
+ * condition which SQLite can resolve using an index.
+ *
+ * Like the LIKE conditions the patterns used to be converted to,
+ * the matching ignores the case of the ASCII letters. The conditions
+ * need to use the NOCASE collation.
+ */
+class StarPattern {
+public:
+    enum Type {
+        Exact,  ///< No stars at all
+        Prefix, ///< Only a trailing star, matching strings with the prefix
+        Glob    ///< Anything else
+    };
+
+    explicit StarPattern(const QString &pattern);
+
+    Type type() const;
+
+    /**
+     * The literal text before the first star, the whole text
+     * for the exact patterns, with the ASCII letters folded
+     * to lower case
+     */
+    QString prefix() const;
+
+    /**
+     * The smallest string that is greater than all the strings
+     * starting with the prefix, in the NOCASE collation order.
+     * Only defined for the prefix patterns.
+     */
+    QString prefixSuccessor() const;
+
+    bool matches(const QString &value) const;
+
+private:
+    Type m_type;
+    QStringList m_parts;
+    QString m_prefixSuccessor;
+};
+
 } // namespace Common
 
 #endif // COMMON_DATABASE_H
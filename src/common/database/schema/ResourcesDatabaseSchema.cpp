@@ -23,6 +23,7 @@
 #include <QStandardPaths>
 #include <QVariant>
 #include <QCoreApplication>
+#include <QDateTime>
 
 namespace Common {
 namespace ResourcesDatabaseSchema {
@@ -31,7 +32,7 @@ const QString name = QStringLiteral("Resources");
 
 QString version()
 {
-    return QStringLiteral("2015.02.09");
+    return QStringLiteral("2026.10.19");
 }
 
 QStringList schema()
@@ -53,6 +54,10 @@ QStringList schema()
            // a resource. The Accessed event is mapped to those.
            // Focusing events are not stored in order not to get a
            // huge database file and to lessen writes to the disk.
+           // @since 2026.10.19
+           // The events are moved to monthly partitions in initSchema,
+           // and ResourceEvent is replaced by a view over them.
+           // See eventPartitionSchema.
            QStringLiteral("CREATE TABLE IF NOT EXISTS ResourceEvent ("
                "usedActivity TEXT, "
                "initiatingAgent TEXT, "
@@ -104,9 +109,206 @@ QStringList schema()
                "PRIMARY KEY(targettedResource)"
            ")")
 
+        << // @since 2026.10.19
+           // The ResourceEventDaily table stores the old events from
+           // ResourceEvent, aggregated per day (start of the UTC day).
+           // The accessCount is the number of zero-length events
+           // (Accessed), and totalDuration is the sum of the lengths
+           // of the others, in seconds.
+           QStringLiteral("CREATE TABLE IF NOT EXISTS ResourceEventDaily ("
+               "usedActivity TEXT, "
+               "initiatingAgent TEXT, "
+               "targettedResource TEXT, "
+               "day INTEGER, "
+               "eventCount INTEGER, "
+               "accessCount INTEGER, "
+               "totalDuration INTEGER, "
+               "PRIMARY KEY(usedActivity, initiatingAgent, targettedResource, day)"
+           ")")
+
+        << // @since 2026.10.19
+           // The resources are deleted by their URLs or URL prefixes
+           // without knowing the activity or the agent. The URLs are
+           // compared ignoring the ASCII case, like the LIKE conditions
+           // that were used before
+           QStringLiteral("CREATE INDEX IF NOT EXISTS ResourceScoreCache_TargettedResource "
+               "ON ResourceScoreCache (targettedResource COLLATE NOCASE)")
+        << QStringLiteral("CREATE INDEX IF NOT EXISTS ResourceEventDaily_TargettedResource "
+               "ON ResourceEventDaily (targettedResource COLLATE NOCASE)")
+
+        << // @since 2026.10.19
+           // The ResourceFocusDaily table stores for how long the resources
+           // had the focus, aggregated per day (start of the UTC day).
+           // The focus events themselves are not stored, see the comment
+           // for ResourceEvent. The focusCount is the number of times the
+           // resource got the focus, and focusDuration is the total time
+           // it had it, in milliseconds.
+           QStringLiteral("CREATE TABLE IF NOT EXISTS ResourceFocusDaily ("
+               "usedActivity TEXT, "
+               "initiatingAgent TEXT, "
+               "targettedResource TEXT, "
+               "day INTEGER, "
+               "focusCount INTEGER, "
+               "focusDuration INTEGER, "
+               "PRIMARY KEY(usedActivity, initiatingAgent, targettedResource, day)"
+           ")")
+        << QStringLiteral("CREATE INDEX IF NOT EXISTS ResourceFocusDaily_TargettedResource "
+               "ON ResourceFocusDaily (targettedResource COLLATE NOCASE)")
+
+        << // @since 2026.10.19
+           // The ResourceEditStats table stores the number of edit sessions
+           // of the resources. The Modified events that come within a quiet
+           // period from each other count as one session. The sessions are
+           // counted per day (start of the UTC day) of their last
+           // modification, so that the stats can be deleted for a time
+           // range like the other daily aggregates. The lastEdit is
+           // the time of the last recorded modification.
+           QStringLiteral("CREATE TABLE IF NOT EXISTS ResourceEditStats ("
+               "usedActivity TEXT, "
+               "initiatingAgent TEXT, "
+               "targettedResource TEXT, "
+               "day INTEGER, "
+               "editCount INTEGER, "
+               "lastEdit INTEGER, "
+               "PRIMARY KEY(usedActivity, initiatingAgent, targettedResource, day)"
+           ")")
+        << QStringLiteral("CREATE INDEX IF NOT EXISTS ResourceEditStats_TargettedResource "
+               "ON ResourceEditStats (targettedResource COLLATE NOCASE)")
+
        ;
 }
 
+QString eventPartitionName(qint64 start)
+{
+    return QStringLiteral("ResourceEvent_")
+           + QDateTime::fromSecsSinceEpoch(start, Qt::UTC)
+                 .toString(QStringLiteral("yyyy_MM"));
+}
+
+qint64 eventPartitionStart(const QString &partition)
+{
+    const auto month = QDateTime::fromString(
+        partition.mid(partition.indexOf(QLatin1Char('_')) + 1) + QStringLiteral("_01"),
+        QStringLiteral("yyyy_MM_dd"));
+
+    return QDateTime(month.date(), QTime(0, 0), Qt::UTC).toSecsSinceEpoch();
+}
+
+qint64 eventPartitionEnd(const QString &partition)
+{
+    return QDateTime::fromSecsSinceEpoch(eventPartitionStart(partition), Qt::UTC)
+               .addMonths(1).toSecsSinceEpoch();
+}
+
+QStringList eventPartitionSchema(const QString &partition)
+{
+    return QStringList()
+
+        << // Events that started in the month the partition is named after
+           QStringLiteral("CREATE TABLE IF NOT EXISTS %1 ("
+               "usedActivity TEXT, "
+               "initiatingAgent TEXT, "
+               "targettedResource TEXT, "
+               "start INTEGER, "
+               "end INTEGER "
+           ")").arg(partition)
+
+        << // Used by the score calculation and for closing the events
+           QStringLiteral("CREATE INDEX IF NOT EXISTS %1_Resource ON %1 ("
+               "usedActivity, initiatingAgent, targettedResource, start"
+           ")").arg(partition)
+
+        << // Used for deleting the resources by their URLs or URL prefixes
+           QStringLiteral("CREATE INDEX IF NOT EXISTS %1_TargettedResource ON %1 ("
+               "targettedResource COLLATE NOCASE"
+           ")").arg(partition)
+
+       ;
+}
+
+QStringList eventViewSchema(const QStringList &partitions)
+{
+    QStringList selects;
+
+    for (const auto &partition: partitions) {
+        selects << QStringLiteral("SELECT usedActivity, initiatingAgent, "
+                                  "targettedResource, start, end FROM %1")
+                       .arg(partition);
+    }
+
+    return QStringList()
+        << QStringLiteral("DROP VIEW IF EXISTS ResourceEvent")
+        << QStringLiteral("CREATE VIEW ResourceEvent AS ")
+               + selects.join(QStringLiteral(" UNION ALL "))
+        ;
+}
+
+QStringList eventPartitions(Database &database)
+{
+    QStringList result;
+
+    auto query = database.execQuery(
+        QStringLiteral("SELECT name FROM sqlite_master "
+                       "WHERE type = 'table' AND name LIKE 'ResourceEvent\\_%' ESCAPE '\\' "
+                       "ORDER BY name"));
+
+    while (query.next()) {
+        result << query.value(0).toString();
+    }
+
+    return result;
+}
+
+// Moves the events from the old ResourceEvent table into
+// the monthly partitions
+static void partitionResourceEvents(Database &database)
+{
+    DATABASE_TRANSACTION(database);
+
+    const auto isTable = database.value(QStringLiteral(
+        "SELECT count(*) FROM sqlite_master "
+        "WHERE type = 'table' AND name = 'ResourceEvent'")).toInt() > 0;
+
+    if (isTable) {
+        // This index is dropped together with the table
+        database.execQuery(QStringLiteral(
+            "CREATE INDEX IF NOT EXISTS ResourceEvent_PartitioningStart "
+            "ON ResourceEvent (start)"));
+
+        QStringList months;
+        auto query = database.execQuery(QStringLiteral(
+            "SELECT DISTINCT strftime('%Y_%m', start, 'unixepoch') "
+            "FROM ResourceEvent WHERE start IS NOT NULL"));
+        while (query.next()) {
+            months << query.value(0).toString();
+        }
+        query.finish();
+
+        for (const auto &month: months) {
+            const auto partition = QStringLiteral("ResourceEvent_") + month;
+
+            database.execQueries(eventPartitionSchema(partition));
+            database.execQuery(
+                QStringLiteral("INSERT INTO %1 "
+                               "SELECT usedActivity, initiatingAgent, "
+                               "targettedResource, start, end "
+                               "FROM ResourceEvent "
+                               "WHERE start >= %2 AND start < %3")
+                    .arg(partition)
+                    .arg(eventPartitionStart(partition))
+                    .arg(eventPartitionEnd(partition)));
+        }
+
+        database.execQuery(QStringLiteral("DROP TABLE ResourceEvent"));
+    }
+
+    // We always need at least one partition for the view
+    database.execQueries(eventPartitionSchema(
+        eventPartitionName(QDateTime::currentSecsSinceEpoch())));
+
+    database.execQueries(eventViewSchema(eventPartitions(database)));
+}
+
 // TODO: This will require some refactoring after we introduce more databases
 QString defaultPath()
 {
@@ -168,6 +370,15 @@ void initSchema(Database &database)
             /* ignore error */ true);
     }
 
+    // The deleted events used to leave free pages all over the file
+    // which was never shrinking. With the incremental auto-vacuum,
+    // ResourcesDatabaseMaintenance reclaims them a few at a time.
+    // The mode can be set without a VACUUM only before the first
+    // table is created, the existing databases are left as they are.
+    if (dbSchemaVersion.isEmpty()) {
+        database.setPragma(QStringLiteral("auto_vacuum = INCREMENTAL"));
+    }
+
     database.execQueries(ResourcesDatabaseSchema::schema());
 
     // We are asking for trouble. If the database is corrupt,
@@ -179,7 +390,10 @@ void initSchema(Database &database)
             "SELECT count(*) FROM ResourceEvent",
             "SELECT count(*) FROM ResourceScoreCache",
             "SELECT count(*) FROM ResourceLink",
-            "SELECT count(*) FROM ResourceInfo"
+            "SELECT count(*) FROM ResourceInfo",
+            "SELECT count(*) FROM ResourceEventDaily",
+            "SELECT count(*) FROM ResourceFocusDaily",
+            "SELECT count(*) FROM ResourceEditStats"
         });
 
     // We can not allow empty fields for activity and agent, they need to
@@ -210,6 +424,12 @@ void initSchema(Database &database)
         database.execQuery("UPDATE ResourceScoreCache " + updateAgent);
 
     }
+
+    // The events need to be partitioned after all the other
+    // transitions that update the ResourceEvent table
+    if (dbSchemaVersion < QStringLiteral("2026.10.19")) {
+        partitionResourceEvents(database);
+    }
 }
 
 } // namespace Common
@@ -36,6 +36,17 @@ namespace ResourcesDatabaseSchema {
 
     void initSchema(Database &database);
 
+    // The events are stored in monthly partitions, ResourceEvent
+    // is a view that joins all of them together
+    QString eventPartitionName(qint64 start);
+    qint64 eventPartitionStart(const QString &partition);
+    qint64 eventPartitionEnd(const QString &partition);
+
+    QStringList eventPartitionSchema(const QString &partition);
+    QStringList eventViewSchema(const QStringList &partitions);
+
+    QStringList eventPartitions(Database &database);
+
 } // namespace ResourcesDatabase
 } // namespace Common
 
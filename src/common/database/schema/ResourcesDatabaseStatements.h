@@ -0,0 +1,336 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RESOURCESDATABASESTATEMENTS_H
+#define RESOURCESDATABASESTATEMENTS_H
+
+#include <QString>
+
+namespace Common {
+
+/**
+ * The statements the sqlite plugin executes on the resources database.
+ *
+ * They are shared with the database benchmark, so that a change
+ * of a statement, of the schema or of an index is measured against
+ * the code that is actually run. The statements with %1 in them are
+ * executed on each of the event partitions.
+ */
+namespace ResourcesDatabaseStatements {
+
+    // ResourceScoreCache
+
+    inline QString dailyScoreAddition()
+    {
+        return QStringLiteral(
+            "SELECT day, accessCount, totalDuration "
+            "FROM ResourceEventDaily "
+            "WHERE "
+                ":usedActivity      = usedActivity AND "
+                ":initiatingAgent   = initiatingAgent AND "
+                ":targettedResource = targettedResource AND "
+                "day > :start "
+            "ORDER BY "
+                "day ASC");
+    }
+
+    inline QString scoreAddition()
+    {
+        return QStringLiteral(
+            "SELECT start, end "
+            "FROM %1 "
+            "WHERE "
+                ":usedActivity      = usedActivity AND "
+                ":initiatingAgent   = initiatingAgent AND "
+                ":targettedResource = targettedResource AND "
+                "start > :start "
+            "ORDER BY "
+                "start ASC");
+    }
+
+    // ResourceScoreStore
+
+    inline QString saveScore()
+    {
+        return QStringLiteral(
+            "INSERT OR REPLACE INTO ResourceScoreCache "
+            "        (usedActivity,  initiatingAgent,  targettedResource, "
+            "         scoreType,  cachedScore,  firstUpdate,  lastUpdate) "
+            "VALUES (:usedActivity, :initiatingAgent, :targettedResource, "
+            "         0,         :cachedScore, :firstUpdate, :lastUpdate)");
+    }
+
+    // StatsPlugin
+
+    inline QString openResourceEvent()
+    {
+        return QStringLiteral(
+            "INSERT INTO %1"
+            "        (usedActivity,  initiatingAgent,  targettedResource,  start,  end) "
+            "VALUES (:usedActivity, :initiatingAgent, :targettedResource, :start, :end)");
+    }
+
+    inline QString closeResourceEvent()
+    {
+        return QStringLiteral(
+            "UPDATE %1 "
+            "SET end = :end "
+            "WHERE "
+                ":usedActivity      = usedActivity AND "
+                ":initiatingAgent   = initiatingAgent AND "
+                ":targettedResource = targettedResource AND "
+                "end IS NULL");
+    }
+
+    inline QString getResourceInfo()
+    {
+        return QStringLiteral(
+            "SELECT targettedResource FROM ResourceInfo WHERE "
+                "  targettedResource = :targettedResource ");
+    }
+
+    inline QString insertResourceInfo()
+    {
+        return QStringLiteral(
+            "INSERT INTO ResourceInfo( "
+                "  targettedResource"
+                ", title"
+                ", autoTitle"
+                ", mimetype"
+                ", autoMimetype"
+            ") VALUES ("
+                "  :targettedResource"
+                ", '' "
+                ", 1 "
+                ", '' "
+                ", 1 "
+            ")");
+    }
+
+    inline QString saveResourceTitle()
+    {
+        return QStringLiteral(
+            "UPDATE ResourceInfo SET "
+                "  title = :title"
+                ", autoTitle = :autoTitle "
+            "WHERE "
+                "targettedResource = :targettedResource ");
+    }
+
+    inline QString saveResourceMimetype()
+    {
+        return QStringLiteral(
+            "UPDATE ResourceInfo SET "
+                "  mimetype = :mimetype"
+                ", autoMimetype = :autoMimetype "
+            "WHERE "
+                "targettedResource = :targettedResource ");
+    }
+
+    // The conditions for deleting the stats from the event partitions
+    // and from each of the tables derived from the events. They are
+    // used by DeleteStatsForResource directly, and by the background
+    // deletion jobs (ResourceStatsDeletion) a chunk at a time.
+    // The activity is not checked when :usedActivity is NULL.
+    struct DeletionFilters {
+        QString events;
+        QString dailyEvents;
+        QString focusDaily;
+        QString editStats;
+        QString scores;
+    };
+
+    // All the stats of an activity. If the stats of all the activities
+    // are deleted, the event partitions are deleted without a condition
+    inline DeletionFilters deleteActivityFilters()
+    {
+        const auto activity = QStringLiteral(
+            "usedActivity = COALESCE(:usedActivity, usedActivity)");
+
+        return {
+            QStringLiteral("usedActivity = :usedActivity"),
+            activity, activity, activity, activity
+        };
+    }
+
+    // The stats newer than :since. The daily aggregates (including the
+    // edit sessions) do not know when exactly the events happened,
+    // so the whole day is deleted
+    inline DeletionFilters deleteRecentFilters()
+    {
+        const auto activity = QStringLiteral(
+            "usedActivity = COALESCE(:usedActivity, usedActivity) ");
+
+        return {
+            activity + QStringLiteral("AND end > :since"),
+            activity + QStringLiteral("AND day + 86400 > :since"),
+            activity + QStringLiteral("AND day + 86400 > :since"),
+            activity + QStringLiteral("AND day + 86400 > :since"),
+            activity + QStringLiteral("AND firstUpdate > :since")
+        };
+    }
+
+    // The stats older than :time
+    inline DeletionFilters deleteEarlierFilters()
+    {
+        const auto activity = QStringLiteral(
+            "usedActivity = COALESCE(:usedActivity, usedActivity) ");
+
+        return {
+            activity + QStringLiteral("AND start < :time"),
+            activity + QStringLiteral("AND day < :time"),
+            activity + QStringLiteral("AND day < :time"),
+            activity + QStringLiteral("AND day < :time"),
+            activity + QStringLiteral("AND lastUpdate < :time")
+        };
+    }
+
+    // The stats of the :resource, or of all the resources in the
+    // [:resource, :resourceSuccessor) range. The agent is not checked
+    // when :initiatingAgent is NULL. The resources are compared ignoring
+    // the case of ASCII letters, see Common::StarPattern
+    inline DeletionFilters deleteResourceFilters(bool isRange)
+    {
+        const auto filter = QStringLiteral(
+                "usedActivity = COALESCE(:usedActivity, usedActivity) AND "
+                "initiatingAgent = COALESCE(:initiatingAgent, initiatingAgent) AND ")
+            + (isRange ? QStringLiteral("targettedResource >= :resource COLLATE NOCASE AND "
+                                        "targettedResource < :resourceSuccessor COLLATE NOCASE")
+                       : QStringLiteral("targettedResource = :resource COLLATE NOCASE"));
+
+        return { filter, filter, filter, filter, filter };
+    }
+
+    inline QString deleteRows(const QString &table, const QString &filter)
+    {
+        return QStringLiteral("DELETE FROM %1 WHERE %2").arg(table, filter);
+    }
+
+    // ResourceStatsDeletion
+
+    inline QString deleteChunk(const QString &table, const QString &filter)
+    {
+        return QStringLiteral(
+                "DELETE FROM %1 "
+                "WHERE rowid >= :firstRowId AND rowid < :lastRowId%2"
+            ).arg(table,
+                  filter.isEmpty() ? QString()
+                                   : QStringLiteral(" AND (%1)").arg(filter));
+    }
+
+    // ResourceFocusTime
+
+    inline QString updateFocusTime()
+    {
+        return QStringLiteral(
+            "UPDATE ResourceFocusDaily SET "
+                "focusCount    = focusCount    + :focusCount, "
+                "focusDuration = focusDuration + :focusDuration "
+            "WHERE "
+                "usedActivity      = :usedActivity AND "
+                "initiatingAgent   = :initiatingAgent AND "
+                "targettedResource = :targettedResource AND "
+                "day               = :day");
+    }
+
+    inline QString insertFocusTime()
+    {
+        return QStringLiteral(
+            "INSERT INTO ResourceFocusDaily "
+            "        (usedActivity,  initiatingAgent,  targettedResource,  day, "
+            "         focusCount,  focusDuration) "
+            "VALUES (:usedActivity, :initiatingAgent, :targettedResource, :day, "
+            "        :focusCount, :focusDuration)");
+    }
+
+    // ResourceEditTracker
+
+    inline QString updateEditStats()
+    {
+        return QStringLiteral(
+            "UPDATE ResourceEditStats SET "
+                "editCount = editCount + 1, "
+                "lastEdit  = max(lastEdit, :lastEdit) "
+            "WHERE "
+                "usedActivity      = :usedActivity AND "
+                "initiatingAgent   = :initiatingAgent AND "
+                "targettedResource = :targettedResource AND "
+                "day               = :day");
+    }
+
+    inline QString insertEditStats()
+    {
+        return QStringLiteral(
+            "INSERT INTO ResourceEditStats "
+            "        (usedActivity,  initiatingAgent,  targettedResource,  day,  editCount,  lastEdit) "
+            "VALUES (:usedActivity, :initiatingAgent, :targettedResource, :day,  1,         :lastEdit)");
+    }
+
+    // ResourceLinking
+
+    inline QString linkResourceToActivity()
+    {
+        return QStringLiteral(
+            "INSERT OR REPLACE INTO ResourceLink"
+            "        (usedActivity,  initiatingAgent,  targettedResource) "
+            "VALUES ( "
+                "COALESCE(:usedActivity,''),"
+                "COALESCE(:initiatingAgent,''),"
+                "COALESCE(:targettedResource,'')"
+            ")");
+    }
+
+    inline QString unlinkResourceFromAllActivities()
+    {
+        return QStringLiteral(
+            "DELETE FROM ResourceLink "
+            "WHERE "
+            "initiatingAgent   = COALESCE(:initiatingAgent  , '') AND "
+            "(targettedResource = COALESCE(:targettedResource, '') OR "
+            "(initiatingAgent = 'org.kde.plasma.favorites.applications' "
+            "AND targettedResource = 'applications:' || COALESCE(:targettedResource, '')))");
+    }
+
+    inline QString unlinkResourceFromActivity()
+    {
+        return QStringLiteral(
+            "DELETE FROM ResourceLink "
+            "WHERE "
+            "usedActivity      = COALESCE(:usedActivity     , '') AND "
+            "initiatingAgent   = COALESCE(:initiatingAgent  , '') AND "
+            "(targettedResource = COALESCE(:targettedResource, '') OR "
+            "(initiatingAgent = 'org.kde.plasma.favorites.applications'"
+            "AND targettedResource =  'applications:' || COALESCE(:targettedResource, '')))");
+    }
+
+    inline QString isResourceLinkedToActivity()
+    {
+        return QStringLiteral(
+            "SELECT * FROM ResourceLink "
+            "WHERE "
+            "usedActivity      = COALESCE(:usedActivity     , '') AND "
+            "initiatingAgent   = COALESCE(:initiatingAgent  , '') AND "
+            "targettedResource = COALESCE(:targettedResource, '') ");
+    }
+
+} // namespace ResourcesDatabaseStatements
+} // namespace Common
+
+#endif // RESOURCESDATABASESTATEMENTS_H
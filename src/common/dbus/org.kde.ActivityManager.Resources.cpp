@@ -0,0 +1,76 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "org.kde.ActivityManager.Resources.h"
+
+#include <QMetaType>
+#include <QDBusMetaType>
+
+namespace details {
+
+class ResourceEventInfoStaticInit {
+public:
+    ResourceEventInfoStaticInit()
+    {
+        qRegisterMetaType<ResourceEventInfoList>("ResourceEventInfoList");
+        qDBusRegisterMetaType<ResourceEventInfo>();
+        qDBusRegisterMetaType<ResourceEventInfoList>();
+    }
+
+    static ResourceEventInfoStaticInit _instance;
+};
+
+ResourceEventInfoStaticInit ResourceEventInfoStaticInit::_instance;
+
+} // namespace details
+
+QDBusArgument &operator<<(QDBusArgument &arg, const ResourceEventInfo &r)
+{
+    arg.beginStructure();
+
+    arg << r.application;
+    arg << r.windowId;
+    arg << r.uri;
+    arg << r.event;
+
+    arg.endStructure();
+
+    return arg;
+}
+
+const QDBusArgument &operator>>(const QDBusArgument &arg, ResourceEventInfo &r)
+{
+    arg.beginStructure();
+
+    arg >> r.application;
+    arg >> r.windowId;
+    arg >> r.uri;
+    arg >> r.event;
+
+    arg.endStructure();
+
+    return arg;
+}
+
+QDebug operator<<(QDebug dbg, const ResourceEventInfo &r)
+{
+    dbg << "ResourceEventInfo(" << r.application << r.uri << r.event << ")";
+    return dbg.space();
+}
@@ -0,0 +1,61 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef KAMD_RESOURCES_DBUS_H
+#define KAMD_RESOURCES_DBUS_H
+
+#include <QString>
+#include <QList>
+#include <QDBusArgument>
+#include <QDebug>
+
+/**
+ * An event passed to RegisterResourceEvents, it has the same
+ * meaning as the arguments of RegisterResourceEvent
+ */
+struct ResourceEventInfo {
+    QString application;
+    uint windowId;
+    QString uri;
+    uint event;
+
+    ResourceEventInfo(const QString &application = QString(),
+                      uint windowId = 0,
+                      const QString &uri = QString(),
+                      uint event = 0)
+        : application(application)
+        , windowId(windowId)
+        , uri(uri)
+        , event(event)
+    {
+    }
+};
+
+typedef QList<ResourceEventInfo> ResourceEventInfoList;
+
+Q_DECLARE_METATYPE(ResourceEventInfo)
+Q_DECLARE_METATYPE(ResourceEventInfoList)
+
+QDBusArgument &operator<<(QDBusArgument &arg, const ResourceEventInfo&);
+const QDBusArgument &operator>>(const QDBusArgument &arg, ResourceEventInfo &rec);
+
+QDebug operator<<(QDebug dbg, const ResourceEventInfo &r);
+
+#endif // KAMD_RESOURCES_DBUS_H
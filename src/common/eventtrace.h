@@ -0,0 +1,86 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EVENTTRACE_H
+#define EVENTTRACE_H
+
+#include <QDataStream>
+#include <QIODevice>
+#include <QString>
+
+#include <algorithm>
+
+/**
+ * The format of the traces of the registered resource events, written by
+ * the daemon when the KAMD_RECORD_EVENTS environment variable is set to
+ * the path of the trace, and read by kactivitymanagerd_replay.
+ *
+ * The trace starts with the magic and the format version, followed
+ * by the records, serialized with QDataStream.
+ */
+namespace Common {
+namespace EventTrace {
+
+    struct Record {
+        qint64 timestamp; // milliseconds since the epoch
+        QString application;
+        quint32 windowId;
+        QString uri;
+        quint32 type;
+    };
+
+    const char magic[] = "KAMDTRC";
+    const quint8 formatVersion = 1;
+
+    inline void writeHeader(QDataStream &stream)
+    {
+        stream.setVersion(QDataStream::Qt_5_0);
+        stream.writeRawData(magic, sizeof(magic) - 1);
+        stream << formatVersion;
+    }
+
+    inline bool readHeader(QDataStream &stream)
+    {
+        stream.setVersion(QDataStream::Qt_5_0);
+
+        char header[sizeof(magic) - 1];
+        quint8 version = 0;
+
+        return stream.readRawData(header, sizeof(header)) == sizeof(header)
+            && std::equal(header, header + sizeof(header), magic)
+            && (stream >> version, version == formatVersion);
+    }
+
+    inline QDataStream &operator<<(QDataStream &stream, const Record &record)
+    {
+        return stream << record.timestamp << record.application
+                      << record.windowId << record.uri << record.type;
+    }
+
+    inline QDataStream &operator>>(QDataStream &stream, Record &record)
+    {
+        return stream >> record.timestamp >> record.application
+                      >> record.windowId >> record.uri >> record.type;
+    }
+
+} // namespace EventTrace
+} // namespace Common
+
+#endif // EVENTTRACE_H
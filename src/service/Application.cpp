@@ -53,6 +53,8 @@
 #include "Activities.h"
 #include "Resources.h"
 #include "Features.h"
+#include "EventTracing.h"
+#include "MemoryUsage.h"
 #include "Config.h"
 #include "Plugin.h"
 #include "DebugApplication.h"
@@ -150,7 +152,12 @@ void Application::init()
     d->resources  = runInQThread<Resources>();
     d->activities = runInQThread<Activities>();
     d->features   = runInQThread<Features>();
-    /* d->config */ new Config(this); // this does not need a separate thread
+    auto config = new Config(this); // this does not need a separate thread
+    new EventTracing(this); // neither does this
+    new MemoryUsage(this);
+
+    connect(config, &Config::pluginConfigChanged,
+            d->resources, &Resources::loadConfiguration);
 
     QMetaObject::invokeMethod(this, "loadPlugins", Qt::QueuedConnection);
 
@@ -219,6 +226,11 @@ void Application::loadPlugins()
     for (const auto &offer : offers) {
         d->loadPlugin(offer);
     }
+
+    // The events that were not stored before the last shutdown
+    // can be processed now that the plugins are listening
+    QMetaObject::invokeMethod(d->resources, &Resources::processRecoveredEvents,
+                              Qt::QueuedConnection);
 }
 
 bool Application::loadPlugin(const QString &pluginId)
@@ -288,6 +300,15 @@ QString Application::serviceVersion() const
     return KACTIVITIES_VERSION_STRING;
 }
 
+QVariantMap Application::trimMemory()
+{
+    const auto result = MemoryUsage::trim();
+
+    qCDebug(KAMD_LOG_APPLICATION) << "Trimmed the memory:" << result;
+
+    return result;
+}
+
 int main(int argc, char **argv)
 {
     // Disable session management for this process
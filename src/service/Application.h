@@ -23,6 +23,7 @@
 
 // Qt
 #include <QApplication>
+#include <QVariantMap>
 
 // Utils
 #include <utils/d_ptr.h>
@@ -57,6 +58,10 @@ public:
 public Q_SLOTS:
     void quit();
     QString serviceVersion() const;
+
+    // Returns the unused heap memory to the system, and reports
+    // the resident set size before and after, see MemoryUsage
+    QVariantMap trimMemory();
     bool loadPlugin(const QString &plugin);
     QStringList loadedPlugins() const;
 
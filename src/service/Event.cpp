@@ -24,20 +24,32 @@
 // Local
 #include <QDebug>
 
+// STL
+#include <atomic>
+
+namespace {
+    quint64 nextTraceId()
+    {
+        static std::atomic<quint64> lastTraceId { 0 };
+        return ++lastTraceId;
+    }
+}
 
 Event::Event()
     : wid(0)
+    , timestamp(QDateTime::currentMSecsSinceEpoch())
+    , traceId(nextTraceId())
     , type(Accessed)
-    , timestamp(QDateTime::currentDateTime())
 {
 }
 
 Event::Event(const QString &vApplication, quintptr vWid, const QString &vUri, int vType)
     : application(vApplication)
-    , wid(vWid)
     , uri(vUri)
+    , wid(vWid)
+    , timestamp(QDateTime::currentMSecsSinceEpoch())
+    , traceId(nextTraceId())
     , type(vType)
-    , timestamp(QDateTime::currentDateTime())
 {
     Q_ASSERT(!vApplication.isEmpty());
     Q_ASSERT(!vUri.isEmpty());
@@ -55,6 +67,11 @@ bool Event::operator==(const Event &other) const
     return application == other.application && wid == other.wid && uri == other.uri && type == other.type && timestamp == other.timestamp;
 }
 
+QDateTime Event::dateTime() const
+{
+    return QDateTime::fromMSecsSinceEpoch(timestamp, Qt::UTC);
+}
+
 QString Event::typeName() const
 {
     switch (type) {
@@ -78,7 +95,7 @@ QString Event::typeName() const
 QDebug operator<<(QDebug dbg, const Event &e)
 {
 #ifndef QT_NO_DEBUG_OUTPUT
-    dbg << "Event(" << e.application << e.wid << e.typeName() << e.uri << ":" << e.timestamp << ")";
+    dbg << "Event(" << e.application << e.wid << e.typeName() << e.uri << ":" << e.dateTime() << ")";
 #else
     Q_UNUSED(e);
 #endif
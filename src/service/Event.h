@@ -27,6 +27,7 @@
 #include <QString>
 #include <QDateTime>
 #include <QMetaType>
+#include <QVector>
 
 
 /**
@@ -64,19 +65,35 @@ public:
 
     bool operator==(const Event &other) const;
 
+    /**
+     * The time of the event as QDateTime, in UTC
+     */
+    QDateTime dateTime() const;
+
 public:
+    // The strings are interned by Resources, the events
+    // for the same application and resource share them
     QString application;
-    quintptr wid;
     QString uri;
+    quintptr wid;
+
+    // Milliseconds since the epoch. This is cheaper to get than
+    // QDateTime::currentDateTime which needs the local time zone
+    qint64 timestamp;
+
+    // Identifies the event in EventTracing, the events
+    // derived from this one share its trace id
+    quint64 traceId;
+
     int type;
-    QDateTime timestamp;
 
     QString typeName() const;
 };
 
 QDebug operator<<(QDebug dbg, const Event &e);
 
-typedef QList<Event> EventList;
+// QList would allocate each of the events separately
+typedef QVector<Event> EventList;
 
 Q_DECLARE_METATYPE(Event)
 Q_DECLARE_METATYPE(EventList)
@@ -0,0 +1,370 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Self
+#include "EventJournal.h"
+
+// Qt
+#include <QDataStream>
+#include <QDir>
+#include <QFileInfo>
+#include <QMutexLocker>
+#include <QVector>
+#include <QtEndian>
+
+// System
+#include <cstdio>
+#include <unistd.h>
+
+// Local
+#include "DebugResources.h"
+
+namespace {
+    enum RecordKind {
+        EventRecord  = 1,
+        CommitRecord = 2
+    };
+
+    // Length and the checksum of the payload
+    const int headerSize = 8;
+
+    // When a commit can not empty the journal because new events
+    // have arrived in the mean time, the journal is rewritten to
+    // contain only the uncommitted events once it gets this big
+    const qint64 compactionThreshold = 256 * 1024;
+
+    quint32 crc32(const QByteArray &data)
+    {
+        static const auto table = [] {
+            QVector<quint32> result(256);
+
+            for (quint32 i = 0; i < 256; ++i) {
+                quint32 value = i;
+                for (int bit = 0; bit < 8; ++bit) {
+                    value = (value & 1) ? (value >> 1) ^ 0xEDB88320u : (value >> 1);
+                }
+                result[i] = value;
+            }
+
+            return result;
+        }();
+
+        quint32 crc = 0xFFFFFFFFu;
+
+        for (const char c: data) {
+            crc = table[(crc ^ quint8(c)) & 0xFF] ^ (crc >> 8);
+        }
+
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+    // Fixing the version so that the journal written by one
+    // version of Qt can be read by another
+    const auto streamVersion = QDataStream::Qt_5_0;
+
+    QByteArray eventRecord(quint64 sequence, const Event &event)
+    {
+        QByteArray payload;
+        QDataStream stream(&payload, QIODevice::WriteOnly);
+        stream.setVersion(streamVersion);
+
+        stream << quint8(EventRecord) << sequence
+               << event.application << quint64(event.wid) << event.uri
+               << qint32(event.type) << qint64(event.timestamp);
+
+        return payload;
+    }
+
+    QByteArray commitRecord(quint64 sequence)
+    {
+        QByteArray payload;
+        QDataStream stream(&payload, QIODevice::WriteOnly);
+        stream.setVersion(streamVersion);
+
+        stream << quint8(CommitRecord) << sequence;
+
+        return payload;
+    }
+
+    QByteArray framedRecord(const QByteArray &payload)
+    {
+        QByteArray record(headerSize, Qt::Uninitialized);
+        qToLittleEndian<quint32>(quint32(payload.size()), record.data());
+        qToLittleEndian<quint32>(crc32(payload), record.data() + 4);
+        record.append(payload);
+
+        return record;
+    }
+
+    void syncFile(int handle)
+    {
+#ifdef Q_OS_LINUX
+        ::fdatasync(handle);
+#else
+        ::fsync(handle);
+#endif
+    }
+} // namespace
+
+EventJournal::EventJournal(const QString &path)
+    : m_file(path)
+    , m_lastSequence(0)
+    , m_committedSequence(0)
+    , m_dirty(false)
+{
+}
+
+EventJournal::~EventJournal()
+{
+    sync();
+}
+
+EventList EventJournal::recover()
+{
+    QMutexLocker locker(&m_mutex);
+
+    QVector<QPair<quint64, Event>> events;
+    quint64 committed = 0;
+
+    QFile file(m_file.fileName());
+
+    if (file.open(QIODevice::ReadOnly)) {
+        // The journal contains only the events from the last
+        // few seconds, it is safe to read it whole
+        const auto data = file.readAll();
+
+        int position = 0;
+
+        while (data.size() - position >= headerSize) {
+            const auto size = qFromLittleEndian<quint32>(data.constData() + position);
+            const auto checksum = qFromLittleEndian<quint32>(data.constData() + position + 4);
+
+            if (size > quint32(data.size() - position - headerSize)) {
+                break;
+            }
+
+            const auto payload = QByteArray::fromRawData(
+                    data.constData() + position + headerSize, int(size));
+
+            if (crc32(payload) != checksum) {
+                break;
+            }
+
+            QDataStream stream(payload);
+            stream.setVersion(streamVersion);
+
+            quint8 kind;
+            quint64 sequence;
+            stream >> kind >> sequence;
+
+            if (kind == CommitRecord) {
+                committed = qMax(committed, sequence);
+
+            } else if (kind == EventRecord) {
+                Event event;
+                quint64 wid;
+                qint32 type;
+
+                stream >> event.application >> wid >> event.uri >> type >> event.timestamp;
+
+                event.wid = quintptr(wid);
+                event.type = type;
+
+                if (stream.status() == QDataStream::Ok) {
+                    events << qMakePair(sequence, event);
+                }
+            }
+
+            position += headerSize + int(size);
+        }
+
+        if (position != data.size()) {
+            qCWarning(KAMD_LOG_RESOURCES) << "Ignoring the damaged end of the event journal"
+                                          << (data.size() - position) << "bytes";
+        }
+
+        file.close();
+    }
+
+    EventList result;
+
+    for (const auto &event: events) {
+        if (event.first > committed) {
+            result << event.second;
+        }
+    }
+
+    QDir().mkpath(QFileInfo(m_file.fileName()).absolutePath());
+
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Unbuffered)) {
+        qCWarning(KAMD_LOG_RESOURCES) << "Can not open the event journal"
+                                      << m_file.fileName() << m_file.errorString();
+        return result;
+    }
+
+    // The recovered events are journalled again, with the new
+    // sequence numbers, until they are committed
+    truncate();
+
+    for (const auto &event: result) {
+        ++m_lastSequence;
+        const auto record = framedRecord(eventRecord(m_lastSequence, event));
+        m_pending << qMakePair(m_lastSequence, record);
+        writeRecord(record);
+    }
+
+    if (m_dirty) {
+        syncFile(m_file.handle());
+        m_dirty = false;
+    }
+
+    return result;
+}
+
+quint64 EventJournal::append(const Event &event)
+{
+    QMutexLocker locker(&m_mutex);
+
+    ++m_lastSequence;
+    const auto record = framedRecord(eventRecord(m_lastSequence, event));
+    m_pending << qMakePair(m_lastSequence, record);
+    writeRecord(record);
+
+    return m_lastSequence;
+}
+
+void EventJournal::sync()
+{
+    int handle;
+
+    {
+        QMutexLocker locker(&m_mutex);
+
+        if (!m_dirty || !m_file.isOpen()) {
+            return;
+        }
+
+        m_dirty = false;
+        handle = m_file.handle();
+    }
+
+    // We do not want to block the appends while waiting for the disk
+    syncFile(handle);
+}
+
+void EventJournal::commit(quint64 sequence)
+{
+    QMutexLocker locker(&m_mutex);
+
+    if (sequence <= m_committedSequence) {
+        return;
+    }
+
+    m_committedSequence = sequence;
+
+    // The pending records are sorted by their sequence numbers
+    while (!m_pending.isEmpty() && m_pending.first().first <= sequence) {
+        m_pending.removeFirst();
+    }
+
+    if (m_pending.isEmpty()) {
+        // Nothing is waiting to be stored, the journal can be emptied
+        truncate();
+
+    } else if (m_file.isOpen() && m_file.size() >= compactionThreshold) {
+        // Under steady traffic, the journal is never empty at the time
+        // of the commit, so it would grow without bounds
+        compact();
+
+    } else {
+        writeRecord(framedRecord(commitRecord(sequence)));
+    }
+}
+
+quint64 EventJournal::lastSequence()
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_lastSequence;
+}
+
+void EventJournal::writeRecord(const QByteArray &record)
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+
+    // The file is unbuffered, this is a single write call
+    m_file.write(record);
+    m_dirty = true;
+}
+
+void EventJournal::truncate()
+{
+    if (!m_file.isOpen()) {
+        return;
+    }
+
+    m_file.resize(0);
+    syncFile(m_file.handle());
+    m_dirty = false;
+}
+
+void EventJournal::compact()
+{
+    // The uncommitted events are written to a new file which then
+    // replaces the journal, so that a crash in the middle of the
+    // compaction leaves either the old or the new journal behind
+    const auto path = m_file.fileName();
+    QFile file(path + QStringLiteral(".new"));
+
+    if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(KAMD_LOG_RESOURCES) << "Can not compact the event journal"
+                                      << file.fileName() << file.errorString();
+        writeRecord(framedRecord(commitRecord(m_committedSequence)));
+        return;
+    }
+
+    QByteArray data;
+    for (const auto &record: m_pending) {
+        data.append(record.second);
+    }
+
+    const bool written = file.write(data) == data.size() && file.flush();
+    syncFile(file.handle());
+    file.close();
+
+    if (!written || ::rename(QFile::encodeName(file.fileName()).constData(),
+                             QFile::encodeName(path).constData()) != 0) {
+        qCWarning(KAMD_LOG_RESOURCES) << "Can not compact the event journal" << path;
+        file.remove();
+        writeRecord(framedRecord(commitRecord(m_committedSequence)));
+        return;
+    }
+
+    m_file.close();
+
+    if (!m_file.open(QIODevice::WriteOnly | QIODevice::Append | QIODevice::Unbuffered)) {
+        qCWarning(KAMD_LOG_RESOURCES) << "Can not open the event journal"
+                                      << path << m_file.errorString();
+    }
+
+    m_dirty = false;
+}
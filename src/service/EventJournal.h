@@ -0,0 +1,96 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EVENT_JOURNAL_H
+#define EVENT_JOURNAL_H
+
+// Qt
+#include <QFile>
+#include <QList>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+
+// Local
+#include "Event.h"
+
+/**
+ * Append-only journal of the registered events.
+ *
+ * The events are appended to the journal as soon as they are registered,
+ * and the journal is synced to the disk in batches (see sync). When the
+ * plugins have stored a batch of events, a commit marker is appended.
+ * Once all the events are committed, the journal is truncated. If new
+ * events keep arriving, the journal is instead rewritten to contain only
+ * the uncommitted events when it grows too big.
+ *
+ * Each record is framed by its length and the CRC-32 of its payload,
+ * so that a torn write at the end of the journal is detected and ignored.
+ */
+class EventJournal {
+public:
+    explicit EventJournal(const QString &path);
+    ~EventJournal();
+
+    /**
+     * Reads the events that were not committed before the last shutdown
+     * or crash. The journal is rewritten to contain only those events.
+     */
+    EventList recover();
+
+    /**
+     * Appends the event to the journal
+     * @returns the sequence number of the event
+     */
+    quint64 append(const Event &event);
+
+    /**
+     * Makes sure the appended records are written to the disk
+     */
+    void sync();
+
+    /**
+     * Marks all the events up to and including the specified
+     * sequence number as stored
+     */
+    void commit(quint64 sequence);
+
+    /**
+     * @returns the sequence number of the last appended event
+     */
+    quint64 lastSequence();
+
+private:
+    void writeRecord(const QByteArray &record);
+    void truncate();
+    void compact();
+
+    QMutex m_mutex;
+    QFile m_file;
+
+    quint64 m_lastSequence;
+    quint64 m_committedSequence;
+    bool m_dirty;
+
+    // The records of the uncommitted events, needed for the compaction
+    QList<QPair<quint64, QByteArray>> m_pending;
+};
+
+#endif // EVENT_JOURNAL_H
@@ -0,0 +1,330 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Self
+#include "EventTracing.h"
+#include "MemoryUsage.h"
+
+// Qt
+#include <QCoreApplication>
+#include <QHash>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QVariantMap>
+
+// STL
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <deque>
+#include <mutex>
+
+// Utils
+#include <utils/latency_histogram.h>
+
+namespace {
+    typedef std::array<qint64, EventTracing::StageCount> StageTimes;
+
+    struct Trace {
+        quint64 id;
+        StageTimes times; // monotonic, in nanoseconds, zero if not reached
+    };
+
+    // The number of the traces we are following at the same time,
+    // the events that never reach the end are forgotten
+    const std::size_t maxActiveTraces = 4096;
+
+    // The number of the finished traces kept for the Chrome trace
+    const std::size_t maxFinishedTraces = 512;
+
+    const char *const stageNames[EventTracing::StageCount] = {
+        "Registered",
+        "Queued",
+        "Dispatched",
+        "Received",
+        "Stored",
+        "ScoreScheduled",
+        "ScoreUpdated",
+        "ScoreAnnounced"
+    };
+
+    // The tracing takes a lock for every stage of every event,
+    // it is turned on through tracing/enabled when it is needed
+    std::atomic<bool> enabled { false };
+
+    // The stages are marked from different threads
+    std::mutex tracing_mutex;
+
+    QHash<quint64, StageTimes> activeTraces;
+    std::deque<quint64> activeTracesOrder;
+    std::deque<Trace> finishedTraces;
+
+    // Time between the stage and the previous one, in microseconds
+    std::array<kamd::utils::latency_histogram, EventTracing::StageCount> stageLatencies;
+
+    // Time between the first and the last stage of the finished traces
+    kamd::utils::latency_histogram totalLatency;
+
+    qint64 now()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(
+                   std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    int stageFromName(const QString &name)
+    {
+        for (int stage = 0; stage < EventTracing::StageCount; ++stage) {
+            if (name == QLatin1String(stageNames[stage])) {
+                return stage;
+            }
+        }
+
+        return -1;
+    }
+
+    QVariantMap histogramValue(const kamd::utils::latency_histogram &histogram)
+    {
+        return QVariantMap {
+            { QStringLiteral("count"), histogram.count() },
+            { QStringLiteral("total"), histogram.total() },
+            { QStringLiteral("max"),   histogram.max() },
+            { QStringLiteral("p50"),   histogram.percentile(0.50) },
+            { QStringLiteral("p90"),   histogram.percentile(0.90) },
+            { QStringLiteral("p99"),   histogram.percentile(0.99) }
+        };
+    }
+
+    // Needs to be called with the mutex locked
+    void finishTrace(quint64 traceId)
+    {
+        const auto trace = activeTraces.find(traceId);
+
+        if (trace == activeTraces.end()) {
+            return;
+        }
+
+        qint64 first = 0;
+        qint64 last = 0;
+
+        for (const auto time: *trace) {
+            if (time == 0) continue;
+            if (first == 0) first = time;
+            last = time;
+        }
+
+        totalLatency.record(quint64(last - first) / 1000);
+
+        finishedTraces.push_back({ traceId, *trace });
+        if (finishedTraces.size() > maxFinishedTraces) {
+            finishedTraces.pop_front();
+        }
+
+        activeTraces.erase(trace);
+    }
+
+    QString chromeTrace()
+    {
+        const auto pid = QCoreApplication::applicationPid();
+
+        QJsonArray events;
+
+        for (const auto &trace: finishedTraces) {
+            int previous = -1;
+
+            for (int stage = 0; stage < EventTracing::StageCount; ++stage) {
+                if (trace.times[stage] == 0) continue;
+
+                // Each stage is shown as the span from the previous one
+                if (previous != -1) {
+                    const auto span = [&] (const char *phase, qint64 time) {
+                        return QJsonObject {
+                            { QStringLiteral("name"), QLatin1String(stageNames[stage]) },
+                            { QStringLiteral("cat"),  QStringLiteral("kamd") },
+                            { QStringLiteral("ph"),   QLatin1String(phase) },
+                            { QStringLiteral("id"),   QString::number(trace.id) },
+                            { QStringLiteral("pid"),  pid },
+                            { QStringLiteral("tid"),  0 },
+                            { QStringLiteral("ts"),   time / 1000.0 }
+                        };
+                    };
+
+                    events << span("b", trace.times[previous])
+                           << span("e", trace.times[stage]);
+                }
+
+                previous = stage;
+            }
+        }
+
+        return QString::fromUtf8(QJsonDocument(QJsonObject {
+                { QStringLiteral("traceEvents"), events },
+                { QStringLiteral("displayTimeUnit"), QStringLiteral("ms") }
+            }).toJson(QJsonDocument::Compact));
+    }
+} // namespace
+
+EventTracing::EventTracing(QObject *parent)
+    : Module(QStringLiteral("tracing"), parent)
+{
+    MemoryUsage::addReporter(QStringLiteral("tracing"), QStringLiteral("traces"), this, [] {
+        std::lock_guard<std::mutex> lock(tracing_mutex);
+
+        return MemoryUsage::Usage {
+            quint64(activeTraces.size() + finishedTraces.size()),
+            MemoryUsage::bytes(activeTraces)
+                + activeTracesOrder.size() * sizeof(quint64)
+                + finishedTraces.size() * sizeof(Trace)
+        };
+    });
+}
+
+EventTracing::~EventTracing()
+{
+}
+
+void EventTracing::mark(quint64 traceId, Stage stage)
+{
+    if (!enabled || traceId == 0) {
+        return;
+    }
+
+    const auto time = now();
+
+    std::lock_guard<std::mutex> lock(tracing_mutex);
+
+    auto trace = activeTraces.find(traceId);
+
+    if (trace == activeTraces.end()) {
+        // Forgetting the oldest traces. The order list can contain
+        // the ids of the finished traces as well, which is harmless
+        while (activeTracesOrder.size() >= maxActiveTraces) {
+            activeTraces.remove(activeTracesOrder.front());
+            activeTracesOrder.pop_front();
+        }
+
+        trace = activeTraces.insert(traceId, StageTimes {});
+        activeTracesOrder.push_back(traceId);
+    }
+
+    auto &times = *trace;
+
+    // The events derived from the registered one share its
+    // trace id, we are tracing the first one to reach the stage
+    if (times[stage] != 0) {
+        return;
+    }
+
+    times[stage] = time;
+
+    for (int previous = stage - 1; previous >= 0; --previous) {
+        if (times[previous] != 0) {
+            stageLatencies[stage].record(quint64(time - times[previous]) / 1000);
+            break;
+        }
+    }
+
+    if (stage == ScoreAnnounced) {
+        finishTrace(traceId);
+    }
+}
+
+void EventTracing::finish(quint64 traceId)
+{
+    if (!enabled || traceId == 0) {
+        return;
+    }
+
+    std::lock_guard<std::mutex> lock(tracing_mutex);
+
+    finishTrace(traceId);
+}
+
+bool EventTracing::isFeatureOperational(const QStringList &feature) const
+{
+    Q_UNUSED(feature);
+    return true;
+}
+
+QStringList EventTracing::listFeatures(const QStringList &feature) const
+{
+    if (feature.isEmpty() || feature[0].isEmpty()) {
+        return {
+            QStringLiteral("enabled"),
+            QStringLiteral("stages/"),
+            QStringLiteral("total"),
+            QStringLiteral("chrome")
+        };
+
+    } else if (feature[0] == QLatin1String("stages")) {
+        QStringList result;
+        for (const auto name: stageNames) {
+            result << QLatin1String(name);
+        }
+        return result;
+    }
+
+    return QStringList();
+}
+
+QDBusVariant EventTracing::featureValue(const QStringList &property) const
+{
+    if (property.isEmpty()) {
+        return QDBusVariant(false);
+    }
+
+    const auto &name = property[0];
+
+    if (name == QLatin1String("enabled")) {
+        return QDBusVariant(enabled.load());
+    }
+
+    std::lock_guard<std::mutex> lock(tracing_mutex);
+
+    if (name == QLatin1String("total")) {
+        return QDBusVariant(histogramValue(totalLatency));
+
+    } else if (name == QLatin1String("chrome")) {
+        return QDBusVariant(chromeTrace());
+
+    } else if (name == QLatin1String("stages") && property.size() == 2) {
+        const auto stage = stageFromName(property[1]);
+
+        if (stage != -1) {
+            return QDBusVariant(histogramValue(stageLatencies[stage]));
+        }
+    }
+
+    return QDBusVariant(false);
+}
+
+void EventTracing::setFeatureValue(const QStringList &property,
+                                   const QDBusVariant &value)
+{
+    if (property.size() == 1 && property[0] == QLatin1String("enabled")) {
+        enabled = value.variant().toBool();
+
+        if (!enabled) {
+            std::lock_guard<std::mutex> lock(tracing_mutex);
+            activeTraces.clear();
+            activeTracesOrder.clear();
+        }
+    }
+}
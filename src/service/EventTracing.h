@@ -0,0 +1,82 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef EVENT_TRACING_H
+#define EVENT_TRACING_H
+
+#include "kactivitymanagerd_plugin_export.h"
+
+// Local
+#include "Module.h"
+
+/**
+ * EventTracing measures how long the events spend in each stage of the
+ * processing, from the moment they are registered until the updated
+ * score of the resource is announced.
+ *
+ * Each event carries a trace id (see Event::traceId). The stages call
+ * mark with the id of the event, and the time passed since the previous
+ * stage the event went through is added to the histogram of the stage.
+ * The last completed traces are kept to be exported as Chrome trace
+ * JSON (chrome://tracing, Perfetto).
+ *
+ * The data is available through the Features interface as the "tracing"
+ * module -- tracing/stages/<stage> returns the latency percentiles in
+ * microseconds, tracing/total the latency of the whole processing,
+ * tracing/chrome the trace JSON, and tracing/enabled turns
+ * the tracing on and off. The tracing is off by default.
+ */
+class KACTIVITYMANAGERD_PLUGIN_EXPORT EventTracing: public Module {
+    Q_OBJECT
+
+public:
+    enum Stage {
+        Registered,     ///< Resources received the event
+        Queued,         ///< the event was put into the queue of Resources
+        Dispatched,     ///< the event was passed on to the plugins
+        Received,       ///< the event reached StatsPlugin::addEvents
+        Stored,         ///< the event was written to the database
+        ScoreScheduled, ///< the score of the resource needs to be updated
+        ScoreUpdated,   ///< ResourceScoreCache updated the score
+        ScoreAnnounced, ///< ResourceScoreUpdated was emitted
+        StageCount
+    };
+
+    explicit EventTracing(QObject *parent = nullptr);
+    ~EventTracing() override;
+
+    /**
+     * Records that the event with the specified trace id
+     * has reached the stage
+     */
+    static void mark(quint64 traceId, Stage stage);
+
+    /**
+     * Records that nothing more will happen with the event
+     */
+    static void finish(quint64 traceId);
+
+    bool isFeatureOperational(const QStringList &feature) const override;
+    QStringList listFeatures(const QStringList &feature) const override;
+    QDBusVariant featureValue(const QStringList &property) const override;
+    void setFeatureValue(const QStringList &property, const QDBusVariant &value) override;
+};
+
+#endif // EVENT_TRACING_H
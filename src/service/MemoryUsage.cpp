@@ -0,0 +1,222 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Self
+#include "MemoryUsage.h"
+
+// Qt
+#include <QFile>
+#include <QPointer>
+#include <QThread>
+
+// STL
+#include <algorithm>
+#include <map>
+#include <mutex>
+#include <vector>
+
+// System
+#include <unistd.h>
+#if defined(__GLIBC__)
+#include <malloc.h>
+#endif
+
+namespace {
+    struct Registration {
+        QString structure;
+        QPointer<QObject> context;
+        MemoryUsage::Reporter reporter;
+    };
+
+    std::mutex reporters_mutex;
+
+    // Module name -> registered structures
+    std::map<QString, std::vector<Registration>> reporters;
+
+    // Returns the registrations for the module, forgetting the ones
+    // whose context objects have been destroyed
+    std::vector<Registration> registrationsFor(const QString &module)
+    {
+        std::lock_guard<std::mutex> lock(reporters_mutex);
+
+        auto it = reporters.find(module);
+        if (it == reporters.end()) {
+            return {};
+        }
+
+        auto &registrations = it->second;
+        registrations.erase(
+            std::remove_if(registrations.begin(), registrations.end(),
+                           [] (const Registration &registration) {
+                               return registration.context.isNull();
+                           }),
+            registrations.end());
+
+        return registrations;
+    }
+
+    // Calls the reporter in the thread its context object lives in.
+    // This must not be called with the reporters_mutex locked
+    bool report(const Registration &registration, MemoryUsage::Usage &usage)
+    {
+        QObject *context = registration.context.data();
+
+        if (!context) {
+            return false;
+        }
+
+        if (context->thread() == QThread::currentThread()) {
+            usage = registration.reporter();
+
+        } else {
+            QMetaObject::invokeMethod(context, [&] {
+                usage = registration.reporter();
+            }, Qt::BlockingQueuedConnection);
+        }
+
+        return true;
+    }
+
+    QVariantMap usageValue(const MemoryUsage::Usage &usage)
+    {
+        return {
+            { QStringLiteral("entries"), qulonglong(usage.entries) },
+            { QStringLiteral("bytes"),   qulonglong(usage.bytes) }
+        };
+    }
+} // namespace
+
+MemoryUsage::MemoryUsage(QObject *parent)
+    : Module(QStringLiteral("memory"), parent)
+{
+}
+
+MemoryUsage::~MemoryUsage()
+{
+}
+
+void MemoryUsage::addReporter(const QString &module, const QString &structure,
+                              QObject *context, const Reporter &reporter)
+{
+    std::lock_guard<std::mutex> lock(reporters_mutex);
+
+    auto &registrations = reporters[module];
+
+    for (auto &registration: registrations) {
+        if (registration.structure == structure) {
+            registration.context = context;
+            registration.reporter = reporter;
+            return;
+        }
+    }
+
+    registrations.push_back({ structure, context, reporter });
+}
+
+quint64 MemoryUsage::residentSetSize()
+{
+    // The second field of statm is the number of resident pages
+    QFile statm(QStringLiteral("/proc/self/statm"));
+
+    if (!statm.open(QIODevice::ReadOnly)) {
+        return 0;
+    }
+
+    const auto fields = statm.readAll().split(' ');
+
+    return fields.size() < 2
+               ? 0
+               : fields[1].toULongLong() * quint64(sysconf(_SC_PAGESIZE));
+}
+
+QVariantMap MemoryUsage::trim()
+{
+    const auto before = residentSetSize();
+
+#if defined(__GLIBC__)
+    const bool trimmed = malloc_trim(0) != 0;
+#else
+    const bool trimmed = false;
+#endif
+
+    const auto after = residentSetSize();
+
+    return {
+        { QStringLiteral("trimmed"),   trimmed },
+        { QStringLiteral("rssBefore"), qulonglong(before) },
+        { QStringLiteral("rssAfter"),  qulonglong(after) }
+    };
+}
+
+bool MemoryUsage::isFeatureOperational(const QStringList &feature) const
+{
+    Q_UNUSED(feature);
+    return true;
+}
+
+QStringList MemoryUsage::listFeatures(const QStringList &feature) const
+{
+    QStringList result;
+
+    if (feature.isEmpty() || feature[0].isEmpty()) {
+        result << QStringLiteral("rss");
+
+        std::lock_guard<std::mutex> lock(reporters_mutex);
+        for (const auto &module: reporters) {
+            result << module.first + QLatin1Char('/');
+        }
+
+    } else {
+        for (const auto &registration: registrationsFor(feature[0])) {
+            result << registration.structure;
+        }
+    }
+
+    return result;
+}
+
+QDBusVariant MemoryUsage::featureValue(const QStringList &property) const
+{
+    if (property.isEmpty()) {
+        return QDBusVariant(false);
+    }
+
+    if (property.size() == 1 && property[0] == QLatin1String("rss")) {
+        return QDBusVariant(qulonglong(residentSetSize()));
+    }
+
+    Usage total { 0, 0 };
+    bool found = false;
+
+    for (const auto &registration: registrationsFor(property[0])) {
+        if (property.size() > 1 && registration.structure != property[1]) {
+            continue;
+        }
+
+        Usage usage { 0, 0 };
+        if (report(registration, usage)) {
+            total.entries += usage.entries;
+            total.bytes   += usage.bytes;
+            found = true;
+        }
+    }
+
+    return found ? QDBusVariant(usageValue(total)) : QDBusVariant(false);
+}
@@ -0,0 +1,116 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef MEMORY_USAGE_H
+#define MEMORY_USAGE_H
+
+#include "kactivitymanagerd_plugin_export.h"
+
+// Qt
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QVariantMap>
+
+// STL
+#include <functional>
+
+// Local
+#include "Module.h"
+
+/**
+ * MemoryUsage collects the approximate sizes of the in-memory structures
+ * of the modules and plugins, so that we can see which one is growing
+ * in a long-running session.
+ *
+ * The modules register a reporter for each of their structures. It is
+ * called in the thread of the specified context object, so it can read
+ * the structure without additional locking.
+ *
+ * The data is available through the Features interface as the "memory"
+ * module -- memory/<module>/<structure> returns the number of entries
+ * and the approximate number of bytes, memory/<module> the totals for
+ * the module, and memory/rss the resident set size of the process.
+ */
+class KACTIVITYMANAGERD_PLUGIN_EXPORT MemoryUsage: public Module {
+    Q_OBJECT
+
+public:
+    struct Usage {
+        quint64 entries;
+        quint64 bytes;
+    };
+
+    typedef std::function<Usage()> Reporter;
+
+    explicit MemoryUsage(QObject *parent = nullptr);
+    ~MemoryUsage() override;
+
+    /**
+     * Registers the reporter for memory/<module>/<structure>.
+     * The reporter is removed when the context object is destroyed.
+     */
+    static void addReporter(const QString &module, const QString &structure,
+                            QObject *context, const Reporter &reporter);
+
+    /**
+     * Returns the resident set size of the process in bytes
+     */
+    static quint64 residentSetSize();
+
+    /**
+     * Returns the unused heap memory to the system (malloc_trim),
+     * the result contains the resident set size before and after
+     */
+    static QVariantMap trim();
+
+    // Helpers for estimating the sizes of the data the objects allocate,
+    // not including the objects themselves. They do not take into
+    // account the implicit sharing nor the allocator overhead
+
+    static quint64 bytes(const QString &string)
+    {
+        return sizeof(QArrayData)
+               + quint64(string.capacity() + 1) * sizeof(QChar);
+    }
+
+    template <typename Key, typename Value>
+    static quint64 bytes(const QHash<Key, Value> &hash)
+    {
+        // The buckets, and the nodes containing the next pointer
+        // and the hash value along with the key and the value
+        return quint64(hash.capacity()) * sizeof(void *)
+               + quint64(hash.size())
+                     * (sizeof(Key) + sizeof(Value) + 2 * sizeof(void *));
+    }
+
+    template <typename Value>
+    static quint64 bytes(const QSet<Value> &set)
+    {
+        return quint64(set.capacity()) * sizeof(void *)
+               + quint64(set.size()) * (sizeof(Value) + 2 * sizeof(void *));
+    }
+
+    bool isFeatureOperational(const QStringList &feature) const override;
+    QStringList listFeatures(const QStringList &feature) const override;
+    QDBusVariant featureValue(const QStringList &property) const override;
+};
+
+#endif // MEMORY_USAGE_H
@@ -0,0 +1,255 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Self
+#include "RateLimiter.h"
+
+// Qt
+#include <QMutexLocker>
+
+// KDE
+#include <kconfiggroup.h>
+
+// STL
+#include <algorithm>
+#include <chrono>
+
+namespace {
+    // Protects the memory from the clients that flood us with
+    // the events for different resources, the events above the
+    // limit are only counted
+    const int maxCoalescedResources = 10000;
+
+    // The same for the clients that register the events under
+    // many different application names
+    const int maxBuckets = 1000;
+
+    qint64 monotonicTime()
+    {
+        using namespace std::chrono;
+        return duration_cast<milliseconds>(
+                   steady_clock::now().time_since_epoch()).count();
+    }
+} // namespace
+
+RateLimiter::RateLimiter()
+    : m_defaultLimit { 0, 100 }
+    , m_coalescingWindow(10000)
+{
+}
+
+RateLimiter::~RateLimiter()
+{
+}
+
+void RateLimiter::load(const KConfigGroup &config)
+{
+    QMutexLocker locker(&m_mutex);
+
+    m_defaultLimit.rate  = config.readEntry("rate", 0.0);
+    m_defaultLimit.burst = config.readEntry("burst", 100.0);
+
+    m_coalescingWindow = std::max(1, config.readEntry("coalescing-window", 10)) * 1000;
+
+    m_limits.clear();
+    for (const auto &application: config.groupList()) {
+        const auto group = config.group(application);
+        m_limits[application] = Limit {
+            group.readEntry("rate", m_defaultLimit.rate),
+            group.readEntry("burst", m_defaultLimit.burst)
+        };
+    }
+
+    for (auto it = m_buckets.begin(); it != m_buckets.end(); ++it) {
+        it->limit = m_limits.value(it.key(), m_defaultLimit);
+        it->tokens = std::min(it->tokens, it->limit.burst);
+    }
+}
+
+int RateLimiter::coalescingWindow() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_coalescingWindow;
+}
+
+RateLimiter::Bucket &RateLimiter::bucketFor(const QString &application)
+{
+    auto it = m_buckets.find(application);
+
+    if (it == m_buckets.end()) {
+        const auto now = monotonicTime();
+
+        if (m_buckets.size() >= maxBuckets) {
+            expireBuckets(now);
+        }
+
+        const auto limit = m_limits.value(application, m_defaultLimit);
+        it = m_buckets.insert(application,
+                              Bucket { limit, limit.burst, now, 0, 0, 0 });
+    }
+
+    return *it;
+}
+
+void RateLimiter::expireBuckets(qint64 now)
+{
+    // A bucket that has been refilled since it was last used is the
+    // same as a new one, apart from the statistics
+    auto oldest = m_buckets.end();
+
+    for (auto it = m_buckets.begin(); it != m_buckets.end(); ) {
+        const bool refilled = it->limit.rate <= 0
+            || it->tokens + (now - it->lastRefill) * it->limit.rate / 1000.0 >= it->limit.burst;
+
+        if (refilled) {
+            it = m_buckets.erase(it);
+
+        } else {
+            if (oldest == m_buckets.end() || it->lastRefill < oldest->lastRefill) {
+                oldest = it;
+            }
+            ++it;
+        }
+    }
+
+    // If all of them are in use, we are being flooded,
+    // the longest unused one goes away
+    if (m_buckets.size() >= maxBuckets && oldest != m_buckets.end()) {
+        m_buckets.erase(oldest);
+    }
+}
+
+bool RateLimiter::acquire(const QString &application)
+{
+    QMutexLocker locker(&m_mutex);
+
+    // The applications that are not limited do not need a bucket,
+    // only the statistics of an existing one are updated
+    if (m_limits.value(application, m_defaultLimit).rate <= 0) {
+        const auto it = m_buckets.find(application);
+        if (it != m_buckets.end()) {
+            ++it->accepted;
+        }
+        return true;
+    }
+
+    auto &bucket = bucketFor(application);
+
+    const auto now = monotonicTime();
+
+    bucket.tokens = std::min(bucket.limit.burst,
+                             bucket.tokens + (now - bucket.lastRefill) * bucket.limit.rate / 1000.0);
+    bucket.lastRefill = now;
+
+    if (bucket.tokens < 1) {
+        return false;
+    }
+
+    bucket.tokens -= 1;
+    ++bucket.accepted;
+
+    return true;
+}
+
+bool RateLimiter::coalesce(const QString &application, const QString &uri)
+{
+    QMutexLocker locker(&m_mutex);
+
+    ++bucketFor(application).coalesced;
+
+    const bool isFirst = m_coalesced.isEmpty();
+
+    const auto key = qMakePair(application, uri);
+    auto it = m_coalesced.find(key);
+
+    if (it != m_coalesced.end()) {
+        it->lastEvent = QDateTime::currentMSecsSinceEpoch();
+        ++it->count;
+
+    } else if (m_coalesced.size() < maxCoalescedResources) {
+        m_coalesced.insert(key,
+            Summary { application, uri, QDateTime::currentMSecsSinceEpoch(), 1 });
+    }
+
+    return isFirst;
+}
+
+QVector<RateLimiter::Summary> RateLimiter::takeSummaries()
+{
+    QMutexLocker locker(&m_mutex);
+
+    QVector<Summary> result;
+    result.reserve(m_coalesced.size());
+
+    for (const auto &summary: m_coalesced) {
+        ++bucketFor(summary.application).summaries;
+        result << summary;
+    }
+
+    m_coalesced.clear();
+
+    return result;
+}
+
+QStringList RateLimiter::applications() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    return m_buckets.keys();
+}
+
+QVariantMap RateLimiter::statistics(const QString &application) const
+{
+    QMutexLocker locker(&m_mutex);
+
+    const auto it = m_buckets.constFind(application);
+
+    if (it == m_buckets.cend()) {
+        return QVariantMap();
+    }
+
+    return {
+        { QStringLiteral("rate"),      it->limit.rate },
+        { QStringLiteral("burst"),     it->limit.burst },
+        { QStringLiteral("accepted"),  qulonglong(it->accepted) },
+        { QStringLiteral("coalesced"), qulonglong(it->coalesced) },
+        { QStringLiteral("summaries"), qulonglong(it->summaries) }
+    };
+}
+
+MemoryUsage::Usage RateLimiter::memoryUsage() const
+{
+    QMutexLocker locker(&m_mutex);
+
+    quint64 bytes = MemoryUsage::bytes(m_buckets) + MemoryUsage::bytes(m_coalesced);
+
+    for (auto it = m_buckets.cbegin(); it != m_buckets.cend(); ++it) {
+        bytes += MemoryUsage::bytes(it.key());
+    }
+
+    for (const auto &summary: m_coalesced) {
+        // The key shares the strings with the summary
+        bytes += MemoryUsage::bytes(summary.application)
+               + MemoryUsage::bytes(summary.uri);
+    }
+
+    return MemoryUsage::Usage { quint64(m_buckets.size() + m_coalesced.size()), bytes };
+}
@@ -0,0 +1,152 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef RATE_LIMITER_H
+#define RATE_LIMITER_H
+
+// Qt
+#include <QDateTime>
+#include <QHash>
+#include <QMutex>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QVariantMap>
+#include <QVector>
+
+// Local
+#include "MemoryUsage.h"
+
+class KConfigGroup;
+
+/**
+ * Limits the rate of the events the applications can register.
+ *
+ * Each application has a token bucket which is refilled at the
+ * configured rate (events per second) up to the burst size. The events
+ * that come when the bucket is empty are not registered, they are
+ * coalesced instead -- for each application and resource, one Accessed
+ * event summarizing them is registered at the end of the coalescing
+ * window.
+ *
+ * Only the Accessed and Modified events are limited, see
+ * Resources::RegisterResourceEvent.
+ *
+ * The limits are read from the [RateLimits] group of
+ * kactivitymanagerd-pluginsrc:
+ *
+ *     [RateLimits]
+ *     rate=20
+ *     burst=100
+ *     coalescing-window=10
+ *
+ *     [RateLimits][org.kde.konsole]
+ *     rate=5
+ *     burst=20
+ *
+ * A rate of zero disables the limiting for the application. The limiting
+ * is disabled by default, the event traces recorded for the replay tool
+ * show how many events would be coalesced with the given limits.
+ *
+ * The buckets are kept only for the limited applications, and the ones
+ * which have been refilled are dropped when there are too many of them.
+ *
+ * The methods can be called from any thread.
+ */
+class RateLimiter {
+public:
+    struct Limit {
+        double rate;
+        double burst;
+    };
+
+    struct Summary {
+        QString application;
+        QString uri;
+        qint64 lastEvent; // milliseconds since the epoch
+        quint64 count;
+    };
+
+    RateLimiter();
+    ~RateLimiter();
+
+    void load(const KConfigGroup &config);
+
+    /**
+     * @returns the length of the coalescing window in milliseconds
+     */
+    int coalescingWindow() const;
+
+    /**
+     * Takes a token from the bucket of the application
+     * @returns false if the event exceeds the limit
+     */
+    bool acquire(const QString &application);
+
+    /**
+     * Remembers the event that exceeded the limit
+     * @returns true if this is the first event coalesced in the
+     *          current window, meaning that the window needs to be started
+     */
+    bool coalesce(const QString &application, const QString &uri);
+
+    /**
+     * Returns the coalesced events, and starts a new window
+     */
+    QVector<Summary> takeSummaries();
+
+    QStringList applications() const;
+
+    /**
+     * The limit of the application and the numbers of the accepted,
+     * coalesced, and summary events
+     */
+    QVariantMap statistics(const QString &application) const;
+
+    /**
+     * The number of the tracked applications and coalesced events,
+     * and the approximate memory they take
+     */
+    MemoryUsage::Usage memoryUsage() const;
+
+private:
+    struct Bucket {
+        Limit limit;
+        double tokens;
+        qint64 lastRefill; // monotonic, in milliseconds
+        quint64 accepted;
+        quint64 coalesced;
+        quint64 summaries;
+    };
+
+    Bucket &bucketFor(const QString &application);
+    void expireBuckets(qint64 now);
+
+    mutable QMutex m_mutex;
+
+    Limit m_defaultLimit;
+    QHash<QString, Limit> m_limits;
+    int m_coalescingWindow;
+
+    QHash<QString, Bucket> m_buckets;
+    QHash<QPair<QString, QString>, Summary> m_coalesced;
+};
+
+#endif // RATE_LIMITER_H
@@ -23,17 +23,25 @@
 #include "Resources_p.h"
 
 // Qt
+#include <QCoreApplication>
 #include <QDBusConnection>
+#include <QHash>
+#include <QPair>
+#include <QStandardPaths>
 #include <QThread>
 #include <QMutex>
 #include <QMutexLocker>
+#include <QVector>
 
 // KDE
-#include <kwindowsystem.h>
+#include <kconfiggroup.h>
+#include <ksharedconfig.h>
 
 // Utils
 #include <utils/d_ptr_implementation.h>
-#include <utils/remove_if.h>
+
+// STL
+#include <atomic>
 
 // System
 #include <time.h>
@@ -41,15 +49,56 @@
 // Local
 #include "Application.h"
 #include "Activities.h"
+#include "EventTracing.h"
+#include "MemoryUsage.h"
+#include "RateLimiter.h"
+#include "WindowEventSource.h"
 #include "resourcesadaptor.h"
 #include "common/dbus/common.h"
+#include "common/eventtrace.h"
+#include "DebugResources.h"
 
 
 Resources::Private::Private(Resources *parent)
     : QThread(parent)
+    , journal(std::make_shared<EventJournal>(
+          QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
+          + QStringLiteral("/kactivitymanagerd/resources/events.journal")))
+    , lastJournalledEvent(0)
+    , pluginsReady(false)
     , focussedWindow(0)
+    , coalescingTimer(new QTimer(parent))
     , q(parent)
 {
+    coalescingTimer->setSingleShot(true);
+    connect(coalescingTimer, &QTimer::timeout,
+            this, &Private::addCoalescedEvents);
+
+    // The windows are tracked in the thread of Resources
+    MemoryUsage::addReporter(QStringLiteral("resources"), QStringLiteral("windows"), parent, [this] {
+        quint64 bytes = MemoryUsage::bytes(windows);
+
+        for (const auto &window: windows) {
+            bytes += MemoryUsage::bytes(window.resources)
+                   + MemoryUsage::bytes(window.focussedResource)
+                   + MemoryUsage::bytes(window.application);
+            for (const auto &resource: window.resources) {
+                bytes += MemoryUsage::bytes(resource);
+            }
+        }
+
+        return MemoryUsage::Usage { quint64(windows.size()), bytes };
+    });
+
+    MemoryUsage::addReporter(QStringLiteral("resources"), QStringLiteral("strings"), parent, [this] {
+        quint64 bytes = MemoryUsage::bytes(strings.strings());
+
+        for (const auto &string: strings.strings()) {
+            bytes += MemoryUsage::bytes(string);
+        }
+
+        return MemoryUsage::Usage { quint64(strings.strings().size()), bytes };
+    });
 }
 
 Resources::Private::~Private()
@@ -59,32 +108,248 @@ Resources::Private::~Private()
 }
 
 namespace {
-EventList events;
+
+// The events waiting to be passed on to the plugins.
+//
+// The events that are superseded by the later ones (see addEvent) are
+// not removed from the middle of the queue, they are only marked as
+// such and skipped when the events are taken out. This keeps all the
+// operations done while registering an event O(1), amortized.
+class EventQueue {
+public:
+    int size() const
+    {
+        return m_live;
+    }
+
+    bool isEmpty() const
+    {
+        return m_live == 0;
+    }
+
+    void append(const Event &event)
+    {
+        m_positions[keyOf(event)] << m_events.size();
+        m_events << event;
+        m_superseded << false;
+        ++m_live;
+    }
+
+    // Returns the last queued event for the same application and
+    // resource as the specified one, or nullptr if there is none
+    const Event *last(const Event &event) const
+    {
+        const auto it = m_positions.constFind(keyOf(event));
+        return it == m_positions.cend() ? nullptr : &m_events[it->last()];
+    }
+
+    // Removes the last queued event for the same application and
+    // resource as the specified one
+    void removeLast(const Event &event)
+    {
+        auto it = m_positions.find(keyOf(event));
+        if (it == m_positions.end()) {
+            return;
+        }
+
+        m_superseded[it->takeLast()] = true;
+        --m_live;
+
+        if (it->isEmpty()) {
+            m_positions.erase(it);
+        }
+    }
+
+    // Removes all the queued events for the same application
+    // and resource as the specified one
+    void removeAll(const Event &event)
+    {
+        const auto positions = m_positions.take(keyOf(event));
+
+        for (const auto position: positions) {
+            m_superseded[position] = true;
+        }
+
+        m_live -= positions.size();
+    }
+
+    EventList take()
+    {
+        EventList result;
+        result.reserve(m_live);
+
+        for (int i = 0; i < m_events.size(); ++i) {
+            if (!m_superseded[i]) {
+                result << m_events[i];
+            }
+        }
+
+        m_events.clear();
+        m_superseded.clear();
+        m_positions.clear();
+        m_live = 0;
+
+        return result;
+    }
+
+    void prepend(const EventList &events)
+    {
+        const auto current = take();
+
+        for (const auto &event: events + current) {
+            append(event);
+        }
+    }
+
+    // All the events in the queue, including the superseded ones
+    const QVector<Event> &entries() const
+    {
+        return m_events;
+    }
+
+private:
+    typedef QPair<QString, QString> Key;
+
+    static Key keyOf(const Event &event)
+    {
+        return Key(event.application, event.uri);
+    }
+
+    QVector<Event> m_events;
+    QVector<bool> m_superseded;
+    QHash<Key, QVector<int>> m_positions;
+    int m_live = 0;
+};
+
+EventQueue events;
 QMutex events_mutex;
+
+// When there are more events in the queue than the high-water mark,
+// the low-value ones are shed. Above the hard limit, the new Accessed
+// and FocussedIn events are dropped, so that a flood can not exhaust
+// the memory. The events that end the spans started by the queued
+// ones (and the ones that start them) are kept, otherwise the plugins
+// would see resources which are never closed or focussed out
+std::atomic<int> queueHighWaterMark { 10000 };
+const int queueHardLimitFactor = 4;
+
+std::atomic<quint64> shedFocusEvents { 0 };
+std::atomic<quint64> shedAccessedEvents { 0 };
+std::atomic<quint64> droppedEvents { 0 };
+
+// Returns whether the event should not be queued. If it cancels
+// out the last queued event, that one is removed from the queue.
+// Needs to be called with events_mutex locked
+bool shedEvent(const Event &event)
+{
+    const int highWaterMark = queueHighWaterMark;
+
+    if (highWaterMark <= 0 || events.size() < highWaterMark) {
+        return false;
+    }
+
+    if (events.size() >= highWaterMark * queueHardLimitFactor
+            && (event.type == Event::Accessed || event.type == Event::FocussedIn)) {
+        ++droppedEvents;
+        return true;
+    }
+
+    const auto last = events.last(event);
+
+    if (!last) {
+        return false;
+    }
+
+    switch (event.type) {
+        case Event::Accessed:
+            // The resource is already going to be marked as accessed
+            if (last->type == Event::Accessed) {
+                ++shedAccessedEvents;
+                return true;
+            }
+            break;
+
+        case Event::FocussedIn:
+        case Event::FocussedOut:
+            // The focus went away and came back (or the other way
+            // round) before the queue was processed
+            if ((last->type == Event::FocussedIn || last->type == Event::FocussedOut)
+                    && last->type != event.type) {
+                events.removeLast(event);
+                shedFocusEvents += 2;
+                return true;
+            }
+            break;
+
+        default:
+            break;
+    }
+
+    return false;
 }
 
+} // namespace
+
 void Resources::Private::run()
 {
     while (!isInterruptionRequested()) {
-        // initial delay before processing the events
-        sleep(1);
+        // initial delay before processing the events. The journal
+        // is synced more often than that, so that the events
+        // become durable soon after they are registered
+        for (int tick = 0; tick < 10 && !isInterruptionRequested(); ++tick) {
+            msleep(100);
+            journal->sync();
+        }
 
         EventList currentEvents;
+        quint64 lastEvent;
 
         {
             QMutexLocker locker(&events_mutex);
 
-            if (events.count() == 0) {
+            if (events.isEmpty()) {
                 return;
             }
 
-            std::swap(currentEvents, events);
+            currentEvents = events.take();
+            lastEvent = lastJournalledEvent;
+        }
+
+        for (const auto &event: currentEvents) {
+            EventTracing::mark(event.traceId, EventTracing::Dispatched);
         }
 
         emit q->ProcessedResourceEvents(currentEvents);
+
+        // The plugins live in the main thread, so the events are
+        // delivered to them through its event queue. The commit marker
+        // is posted to the same queue after the events, which means
+        // it gets processed when the plugins have stored them. The
+        // plugins that aggregate the events in memory (the focus time
+        // and the edit sessions of the sqlite plugin) do not store
+        // them that soon, they document what a crash loses
+        QMetaObject::invokeMethod(QCoreApplication::instance(),
+            [journal = journal, lastEvent] {
+                journal->commit(lastEvent);
+            },
+            Qt::QueuedConnection);
     }
 }
 
+void Resources::Private::recoverJournal()
+{
+    const auto recovered = journal->recover();
+
+    if (recovered.isEmpty()) {
+        return;
+    }
+
+    QMutexLocker locker(&events_mutex);
+
+    events.prepend(recovered);
+    lastJournalledEvent = journal->lastSequence();
+}
+
 void Resources::Private::insertEvent(const Event &newEvent)
 {
     if (lastEvent == newEvent) {
@@ -93,9 +358,23 @@ void Resources::Private::insertEvent(const Event &newEvent)
 
     lastEvent = newEvent;
 
+    bool shed;
+
     {
         QMutexLocker locker(&events_mutex);
-        events << newEvent;
+
+        shed = shedEvent(newEvent);
+
+        if (!shed) {
+            events.append(newEvent);
+            lastJournalledEvent = journal->append(newEvent);
+        }
+    }
+
+    if (shed) {
+        EventTracing::finish(newEvent.traceId);
+    } else {
+        EventTracing::mark(newEvent.traceId, EventTracing::Queued);
     }
 
     emit q->RegisteredResourceEvent(newEvent);
@@ -104,7 +383,8 @@ void Resources::Private::insertEvent(const Event &newEvent)
 void Resources::Private::addEvent(const QString &application, WId wid,
                                   const QString &uri, int type)
 {
-    Event newEvent(application, wid, uri, type);
+    Event newEvent(strings.intern(application), wid, strings.intern(uri), type);
+    EventTracing::mark(newEvent.traceId, EventTracing::Registered);
     addEvent(newEvent);
 }
 
@@ -115,14 +395,11 @@ void Resources::Private::addEvent(const Event &newEvent)
         QMutexLocker locker(&events_mutex);
 
         // Deleting previously registered Accessed events if
-        // the current one has the same application and uri
+        // the current one has the same application and uri.
+        // They stay in the journal, and would be replayed
+        // only if we crashed before this batch was stored
         if (newEvent.type != Event::Accessed) {
-            kamd::utils::remove_if(events, [&newEvent](const Event &event)->bool {
-                return
-                    event.application == newEvent.application &&
-                    event.uri         == newEvent.uri
-                ;
-            });
+            events.removeAll(newEvent);
         }
     }
 
@@ -205,7 +482,54 @@ void Resources::Private::addEvent(const Event &newEvent)
         }
     }
 
-    start();
+    scheduleProcessing();
+}
+
+void Resources::Private::scheduleProcessing()
+{
+    if (pluginsReady) {
+        start();
+    }
+}
+
+void Resources::Private::addCoalescedEvents()
+{
+    for (const auto &summary: rateLimiter.takeSummaries()) {
+        Event event(strings.intern(summary.application), 0,
+                    strings.intern(summary.uri), Event::Accessed);
+        event.timestamp = summary.lastEvent;
+
+        EventTracing::mark(event.traceId, EventTracing::Registered);
+        addEvent(event);
+    }
+}
+
+void Resources::Private::startRecording(const QString &path)
+{
+    traceFile.reset(new QFile(path));
+
+    if (!traceFile->open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+        qCWarning(KAMD_LOG_RESOURCES) << "Can not open the event trace" << path;
+        traceFile.reset();
+        return;
+    }
+
+    traceStream.setDevice(traceFile.get());
+    Common::EventTrace::writeHeader(traceStream);
+}
+
+void Resources::Private::record(const QString &application, uint windowId,
+                                const QString &uri, uint event)
+{
+    if (!traceFile) {
+        return;
+    }
+
+    using Common::EventTrace::operator<<;
+
+    traceStream << Common::EventTrace::Record {
+            QDateTime::currentMSecsSinceEpoch(), application, windowId, uri, event
+        };
 }
 
 void Resources::Private::windowClosed(WId windowId)
@@ -220,11 +544,14 @@ void Resources::Private::windowClosed(WId windowId)
         focussedWindow = 0;
     }
 
-    // Closing all the resources that the window registered
+    // Closing all the resources that the window registered. These
+    // events are ours, they do not go through the rate limiting
+
+    const auto window = windows[windowId];
 
-    for (const QString &uri: windows[windowId].resources) {
-        q->RegisterResourceEvent(windows[windowId].application,
-                                 windowId, uri, Event::Closed);
+    for (const QString &uri: window.resources) {
+        record(window.application, windowId, uri, Event::Closed);
+        addEvent(window.application, windowId, uri, Event::Closed);
     }
 
     windows.remove(windowId);
@@ -261,7 +588,7 @@ void Resources::Private::activeWindowChanged(WId windowId)
     }
 }
 
-Resources::Resources(QObject *parent)
+Resources::Resources(QObject *parent, WindowEventSource *windowEvents)
     : Module(QStringLiteral("resources"), parent)
     , d(this)
 {
@@ -269,20 +596,147 @@ Resources::Resources(QObject *parent)
     qRegisterMetaType<EventList>("EventList");
     qRegisterMetaType<WId>("WId");
 
+    // A high-water mark of zero disables the load shedding
+    queueHighWaterMark =
+        KSharedConfig::openConfig(QStringLiteral("kactivitymanagerdrc"))
+            ->group("Resources")
+            .readEntry("queue-high-water-mark", queueHighWaterMark.load());
+
+    loadConfiguration();
+
+    d->recoverJournal();
+
+    // The incoming events can be recorded to be replayed later
+    // by kactivitymanagerd_replay when tuning the event processing
+    const auto tracePath = qEnvironmentVariable("KAMD_RECORD_EVENTS");
+    if (!tracePath.isEmpty()) {
+        d->startRecording(tracePath);
+    }
+
     new ResourcesAdaptor(this);
     QDBusConnection::sessionBus().registerObject(
         KAMD_DBUS_OBJECT_PATH(Resources), this);
 
-    connect(KWindowSystem::self(), &KWindowSystem::windowRemoved,
-            d.operator->(),        &Resources::Private::windowClosed);
-    connect(KWindowSystem::self(), &KWindowSystem::activeWindowChanged,
-            d.operator->(),        &Resources::Private::activeWindowChanged);
+    if (windowEvents) {
+        windowEvents->setParent(this);
+    } else {
+        windowEvents = WindowEventSource::create(this);
+    }
+
+    MemoryUsage::addReporter(QStringLiteral("resources"), QStringLiteral("rateLimits"), this, [this] {
+        return d->rateLimiter.memoryUsage();
+    });
+
+    MemoryUsage::addReporter(QStringLiteral("resources"), QStringLiteral("queue"), this, [] {
+        QMutexLocker locker(&events_mutex);
+
+        const auto &entries = events.entries();
+
+        quint64 bytes = quint64(entries.capacity()) * (sizeof(Event) + sizeof(bool));
+        for (const auto &event: entries) {
+            bytes += MemoryUsage::bytes(event.application)
+                   + MemoryUsage::bytes(event.uri);
+        }
+
+        return MemoryUsage::Usage { quint64(entries.size()), bytes };
+    });
+
+    connect(windowEvents,   &WindowEventSource::windowRemoved,
+            d.operator->(), &Resources::Private::windowClosed);
+    connect(windowEvents,   &WindowEventSource::activeWindowChanged,
+            d.operator->(), &Resources::Private::activeWindowChanged);
 }
 
 Resources::~Resources()
 {
 }
 
+void Resources::processRecoveredEvents()
+{
+    d->pluginsReady = true;
+    d->scheduleProcessing();
+}
+
+void Resources::loadConfiguration()
+{
+    auto config = KSharedConfig::openConfig(QStringLiteral("kactivitymanagerd-pluginsrc"));
+    config->reparseConfiguration();
+
+    d->rateLimiter.load(config->group("RateLimits"));
+}
+
+bool Resources::isFeatureOperational(const QStringList &feature) const
+{
+    return !feature.isEmpty()
+           && (feature[0] == QLatin1String("queue")
+               || feature[0] == QLatin1String("rateLimits"));
+}
+
+QStringList Resources::listFeatures(const QStringList &feature) const
+{
+    if (feature.isEmpty() || feature[0].isEmpty()) {
+        return { QStringLiteral("queue/"), QStringLiteral("rateLimits/") };
+
+    } else if (feature[0] == QLatin1String("rateLimits")) {
+        return d->rateLimiter.applications();
+
+    } else if (feature[0] == QLatin1String("queue")) {
+        return {
+            QStringLiteral("length"),
+            QStringLiteral("highWaterMark"),
+            QStringLiteral("shedFocusEvents"),
+            QStringLiteral("shedAccessedEvents"),
+            QStringLiteral("droppedEvents")
+        };
+    }
+
+    return QStringList();
+}
+
+QDBusVariant Resources::featureValue(const QStringList &property) const
+{
+    if (property.size() >= 2 && property[0] == QLatin1String("rateLimits")) {
+        // The application names can contain slashes
+        const auto statistics = d->rateLimiter.statistics(
+            property.mid(1).join(QLatin1Char('/')));
+
+        return statistics.isEmpty() ? QDBusVariant(false) : QDBusVariant(statistics);
+    }
+
+    if (property.size() != 2 || property[0] != QLatin1String("queue")) {
+        return QDBusVariant(false);
+    }
+
+    const auto &name = property[1];
+
+    if (name == QLatin1String("length")) {
+        QMutexLocker locker(&events_mutex);
+        return QDBusVariant(events.size());
+
+    } else if (name == QLatin1String("highWaterMark")) {
+        return QDBusVariant(queueHighWaterMark.load());
+
+    } else if (name == QLatin1String("shedFocusEvents")) {
+        return QDBusVariant(qulonglong(shedFocusEvents));
+
+    } else if (name == QLatin1String("shedAccessedEvents")) {
+        return QDBusVariant(qulonglong(shedAccessedEvents));
+
+    } else if (name == QLatin1String("droppedEvents")) {
+        return QDBusVariant(qulonglong(droppedEvents));
+    }
+
+    return QDBusVariant(false);
+}
+
+void Resources::setFeatureValue(const QStringList &property, const QDBusVariant &value)
+{
+    if (property.size() == 2 && property[0] == QLatin1String("queue")
+            && property[1] == QLatin1String("highWaterMark")) {
+        queueHighWaterMark = value.variant().toInt();
+    }
+}
+
 void Resources::RegisterResourceEvent(const QString &application, uint _windowId,
                                       const QString &uri, uint event)
 {
@@ -292,11 +746,34 @@ void Resources::RegisterResourceEvent(const QString &application, uint _windowId
         return;
     }
 
+    d->record(application, _windowId, uri, event);
+
+    // The accesses and modifications above the rate limit of the
+    // application are registered later as one Accessed event per
+    // resource. The opened, closed and focus events are never dropped,
+    // the plugins need them to pair the starts and ends of the events
+    const bool limited = event == Event::Accessed || event == Event::Modified;
+
+    if (limited && !d->rateLimiter.acquire(application)) {
+        if (d->rateLimiter.coalesce(application, uri)) {
+            d->coalescingTimer->start(d->rateLimiter.coalescingWindow());
+        }
+        return;
+    }
+
     WId windowId = (WId)_windowId;
 
     d->addEvent(application, windowId, uri, (Event::Type)event);
 }
 
+void Resources::RegisterResourceEvents(const ResourceEventInfoList &events)
+{
+    for (const auto &event: events) {
+        RegisterResourceEvent(event.application, event.windowId,
+                              event.uri, event.event);
+    }
+}
+
 void Resources::RegisterResourceMimetype(const QString &uri, const QString &mimetype)
 {
     if (!mimetype.isEmpty()) {
@@ -31,6 +31,9 @@
 // Local
 #include "Module.h"
 #include "Event.h"
+#include <common/dbus/org.kde.ActivityManager.Resources.h>
+
+class WindowEventSource;
 
 
 /**
@@ -41,9 +44,35 @@ class Resources : public Module {
     Q_CLASSINFO("D-Bus Interface", "org.kde.ActivityManager.Resources")
 
 public:
-    explicit Resources(QObject *parent = nullptr);
+    /**
+     * Creates the resources module. If the window event source is not
+     * specified, WindowEventSource::create is used to create one.
+     * Resources takes the ownership of the source.
+     */
+    explicit Resources(QObject *parent = nullptr,
+                       WindowEventSource *windowEvents = nullptr);
     ~Resources() override;
 
+    /**
+     * Passes the events recovered from the journal on to the plugins.
+     * Needs to be called after the plugins are loaded, no events
+     * are processed before that.
+     */
+    void processRecoveredEvents();
+
+    /**
+     * Reads the rate limits of the applications
+     * from kactivitymanagerd-pluginsrc
+     */
+    void loadConfiguration();
+
+    // The state of the event queue is available as resources/queue/,
+    // the high-water mark for the load shedding can be changed
+    bool isFeatureOperational(const QStringList &feature) const override;
+    QStringList listFeatures(const QStringList &feature) const override;
+    QDBusVariant featureValue(const QStringList &property) const override;
+    void setFeatureValue(const QStringList &property, const QDBusVariant &value) override;
+
 public Q_SLOTS:
     /**
      * Registers a new event
@@ -57,6 +86,13 @@ public Q_SLOTS:
     void RegisterResourceEvent(const QString &application, uint windowId,
                                const QString &uri, uint event);
 
+    /**
+     * Registers a batch of events, the same as calling
+     * RegisterResourceEvent for each of them. The plugins should use this
+     * instead of invoking RegisterResourceEvent in a loop.
+     */
+    void RegisterResourceEvents(const ResourceEventInfoList &events);
+
     /**
      * Registers resource's mimetype.
      * Note that this will be forgotten when the resource in question is closed.
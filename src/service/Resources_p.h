@@ -25,12 +25,23 @@
 #include "Resources.h"
 
 // Qt
+#include <QDataStream>
+#include <QFile>
 #include <QString>
 #include <QList>
+#include <QTimer>
 #include <QWindow> // for WId
 
+// STL
+#include <memory>
+
+// Utils
+#include <utils/string_pool.h>
+
 // Local
 #include "resourcesadaptor.h"
+#include "EventJournal.h"
+#include "RateLimiter.h"
 
 
 class Resources::Private : public QThread {
@@ -54,6 +65,27 @@ public:
 
     QStringList resourcesLinkedToActivity(const QString &activity) const;
 
+    // Registers the summaries of the events that exceeded
+    // the rate limits of their applications
+    void addCoalescedEvents();
+
+    RateLimiter rateLimiter;
+    QTimer *coalescingTimer;
+
+    // Puts the events that were not stored before the last
+    // shutdown back into the queue
+    void recoverJournal();
+
+    // Writes the registered events into the trace file,
+    // see common/eventtrace.h
+    void startRecording(const QString &path);
+    void record(const QString &application, uint windowId,
+                const QString &uri, uint event);
+
+    // Starts processing the queued events, unless
+    // the plugins are not loaded yet
+    void scheduleProcessing();
+
 public Q_SLOTS:
     // Reacting to window manager signals
     void windowClosed(WId windowId);
@@ -69,9 +101,27 @@ private:
 
     Event lastEvent;
 
+    // The events are journalled before they are passed on to the
+    // plugins. It is shared with the commit markers which are
+    // processed in the main thread
+    std::shared_ptr<EventJournal> journal;
+    quint64 lastJournalledEvent;
+
+    // Set by processRecoveredEvents. Until then, the registered events
+    // (and the recovered ones) only wait in the queue. If they were
+    // processed before the plugins are loaded, nobody would store them,
+    // and the commit marker would remove them from the journal
+    bool pluginsReady;
+
+    std::unique_ptr<QFile> traceFile;
+    QDataStream traceStream;
+
     QHash<WId, WindowData> windows;
     WId focussedWindow;
 
+    // The application names and resources of the events
+    kamd::utils::string_pool strings;
+
     Resources *const q;
 };
 
@@ -0,0 +1,255 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Self
+#include "WindowEventSource.h"
+
+// Qt
+#include <QFile>
+#include <QTextStream>
+#include <QTimer>
+#include <QVector>
+
+// KDE
+#include <kwindowsystem.h>
+
+// Utils
+#include <utils/d_ptr_implementation.h>
+
+// Local
+#include "DebugResources.h"
+
+
+WindowEventSource::WindowEventSource(QObject *parent)
+    : QObject(parent)
+{
+}
+
+WindowEventSource::~WindowEventSource()
+{
+}
+
+WindowEventSource *WindowEventSource::create(QObject *parent)
+{
+    const auto source = qEnvironmentVariable("KAMD_WINDOW_EVENT_SOURCE");
+
+    if (source != QLatin1String("synthetic")
+            && !source.startsWith(QLatin1String("synthetic:"))) {
+        return new KWindowSystemEventSource(parent);
+    }
+
+    qCDebug(KAMD_LOG_RESOURCES) << "Using the synthetic window events:" << source;
+
+    auto result = new SyntheticWindowEventSource(parent);
+
+    const auto scriptPath = source.mid(sizeof("synthetic:") - 1);
+
+    if (!scriptPath.isEmpty() && result->loadScript(scriptPath)) {
+        QTimer::singleShot(0, result, &SyntheticWindowEventSource::play);
+    }
+
+    return result;
+}
+
+
+
+KWindowSystemEventSource::KWindowSystemEventSource(QObject *parent)
+    : WindowEventSource(parent)
+{
+    connect(KWindowSystem::self(), &KWindowSystem::windowRemoved,
+            this,                  &WindowEventSource::windowRemoved);
+    connect(KWindowSystem::self(), &KWindowSystem::activeWindowChanged,
+            this,                  &WindowEventSource::activeWindowChanged);
+}
+
+KWindowSystemEventSource::~KWindowSystemEventSource()
+{
+}
+
+
+
+class SyntheticWindowEventSource::Private {
+public:
+    struct Command {
+        enum Type {
+            Activate,
+            Remove,
+            Cycle,
+            Wait
+        };
+
+        Type type;
+        quint64 count;
+        WId first;
+        WId last;
+    };
+
+    QVector<Command> script;
+    int position = 0;
+};
+
+SyntheticWindowEventSource::SyntheticWindowEventSource(QObject *parent)
+    : WindowEventSource(parent)
+{
+}
+
+SyntheticWindowEventSource::~SyntheticWindowEventSource()
+{
+}
+
+void SyntheticWindowEventSource::activateWindow(WId windowId)
+{
+    emit activeWindowChanged(windowId);
+}
+
+void SyntheticWindowEventSource::removeWindow(WId windowId)
+{
+    emit windowRemoved(windowId);
+}
+
+void SyntheticWindowEventSource::cycleWindows(quint64 count, WId first, WId last)
+{
+    if (last < first) {
+        std::swap(first, last);
+    }
+
+    // Iterating on the offsets instead of the ids, the loop would never
+    // end if the last id was the largest one. The number of windows
+    // is offsets + 1, which can overflow, so it is not used as the bound
+    const quint64 offsets = last - first;
+
+    for (quint64 i = 0; i < count; ++i) {
+        for (quint64 offset = 0; ; ++offset) {
+            emit activeWindowChanged(WId(first + offset));
+
+            if (offset == offsets) {
+                break;
+            }
+        }
+    }
+}
+
+bool SyntheticWindowEventSource::loadScript(const QString &path)
+{
+    using Command = Private::Command;
+
+    QFile file(path);
+
+    if (!file.open(QIODevice::ReadOnly | QIODevice::Text)) {
+        qCWarning(KAMD_LOG_RESOURCES) << "Can not open the window events script" << path;
+        return false;
+    }
+
+    QVector<Command> script;
+    QTextStream in(&file);
+    int lineNumber = 0;
+
+    while (!in.atEnd()) {
+        const auto line = in.readLine().trimmed();
+        ++lineNumber;
+
+        if (line.isEmpty() || line.startsWith(QLatin1Char('#'))) {
+            continue;
+        }
+
+        const auto words = line.splitRef(QLatin1Char(' '), QString::SkipEmptyParts);
+        const auto &name = words[0];
+
+        bool ok = true;
+        auto number = [&] (int index) -> quint64 {
+            if (index >= words.size()) {
+                ok = false;
+                return 0;
+            }
+            bool numberOk = false;
+            const auto result = words[index].toULongLong(&numberOk);
+            ok = ok && numberOk;
+            return result;
+        };
+
+        Command command { Command::Wait, 1, 0, 0 };
+
+        if (name == QLatin1String("activate") && words.size() == 2) {
+            command.type = Command::Activate;
+            command.first = (WId)number(1);
+
+        } else if (name == QLatin1String("remove") && words.size() == 2) {
+            command.type = Command::Remove;
+            command.first = (WId)number(1);
+
+        } else if (name == QLatin1String("cycle") && words.size() == 4) {
+            command.type = Command::Cycle;
+            command.count = number(1);
+            command.first = (WId)number(2);
+            command.last = (WId)number(3);
+
+        } else if (name == QLatin1String("wait") && words.size() == 2) {
+            command.type = Command::Wait;
+            command.count = number(1);
+
+        } else {
+            ok = false;
+        }
+
+        if (!ok) {
+            qCWarning(KAMD_LOG_RESOURCES) << "Invalid command in the window events script"
+                                          << path << "line" << lineNumber << line;
+            return false;
+        }
+
+        script << command;
+    }
+
+    d->script = script;
+    d->position = 0;
+
+    return true;
+}
+
+void SyntheticWindowEventSource::play()
+{
+    using Command = Private::Command;
+
+    while (d->position < d->script.size()) {
+        const auto command = d->script[d->position++];
+
+        switch (command.type) {
+            case Command::Activate:
+                activateWindow(command.first);
+                break;
+
+            case Command::Remove:
+                removeWindow(command.first);
+                break;
+
+            case Command::Cycle:
+                cycleWindows(command.count, command.first, command.last);
+                break;
+
+            case Command::Wait:
+                QTimer::singleShot((int)command.count, this,
+                                   &SyntheticWindowEventSource::play);
+                return;
+        }
+    }
+
+    d->position = 0;
+    emit finished();
+}
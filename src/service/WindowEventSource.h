@@ -0,0 +1,117 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef WINDOW_EVENT_SOURCE_H
+#define WINDOW_EVENT_SOURCE_H
+
+// Qt
+#include <QObject>
+#include <QString>
+#include <QWindow> // for WId
+
+// Utils
+#include <utils/d_ptr.h>
+
+/**
+ * The source of the window events that Resources needs in order to
+ * keep track of the focussed window and of the windows that are closed.
+ *
+ * Normally, these come from KWindowSystem, but Resources can also be
+ * driven by a synthetic source which does not need an X or a Wayland
+ * session (see KAMD_WINDOW_EVENT_SOURCE).
+ */
+class WindowEventSource: public QObject {
+    Q_OBJECT
+
+public:
+    explicit WindowEventSource(QObject *parent = nullptr);
+    ~WindowEventSource() override;
+
+    /**
+     * Creates the source specified by the KAMD_WINDOW_EVENT_SOURCE
+     * environment variable:
+     *  - "synthetic" creates a SyntheticWindowEventSource,
+     *  - "synthetic:<path>" creates it and plays the script from the file,
+     *  - anything else creates a KWindowSystemEventSource.
+     */
+    static WindowEventSource *create(QObject *parent = nullptr);
+
+Q_SIGNALS:
+    void windowRemoved(WId windowId);
+    void activeWindowChanged(WId windowId);
+};
+
+/**
+ * Forwards the window events reported by KWindowSystem
+ */
+class KWindowSystemEventSource: public WindowEventSource {
+    Q_OBJECT
+
+public:
+    explicit KWindowSystemEventSource(QObject *parent = nullptr);
+    ~KWindowSystemEventSource() override;
+};
+
+/**
+ * Window events that are generated on request.
+ *
+ * The events are emitted synchronously, so that the window bookkeeping
+ * in Resources can be driven as fast as it is able to process them.
+ *
+ * The script is a text file with one command per line:
+ *  - activate <window>               the window gets the focus
+ *  - remove <window>                 the window is closed
+ *  - cycle <count> <first> <last>    activates the windows from first
+ *                                    to last in turn, count times
+ *  - wait <milliseconds>             continues the script later
+ *
+ * The empty lines and the lines starting with # are ignored.
+ */
+class SyntheticWindowEventSource: public WindowEventSource {
+    Q_OBJECT
+
+public:
+    explicit SyntheticWindowEventSource(QObject *parent = nullptr);
+    ~SyntheticWindowEventSource() override;
+
+    void activateWindow(WId windowId);
+    void removeWindow(WId windowId);
+    void cycleWindows(quint64 count, WId first, WId last);
+
+    /**
+     * Loads the script from the specified file
+     * @returns false if the file can not be read or the script is invalid
+     */
+    bool loadScript(const QString &path);
+
+    /**
+     * Executes the loaded script. The commands after a wait are
+     * executed from the event loop
+     */
+    void play();
+
+Q_SIGNALS:
+    void finished();
+
+private:
+    D_PTR;
+};
+
+#endif // WINDOW_EVENT_SOURCE_H
@@ -47,18 +47,30 @@ void EventSpyPlugin::directoryUpdated(const QString &dir)
     Q_UNUSED(dir);
     const auto newDocuments = KRecentDocument::recentDocuments();
 
-    // Processing the new arrivals
+    // Processing the new arrivals, they are sent to the resources
+    // module in one go instead of an invocation per document
+    ResourceEventInfoList events;
+
     for (const auto& document: newDocuments) {
         QFileInfo fileInfo(document);
         if (fileInfo.lastModified() > m_lastUpdate) {
-            addDocument(document);
+            events << documentEvent(document);
         }
     }
 
     m_lastUpdate = QDateTime::currentDateTime();
+
+    if (events.isEmpty()) {
+        return;
+    }
+
+    Plugin::invoke<Qt::QueuedConnection>(
+        m_resources, "RegisterResourceEvents",
+                Q_ARG(ResourceEventInfoList, events)
+        );
 }
 
-void EventSpyPlugin::addDocument(const QString &document)
+ResourceEventInfo EventSpyPlugin::documentEvent(const QString &document) const
 {
     const KDesktopFile desktopFile(document);
     const KConfigGroup desktopGroup(&desktopFile, "Desktop Entry");
@@ -68,12 +80,11 @@ void EventSpyPlugin::addDocument(const QString &document)
     const QString application
         = desktopGroup.readEntry("X-KDE-LastOpenedWith", QString());
 
-    Plugin::invoke<Qt::QueuedConnection>(
-        m_resources, "RegisterResourceEvent",
-                Q_ARG(QString, application), // Application
-                Q_ARG(uint, 0),              // Window ID
-                Q_ARG(QString, url),         // URI
-                Q_ARG(uint, 0)               // Event Activities::Accessed
+    return ResourceEventInfo(
+                application, // Application
+                0,           // Window ID
+                url,         // URI
+                0            // Event Activities::Accessed
         );
 }
 
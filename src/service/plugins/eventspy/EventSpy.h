@@ -23,6 +23,8 @@
 
 #include <QStringList>
 
+#include <common/dbus/org.kde.ActivityManager.Resources.h>
+
 class KDirWatch;
 
 class EventSpyPlugin : public Plugin {
@@ -36,9 +38,10 @@ public:
 
 private Q_SLOTS:
     void directoryUpdated(const QString &dir);
-    void addDocument(const QString &document);
 
 private:
+    ResourceEventInfo documentEvent(const QString &document) const;
+
     QObject *m_resources;
     std::unique_ptr<KDirWatch> m_dirWatcher;
     QDateTime m_lastUpdate;
@@ -23,6 +23,8 @@
 
 #include <QStringList>
 
+#include <common/dbus/org.kde.ActivityManager.Resources.h>
+
 class KDirWatch;
 
 class GtkEventSpyPlugin : public Plugin
@@ -38,9 +40,11 @@ public:
 
 private Q_SLOTS:
     void fileUpdated(const QString &file);
-    void addDocument(const QUrl &url, const QString &application, const QString &mimetype);
 
 private:
+    void addDocument(ResourceEventInfoList &events, const QUrl &url,
+                     const QString &application);
+
     QObject *m_resources;
     std::unique_ptr<KDirWatch> m_dirWatcher;
     QDateTime m_lastUpdate;
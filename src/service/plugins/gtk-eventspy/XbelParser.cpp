@@ -0,0 +1,181 @@
+/*
+ *   Copyright (C) 2019 Méven Car (meven.car@kdemail.net)
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "XbelParser.h"
+
+#include <QIODevice>
+#include <QXmlSimpleReader>
+#include <QXmlInputSource>
+
+#include <KServiceTypeTrader>
+
+QString Bookmark::latestApplication() const
+{
+    BookmarkApplication current = applications.first();
+    for (const BookmarkApplication &app : applications) {
+        if (app.modified > current.modified) {
+            current = app;
+        }
+    }
+    return current.name;
+}
+
+bool Bookmark::changedSince(const QDateTime &time) const
+{
+    return added > time || modified > time || visited > time;
+}
+
+namespace {
+
+class BookmarkHandler : public QXmlDefaultHandler
+{
+public:
+    explicit BookmarkHandler(const XbelParser::ApplicationResolver &resolver);
+
+    bool startElement(const QString &namespaceURI, const QString &localName, const QString &qName,
+                      const QXmlAttributes &attributes) override;
+    bool endElement(const QString &namespaceURI, const QString &localName,
+                    const QString &qName) override;
+
+    QList<Bookmark> bookmarks() const;
+private:
+    const XbelParser::ApplicationResolver &resolver;
+    QList<Bookmark> marks;
+    Bookmark current;
+};
+
+BookmarkHandler::BookmarkHandler(const XbelParser::ApplicationResolver &resolver)
+    : resolver(resolver)
+{
+}
+
+QList<Bookmark> BookmarkHandler::bookmarks() const
+{
+    return marks;
+}
+
+bool BookmarkHandler::startElement(const QString & /*namespaceURI*/, const QString & /*localName*/,
+                                   const QString &qName, const QXmlAttributes &attributes)
+{
+    // new bookmark
+    if (qName == QStringLiteral("bookmark")) {
+        current = Bookmark();
+        current.href = QUrl(attributes.value("href"));
+        QString added = attributes.value("added");
+        QString modified = attributes.value("modified");
+        QString visited = attributes.value("visited");
+        current.added = QDateTime::fromString(added, Qt::ISODate);
+        current.modified = QDateTime::fromString(modified, Qt::ISODate);
+        current.visited = QDateTime::fromString(visited, Qt::ISODate);
+
+        // application for the current bookmark
+    } else if (qName == QStringLiteral("bookmark:application")) {
+        BookmarkApplication app;
+
+        QString exec = attributes.value("exec");
+
+        if (exec.startsWith(QLatin1Char('\'')) && exec.endsWith(QLatin1Char('\''))) {
+            // remove "'" characters wrapping the command
+            exec = exec.mid(1, exec.size() -2);
+        }
+
+        app.name = resolver(exec);
+        app.modified = QDateTime::fromString(attributes.value("modified"), Qt::ISODate);
+
+        current.applications.append(app);
+    } else if (qName == QStringLiteral("mime:mime-type")) {
+        current.mimetype = attributes.value("type");
+    }
+    return true;
+}
+
+bool BookmarkHandler::endElement(const QString &namespaceURI, const QString &localName,
+                                 const QString &qName)
+{
+    Q_UNUSED(namespaceURI);
+    Q_UNUSED(localName);
+
+    if (qName == QStringLiteral("bookmark")) {
+        // keep track of the finished parsed bookmark
+        marks << current;
+    }
+
+    return true;
+}
+
+} // namespace
+
+XbelParser::XbelParser(ApplicationResolver resolver)
+    : m_resolver(resolver)
+{
+}
+
+bool XbelParser::parse(QIODevice *device)
+{
+    BookmarkHandler bookmarkHandler(m_resolver);
+
+    QXmlSimpleReader reader;
+    reader.setContentHandler(&bookmarkHandler);
+    reader.setErrorHandler(&bookmarkHandler);
+    QXmlInputSource source(device);
+
+    if (!reader.parse(source)) {
+        m_bookmarks.clear();
+        m_errorString = bookmarkHandler.errorString();
+        return false;
+    }
+
+    m_bookmarks = bookmarkHandler.bookmarks();
+    m_errorString.clear();
+    return true;
+}
+
+QList<Bookmark> XbelParser::bookmarks() const
+{
+    return m_bookmarks;
+}
+
+QString XbelParser::errorString() const
+{
+    return m_errorString;
+}
+
+QString XbelParser::resolveApplication(const QString &exec)
+{
+    // Search for applications which are executable and case-insensitively match the search term
+    // See https://techbase.kde.org/Development/Tutorials/Services/Traders#The_KTrader_Query_Language
+    const auto query = QString("exist Exec and Exec ~~ '%1'").arg(exec);
+    const KService::List services
+        = KServiceTypeTrader::self()->query(QStringLiteral("Application"), query);
+
+    if (!services.isEmpty()) {
+        // use the first item matching
+        const auto &service = services.first();
+        return service->desktopEntryName();
+    }
+
+    return applicationFromExec(exec);
+}
+
+QString XbelParser::applicationFromExec(const QString &exec)
+{
+    // when no services are found, sanitize a little the exec
+    // remove space and any character after
+    const int spaceIndex = exec.indexOf(" ");
+    return spaceIndex != -1 ? exec.mid(0, spaceIndex) : exec;
+}
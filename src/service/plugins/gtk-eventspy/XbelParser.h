@@ -0,0 +1,85 @@
+/*
+ *   Copyright (C) 2019 Méven Car (meven.car@kdemail.net)
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License, or (at your option) any later version.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PLUGINS_GTK_EVENT_SPY_XBEL_PARSER_H
+#define PLUGINS_GTK_EVENT_SPY_XBEL_PARSER_H
+
+#include <QDateTime>
+#include <QList>
+#include <QString>
+#include <QUrl>
+
+#include <functional>
+
+class QIODevice;
+
+struct BookmarkApplication {
+    QString name;
+    QDateTime modified;
+};
+
+class Bookmark
+{
+public:
+    QUrl href;
+    QDateTime added;
+    QDateTime modified;
+    QDateTime visited;
+    QString mimetype;
+    QList<BookmarkApplication> applications;
+
+    QString latestApplication() const;
+
+    bool changedSince(const QDateTime &time) const;
+};
+
+/**
+ * Parser for the recently-used.xbel file written by GTK
+ */
+class XbelParser
+{
+public:
+    // Returns the name of the application for the exec attribute
+    // of the bookmark:application element
+    typedef std::function<QString(const QString &exec)> ApplicationResolver;
+
+    explicit XbelParser(ApplicationResolver resolver = &XbelParser::resolveApplication);
+
+    bool parse(QIODevice *device);
+
+    QList<Bookmark> bookmarks() const;
+    QString errorString() const;
+
+    /**
+     * Finds the application with the matching Exec through KService,
+     * if there is none, the command without the arguments is returned
+     */
+    static QString resolveApplication(const QString &exec);
+
+    /**
+     * Returns the command without the arguments
+     */
+    static QString applicationFromExec(const QString &exec);
+
+private:
+    ApplicationResolver m_resolver;
+    QList<Bookmark> m_bookmarks;
+    QString m_errorString;
+};
+
+#endif // PLUGINS_GTK_EVENT_SPY_XBEL_PARSER_H
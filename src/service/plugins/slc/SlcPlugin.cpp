@@ -23,6 +23,7 @@
 
 // Local
 #include "slcadaptor.h"
+#include "../../MemoryUsage.h"
 
 KAMD_EXPORT_PLUGIN(slcplugin, SlcPlugin, "kactivitymanagerd-plugin-slc.json")
 
@@ -115,6 +116,18 @@ bool SlcPlugin::init(QHash<QString, QObject *> &modules)
             this, SLOT(registeredResourceTitle(QString, QString)),
             Qt::QueuedConnection);
 
+    MemoryUsage::addReporter(QStringLiteral("slc"), QStringLiteral("resources"), this, [this] {
+        quint64 bytes = MemoryUsage::bytes(m_resources);
+
+        for (auto it = m_resources.cbegin(); it != m_resources.cend(); ++it) {
+            bytes += MemoryUsage::bytes(it.key())
+                   + MemoryUsage::bytes(it->title)
+                   + MemoryUsage::bytes(it->mimetype);
+        }
+
+        return MemoryUsage::Usage { quint64(m_resources.size()), bytes };
+    });
+
     return true;
 }
 
@@ -23,7 +23,10 @@
 
 // Qt
 #include <QDir>
+#include <QFile>
+#include <QTextStream>
 #include <QSqlDatabase>
+#include <QSqlDriver>
 #include <QSqlError>
 #include <QSqlQuery>
 #include <QStandardPaths>
@@ -31,15 +34,28 @@
 
 // KDE
 #include <kdelibs4migration.h>
+#include <KConfigGroup>
+#include <KSharedConfig>
 
 // Utils
 #include <utils/d_ptr_implementation.h>
 #include <utils/qsqlquery_iterator.h>
 
 // System
+#include <atomic>
 #include <cmath>
 #include <memory>
 
+#include <fcntl.h>
+#include <sys/ioctl.h>
+#include <unistd.h>
+#ifdef Q_OS_LINUX
+#include <linux/fs.h>
+#endif
+
+// SQLite
+#include <sqlite3.h>
+
 // Local
 #include "DebugResources.h"
 #include "Utils.h"
@@ -53,14 +69,7 @@ public:
 
 };
 
-Common::Database::Ptr resourcesDatabase()
-{
-    static ResourcesDatabaseInitializer instance;
-    return instance.d->database;
-}
-
-void ResourcesDatabaseInitializer::initDatabase(bool retryOnFail)
-{
+namespace {
     //
     // There are three situations we want to handle:
     // 1. The database can not be opened at all.
@@ -77,102 +86,303 @@ void ResourcesDatabaseInitializer::initDatabase(bool retryOnFail)
     //
     // 1. `resources` - the current database files
     // 2. `resources-test-backup` - at each KAMD start,
-    //    we copy the current database files here.
+    //    we make a backup of the current database here.
     //    If an error appears during execution, the files
     //    will be removed and the error will be added to
     //    the log file `resources/errors.log`
     // 3. `resources-working-backup` - on each KAMD start,
     //    if there are files in `resources-test-backup`
     //    (meaning no error appeared at runtime), they
-    //    will be copied to `resources-working-backup`.
+    //    will be moved to `resources-working-backup`.
     //
     // This means that the `working` backup will be a bit
     // older, but it will be the last database that produced
     // no errors at runtime.
     //
+    // The test backup is not created before the database is
+    // opened. It is made by ResourcesDatabaseBackup in the
+    // background, using the SQLite online backup API.
+    //
 
+    QString databaseDirectoryPath()
+    {
+        return QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
+               + QStringLiteral("/kactivitymanagerd/resources/");
+    }
 
-    const QString databaseDirectoryPath
-        = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
-          + QStringLiteral("/kactivitymanagerd/resources/");
-
-    const QString databaseTestBackupDirectoryPath
-        = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
-          + QStringLiteral("/kactivitymanagerd/resources/test-backup/");
+    QString databaseTestBackupDirectoryPath()
+    {
+        return databaseDirectoryPath() + QStringLiteral("test-backup/");
+    }
 
-    const QString databaseWorkingBackupDirectoryPath
-        = QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
-          + QStringLiteral("/kactivitymanagerd/resources/working-backup/");
+    QString databaseWorkingBackupDirectoryPath()
+    {
+        return databaseDirectoryPath() + QStringLiteral("working-backup/");
+    }
 
+    // The online backup produces a single self-contained file,
+    // but older versions copied the journal files as well
     const QStringList databaseFiles{"database", "database-wal", "database-shm"};
 
+    // Set when a runtime error was reported, the test backup
+    // must not be created from a database that produced errors
+    std::atomic<bool> runtimeErrorReported(false);
+
+    bool removeDatabaseFiles(const QDir &dir)
     {
-        QDir dir;
-        dir.mkpath(databaseDirectoryPath);
-        dir.mkpath(databaseTestBackupDirectoryPath);
-        dir.mkpath(databaseWorkingBackupDirectoryPath);
+        return std::all_of(databaseFiles.cbegin(), databaseFiles.cend(),
+                           [&] (const QString &fileName) {
+                               const auto filePath = dir.filePath(fileName);
+                               return !QFile::exists(filePath) || QFile::remove(filePath);
+                           });
+    }
 
-        if (!dir.exists(databaseDirectoryPath) ||
-            !dir.exists(databaseTestBackupDirectoryPath) ||
-            !dir.exists(databaseWorkingBackupDirectoryPath)) {
-            qCWarning(KAMD_LOG_RESOURCES) << "Database directory can not be created!";
-            return;
-        }
+    bool databaseFilesExistIn(const QDir &dir)
+    {
+        return dir.exists() && QFile::exists(dir.filePath(databaseFiles.first()));
     }
 
-    const QDir databaseDirectory(databaseDirectoryPath);
-    const QDir databaseTestBackupDirectory(databaseTestBackupDirectoryPath);
-    const QDir databaseWorkingBackupDirectory(databaseWorkingBackupDirectoryPath);
+    // Makes a copy of the file, sharing the data blocks with
+    // the original on file systems that support reflinks
+    bool cloneFile(const QString &fromFilePath, const QString &toFilePath)
+    {
+#ifdef FICLONE
+        const int source = ::open(QFile::encodeName(fromFilePath).constData(),
+                                  O_RDONLY | O_CLOEXEC);
+
+        if (source >= 0) {
+            const int target = ::open(QFile::encodeName(toFilePath).constData(),
+                                      O_WRONLY | O_CREAT | O_TRUNC | O_CLOEXEC,
+                                      0600);
+            bool cloned = false;
+
+            if (target >= 0) {
+                cloned = ::ioctl(target, FICLONE, source) == 0;
+                ::close(target);
+            }
 
-    auto removeDatabaseFiles = [&] (const QDir &dir) {
-        return std::all_of(databaseFiles.begin(), databaseFiles.cend(),
-                           [&] (const QString &fileName) {
-                               const auto filePath = dir.filePath(fileName);
-                               return !QFile::exists(filePath) || QFile::remove(filePath);
-                            });
-    };
+            ::close(source);
+
+            if (cloned) {
+                return true;
+            }
+
+            QFile::remove(toFilePath);
+        }
+#endif
 
-    auto copyDatabaseFiles = [&] (const QDir &fromDir, const QDir& toDir) {
+        return QFile::copy(fromFilePath, toFilePath);
+    }
+
+    bool copyDatabaseFiles(const QDir &fromDir, const QDir &toDir)
+    {
         return removeDatabaseFiles(toDir) &&
-               std::all_of(databaseFiles.begin(), databaseFiles.cend(),
+               std::all_of(databaseFiles.cbegin(), databaseFiles.cend(),
                            [&] (const QString &fileName) {
                                const auto fromFilePath = fromDir.filePath(fileName);
                                const auto toFilePath = toDir.filePath(fileName);
-                               return QFile::copy(fromFilePath, toFilePath);
-                            });
-    };
+                               return !QFile::exists(fromFilePath)
+                                   || cloneFile(fromFilePath, toFilePath);
+                           });
+    }
 
-    auto databaseFilesExistIn = [&] (const QDir &dir) {
-        return dir.exists() &&
-               std::all_of(databaseFiles.begin(), databaseFiles.cend(),
+    bool moveDatabaseFiles(const QDir &fromDir, const QDir &toDir)
+    {
+        return removeDatabaseFiles(toDir) &&
+               std::all_of(databaseFiles.cbegin(), databaseFiles.cend(),
                            [&] (const QString &fileName) {
-                               const auto filePath = dir.filePath(fileName);
-                               return QFile::exists(filePath);
+                               const auto fromFilePath = fromDir.filePath(fileName);
+                               const auto toFilePath = toDir.filePath(fileName);
+                               return !QFile::exists(fromFilePath)
+                                   || QFile::rename(fromFilePath, toFilePath);
                            });
+    }
+
+    sqlite3 *sqliteHandleOf(const QVariant &handle)
+    {
+        return handle.isValid() && qstrcmp(handle.typeName(), "sqlite3*") == 0
+                   ? *static_cast<sqlite3 *const *>(handle.constData())
+                   : nullptr;
+    }
+
+    // Set by the auto extension below for the connections opened
+    // by the SQLite library the plugin is linked to
+    thread_local sqlite3 *lastLinkedConnection = nullptr;
+
+    int rememberLinkedConnection(sqlite3 *connection, char **errorMessage,
+                                 const sqlite3_api_routines *api)
+    {
+        Q_UNUSED(errorMessage);
+        Q_UNUSED(api);
+
+        lastLinkedConnection = connection;
+        return SQLITE_OK;
+    }
+
+    // If Qt was built with its bundled SQLite, the driver has its own
+    // copy of the library. The auto extensions are registered per copy,
+    // so the one registered here is called for the connections the
+    // driver opens only if they share the library with the plugin.
+    bool driverUsesLinkedSqlite()
+    {
+        static const bool result = [] {
+            const auto connectionName = QStringLiteral("kactivities_sqlite_probe");
+            bool sameLibrary = false;
+
+            sqlite3_auto_extension(
+                reinterpret_cast<void (*)()>(&rememberLinkedConnection));
+            lastLinkedConnection = nullptr;
+
+            {
+                auto probe = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"),
+                                                       connectionName);
+                probe.setDatabaseName(QStringLiteral(":memory:"));
+
+                if (probe.open()) {
+                    sameLibrary = lastLinkedConnection != nullptr
+                        && sqliteHandleOf(probe.driver()->handle()) == lastLinkedConnection;
+                    probe.close();
+                }
+            }
+
+            sqlite3_cancel_auto_extension(
+                reinterpret_cast<void (*)()>(&rememberLinkedConnection));
+            QSqlDatabase::removeDatabase(connectionName);
+
+            if (!sameLibrary) {
+                qCWarning(KAMD_LOG_RESOURCES) << "The Qt SQLite driver does not use the "
+                                                 "system SQLite library, the features that "
+                                                 "need the SQLite API are disabled";
+            }
+
+            return sameLibrary;
+        }();
+
+        return result;
+    }
+
+    // The SQLite tuning, read from the [Database] group of kactivitymanagerdrc.
+    // Nothing is set unless it is configured, SQLite's defaults are used
+    // otherwise. The kactivitymanagerd_resources_benchmark --pragmas
+    // option measures the effect of the values on the statements.
+    // The page_size only affects the new databases, and the existing ones
+    // when they are vacuumed. The soft heap limit is process-wide in SQLite,
+    // it applies to all the connections together.
+    QStringList configuredPragmas()
+    {
+        const KConfigGroup config(
+                KSharedConfig::openConfig(QStringLiteral("kactivitymanagerdrc")),
+                QStringLiteral("Database"));
+
+        const int pageSize       = config.readEntry("page-size", 0);
+        const int cacheSize      = config.readEntry("cache-size", 0);
+        const qint64 mmapSize    = config.readEntry("mmap-size", qint64(-1));
+        const qint64 heapLimit   = config.readEntry("soft-heap-limit", qint64(-1));
+        const QString tempStore  = config.readEntry("temp-store", QString());
+
+        QStringList result;
+
+        // SQLite ignores the page sizes that are not a power of two
+        // between 512 and 65536
+        if (pageSize >= 512 && pageSize <= 65536 && (pageSize & (pageSize - 1)) == 0) {
+            result << QStringLiteral("page_size = %1").arg(pageSize);
+        }
+
+        // The cache-size is in KiB, which is what the negative
+        // cache_size means to SQLite
+        if (cacheSize > 0) {
+            result << QStringLiteral("cache_size = -%1").arg(cacheSize);
+        }
+
+        if (mmapSize >= 0) {
+            result << QStringLiteral("mmap_size = %1").arg(mmapSize);
+        }
+
+        if (heapLimit >= 0) {
+            result << QStringLiteral("soft_heap_limit = %1").arg(heapLimit);
+        }
+
+        if (tempStore == QLatin1String("default")
+                || tempStore == QLatin1String("file")
+                || tempStore == QLatin1String("memory")) {
+            result << QStringLiteral("temp_store = %1").arg(tempStore.toUpper());
+        }
+
+        return result;
+    }
+} // namespace
+
+void appendToDatabaseLog(const QString &message)
+{
+    const QString errorLog =
+        databaseDirectoryPath() + QStringLiteral("errors.log");
+    QFile file(errorLog);
+    if (file.open(QIODevice::Append)) {
+        QTextStream out(&file);
+        out << QDateTime::currentDateTime().toString(Qt::ISODate) << " " << message << "\n";
+    } else {
+        qCWarning(KAMD_LOG_RESOURCES) << QDateTime::currentDateTime().toString(Qt::ISODate) << " " << message;
+    }
+}
+
+QStringList databaseTuningPragmas()
+{
+    return {
+        QStringLiteral("page_size"),
+        QStringLiteral("cache_size"),
+        QStringLiteral("mmap_size"),
+        QStringLiteral("temp_store"),
+        QStringLiteral("soft_heap_limit")
     };
+}
+
+sqlite3 *sqliteHandle(const Common::Database &database)
+{
+    return driverUsesLinkedSqlite() ? sqliteHandleOf(database.driverHandle())
+                                    : nullptr;
+}
+
+Common::Database::Ptr resourcesDatabase()
+{
+    static ResourcesDatabaseInitializer instance;
+    return instance.d->database;
+}
+
+void ResourcesDatabaseInitializer::initDatabase(bool retryOnFail)
+{
+    {
+        QDir dir;
+        dir.mkpath(databaseDirectoryPath());
+        dir.mkpath(databaseTestBackupDirectoryPath());
+        dir.mkpath(databaseWorkingBackupDirectoryPath());
+
+        if (!dir.exists(databaseDirectoryPath()) ||
+            !dir.exists(databaseTestBackupDirectoryPath()) ||
+            !dir.exists(databaseWorkingBackupDirectoryPath())) {
+            qCWarning(KAMD_LOG_RESOURCES) << "Database directory can not be created!";
+            return;
+        }
+    }
+
+    const QDir databaseDirectory(databaseDirectoryPath());
+    const QDir databaseTestBackupDirectory(databaseTestBackupDirectoryPath());
+    const QDir databaseWorkingBackupDirectory(databaseWorkingBackupDirectoryPath());
 
     // First, let's move the files from `resources-test-backup` to
-    // `resources-working-backup` (if they exist)
+    // `resources-working-backup` (if they exist). They are on the
+    // same file system, so there is no need to copy anything.
     if (databaseFilesExistIn(databaseTestBackupDirectory)) {
         qCDebug(KAMD_LOG_RESOURCES) << "Marking the test backup as working...";
-        if (copyDatabaseFiles(databaseTestBackupDirectory, databaseWorkingBackupDirectory)) {
-            removeDatabaseFiles(databaseTestBackupDirectory);
-        } else {
+        if (!moveDatabaseFiles(databaseTestBackupDirectory, databaseWorkingBackupDirectory)) {
             qCWarning(KAMD_LOG_RESOURCES) << "Marking the test backup as working failed!";
             removeDatabaseFiles(databaseWorkingBackupDirectory);
         }
-    }
-
-    // Next, copy the current database files to `resources-test-backup`
-    if (databaseFilesExistIn(databaseDirectory)) {
-        qCDebug(KAMD_LOG_RESOURCES) << "Creating the backup of the current database...";
-        if (!copyDatabaseFiles(databaseDirectory, databaseTestBackupDirectory)) {
-            qCWarning(KAMD_LOG_RESOURCES) << "Creating the backup of the current database failed!";
-            removeDatabaseFiles(databaseTestBackupDirectory);
-        }
+        removeDatabaseFiles(databaseTestBackupDirectory);
     }
 
     // Now we can try to open the database
+    Common::Database::setConnectionPragmas(configuredPragmas());
+
     d->database = Common::Database::instance(
             Common::Database::ResourcesDatabase,
             Common::Database::ReadWrite);
@@ -180,28 +390,16 @@ void ResourcesDatabaseInitializer::initDatabase(bool retryOnFail)
     if (d->database) {
         qCDebug(KAMD_LOG_RESOURCES) << "Database opened successfully";
         QObject::connect(d->database.get(), &Common::Database::error,
-                         [=] (const QSqlError &error) {
-                             const QString errorLog =
-                                 QStandardPaths::writableLocation(QStandardPaths::GenericDataLocation)
-                                     + QStringLiteral("/kactivitymanagerd/resources/errors.log");
-                             QFile file(errorLog);
-                             if (file.open(QIODevice::Append)) {
-                                 QTextStream out(&file);
-                                 out << QDateTime::currentDateTime().toString(Qt::ISODate) << " error: " << error.text() << "\n";
-                             } else {
-                                 qCWarning(KAMD_LOG_RESOURCES) << QDateTime::currentDateTime().toString(Qt::ISODate) << " error: " << error.text();
-                             }
-
-                             removeDatabaseFiles(databaseTestBackupDirectory);
+                         [] (const QSqlError &error) {
+                             appendToDatabaseLog(QStringLiteral("error: ") + error.text());
+
+                             runtimeErrorReported = true;
+                             removeDatabaseFiles(QDir(databaseTestBackupDirectoryPath()));
                          });
         Common::ResourcesDatabaseSchema::initSchema(*d->database);
 
     } else {
-        // The current database can not be opened, delete the
-        // backup we just created
-        removeDatabaseFiles(databaseTestBackupDirectory);
-
-        if (databaseFilesExistIn(databaseWorkingBackupDirectoryPath)) {
+        if (databaseFilesExistIn(databaseWorkingBackupDirectory)) {
             qCWarning(KAMD_LOG_RESOURCES) << "The database seems to be corrupted, trying to load the latest working version";
 
             const auto success = copyDatabaseFiles(databaseWorkingBackupDirectory, databaseDirectory);
@@ -227,3 +425,108 @@ ResourcesDatabaseInitializer::~ResourcesDatabaseInitializer()
 {
 }
 
+
+ResourcesDatabaseBackup::ResourcesDatabaseBackup(QObject *parent)
+    : QThread(parent)
+{
+}
+
+ResourcesDatabaseBackup::~ResourcesDatabaseBackup()
+{
+    requestInterruption();
+    wait();
+}
+
+void ResourcesDatabaseBackup::run()
+{
+    // Number of pages copied in one step, and the pause between
+    // the steps which gives the writers a chance to get the lock
+    const int pagesPerStep = 256;
+    const int stepDelay = 25;
+
+    // If the database is being written to while we are copying it,
+    // SQLite restarts the backup. Copying the rest in one step would
+    // keep the writers blocked until it is done, so if the backup gets
+    // restarted too many times, we are trying again a bit later.
+    const int maxRestarts = 3;
+    const int maxAttempts = 5;
+    const int retryDelay = 60 * 1000;
+
+    const QDir testBackupDirectory(databaseTestBackupDirectoryPath());
+    const QString partialFilePath
+        = testBackupDirectory.filePath(QStringLiteral("database.partial"));
+
+    const auto database = Common::Database::instance(
+            Common::Database::ResourcesDatabase,
+            Common::Database::ReadOnly);
+
+    sqlite3 *source = database ? sqliteHandle(*database) : nullptr;
+
+    if (source) {
+        sqlite3_busy_timeout(source, 1000);
+    }
+
+    const auto stopped = [this] {
+        return isInterruptionRequested() || runtimeErrorReported;
+    };
+
+    bool success = false;
+
+    for (int attempt = 0; source && !success && attempt < maxAttempts && !stopped(); ++attempt) {
+        for (int waited = 0; attempt > 0 && waited < retryDelay && !stopped(); waited += 100) {
+            msleep(100);
+        }
+
+        QFile::remove(partialFilePath);
+
+        sqlite3 *destination = nullptr;
+
+        if (!stopped() &&
+            sqlite3_open_v2(QFile::encodeName(partialFilePath).constData(),
+                            &destination, SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE, nullptr) == SQLITE_OK) {
+
+            auto backup = sqlite3_backup_init(destination, "main", source, "main");
+
+            if (backup) {
+                int restarts = 0;
+                int remaining = -1;
+                int result = SQLITE_OK;
+
+                do {
+                    result = sqlite3_backup_step(backup, pagesPerStep);
+
+                    const int nowRemaining = sqlite3_backup_remaining(backup);
+                    if (remaining >= 0 && nowRemaining > remaining) {
+                        restarts++;
+                    }
+                    remaining = nowRemaining;
+
+                    if (result != SQLITE_DONE) {
+                        msleep(stepDelay);
+                    }
+
+                } while ((result == SQLITE_OK || result == SQLITE_BUSY || result == SQLITE_LOCKED)
+                         && restarts < maxRestarts
+                         && !stopped());
+
+                success = (sqlite3_backup_finish(backup) == SQLITE_OK)
+                          && (result == SQLITE_DONE);
+            }
+        }
+
+        sqlite3_close(destination);
+    }
+
+    success = success
+              && !runtimeErrorReported
+              && removeDatabaseFiles(testBackupDirectory)
+              && QFile::rename(partialFilePath,
+                               testBackupDirectory.filePath(databaseFiles.first()));
+
+    if (!success) {
+        qCWarning(KAMD_LOG_RESOURCES) << "Creating the backup of the current database failed!";
+        QFile::remove(partialFilePath);
+    }
+
+    emit backupFinished(success);
+}
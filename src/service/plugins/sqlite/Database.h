@@ -27,6 +27,7 @@
 #include <QSqlError>
 #include <QString>
 #include <QStringList>
+#include <QThread>
 
 // Utils
 #include <utils/d_ptr.h>
@@ -41,6 +42,8 @@ namespace Common {
     class Database;
 } // namespace Common
 
+struct sqlite3;
+
 class ResourcesDatabaseInitializer {
 public:
     // static Database *self();
@@ -58,4 +61,53 @@ private:
 
 Common::Database::Ptr resourcesDatabase();
 
+/**
+ * Appends the message to the errors.log file next to the database
+ */
+void appendToDatabaseLog(const QString &message);
+
+/**
+ * The pragmas that can be configured in the [Database] group
+ * of kactivitymanagerdrc
+ */
+QStringList databaseTuningPragmas();
+
+/**
+ * @returns the SQLite connection behind the database, or nullptr if
+ * the Qt SQLite driver does not use the SQLite library the plugin is
+ * linked to (when Qt is built with its bundled SQLite). Two copies of
+ * the library must never work on the same file, the POSIX locks of one
+ * are released when the other closes the file.
+ *
+ * The handle can only be used in the thread of the connection.
+ */
+sqlite3 *sqliteHandle(const Common::Database &database);
+
+/**
+ * Creates the test backup of the resources database.
+ *
+ * The backup is made in a separate thread with the SQLite online backup
+ * API, a few pages at a time, so that the database can be used while
+ * the backup is being created. The copy is made from a connection of the
+ * Qt driver, so the backup is not created if the driver uses a different
+ * SQLite library than the plugin (see sqliteHandle).
+ *
+ * If the database keeps being written to during the copy, the backup
+ * is abandoned and retried a bit later, instead of copying the rest in
+ * one step which would block the writers until the copy is done.
+ */
+class ResourcesDatabaseBackup : public QThread {
+    Q_OBJECT
+
+public:
+    explicit ResourcesDatabaseBackup(QObject *parent = nullptr);
+    ~ResourcesDatabaseBackup() override;
+
+Q_SIGNALS:
+    void backupFinished(bool success);
+
+protected:
+    void run() override;
+};
+
 #endif // PLUGINS_SQLITE_RESOURCESDATABASE_H
@@ -0,0 +1,214 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Self
+#include <kactivities-features.h>
+#include "QueryStatistics.h"
+
+// Qt
+#include <QHash>
+#include <QRegularExpression>
+#include <QVariantMap>
+
+// STL
+#include <atomic>
+#include <map>
+#include <memory>
+#include <mutex>
+
+// Utils
+#include <utils/latency_histogram.h>
+
+// Local
+#include "Database.h"
+#include "../../MemoryUsage.h"
+
+namespace {
+    struct StatementStatistics {
+        QString statement;
+        kamd::utils::latency_histogram latency; // in microseconds
+        quint64 rows = 0;
+        quint64 failures = 0;
+    };
+
+    // Utils::exec is called from more than one thread
+    std::mutex statistics_mutex;
+
+    // Statement id -> statistics
+    std::map<QString, std::unique_ptr<StatementStatistics>> statistics;
+
+    // The queries, as Qt reports them, mapped to the statistics
+    // of the normalized statements, not to have to normalize
+    // the same query on each execution
+    QHash<QString, StatementStatistics *> statisticsForQuery;
+
+    std::atomic<int> slowQueryThreshold { 250 };
+
+    QString normalizedStatement(const QString &query)
+    {
+        static const QRegularExpression partitionName(
+            QStringLiteral("ResourceEvent_[0-9]{4}_[0-9]{2}"));
+
+        return query.simplified().replace(partitionName,
+                                          QStringLiteral("ResourceEvent_*"));
+    }
+
+    QString statementId(const QString &statement)
+    {
+        return QString::number(qHash(statement), 16);
+    }
+
+    StatementStatistics *statisticsFor(const QString &query)
+    {
+        auto &result = statisticsForQuery[query];
+
+        if (!result) {
+            const auto statement = normalizedStatement(query);
+            auto &entry = statistics[statementId(statement)];
+
+            if (!entry) {
+                entry.reset(new StatementStatistics());
+                entry->statement = statement;
+            }
+
+            result = entry.get();
+        }
+
+        return result;
+    }
+} // namespace
+
+QueryStatistics::QueryStatistics(QObject *parent)
+    : Module(QStringLiteral("stats"), parent)
+{
+    // The statement caches themselves are reported
+    // as a part of the SQLite heap
+    MemoryUsage::addReporter(QStringLiteral("sqlite"), QStringLiteral("statements"), this, [] {
+        std::lock_guard<std::mutex> lock(statistics_mutex);
+
+        quint64 bytes = MemoryUsage::bytes(statisticsForQuery);
+
+        for (const auto &entry: statistics) {
+            bytes += MemoryUsage::bytes(entry.first)
+                   + sizeof(StatementStatistics)
+                   + MemoryUsage::bytes(entry.second->statement);
+        }
+
+        for (auto it = statisticsForQuery.cbegin(); it != statisticsForQuery.cend(); ++it) {
+            bytes += MemoryUsage::bytes(it.key());
+        }
+
+        return MemoryUsage::Usage { quint64(statisticsForQuery.size()), bytes };
+    });
+}
+
+QueryStatistics::~QueryStatistics()
+{
+}
+
+void QueryStatistics::record(const QSqlQuery &query, qint64 elapsed)
+{
+    const auto queryText = query.lastQuery();
+    const bool success = query.isActive();
+    const auto rows = query.isSelect() ? 0 : query.numRowsAffected();
+
+    {
+        std::lock_guard<std::mutex> lock(statistics_mutex);
+
+        auto entry = statisticsFor(queryText);
+
+        entry->latency.record(quint64(elapsed / 1000));
+
+        if (rows > 0) {
+            entry->rows += rows;
+        }
+
+        if (!success) {
+            ++entry->failures;
+        }
+    }
+
+    const int threshold = slowQueryThreshold;
+
+    if (threshold > 0 && elapsed / 1000000 >= threshold) {
+        appendToDatabaseLog(QStringLiteral("slow query (%1 ms): %2")
+                                .arg(elapsed / 1000000)
+                                .arg(normalizedStatement(queryText)));
+    }
+}
+
+void QueryStatistics::setSlowQueryThreshold(int milliseconds)
+{
+    slowQueryThreshold = milliseconds;
+}
+
+bool QueryStatistics::isFeatureOperational(const QStringList &feature) const
+{
+    return !feature.isEmpty() && feature[0] == QLatin1String("db");
+}
+
+QStringList QueryStatistics::listFeatures(const QStringList &feature) const
+{
+    if (feature.isEmpty() || feature[0].isEmpty()) {
+        return { QStringLiteral("db/") };
+
+    } else if (feature[0] == QLatin1String("db")) {
+        std::lock_guard<std::mutex> lock(statistics_mutex);
+
+        QStringList result;
+        for (const auto &entry: statistics) {
+            result << entry.first;
+        }
+        return result;
+    }
+
+    return QStringList();
+}
+
+QDBusVariant QueryStatistics::featureValue(const QStringList &property) const
+{
+    if (property.size() != 2 || property[0] != QLatin1String("db")) {
+        return QDBusVariant(false);
+    }
+
+    std::lock_guard<std::mutex> lock(statistics_mutex);
+
+    const auto it = statistics.find(property[1]);
+
+    if (it == statistics.end()) {
+        return QDBusVariant(false);
+    }
+
+    const auto &entry = *it->second;
+    const auto &latency = entry.latency;
+
+    // The latencies are in microseconds
+    return QDBusVariant(QVariantMap {
+            { QStringLiteral("statement"), entry.statement },
+            { QStringLiteral("count"),     latency.count() },
+            { QStringLiteral("failures"),  entry.failures },
+            { QStringLiteral("rows"),      entry.rows },
+            { QStringLiteral("total"),     latency.total() },
+            { QStringLiteral("max"),       latency.max() },
+            { QStringLiteral("p50"),       latency.percentile(0.50) },
+            { QStringLiteral("p90"),       latency.percentile(0.90) },
+            { QStringLiteral("p99"),       latency.percentile(0.99) }
+        });
+}
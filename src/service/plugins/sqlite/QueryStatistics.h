@@ -0,0 +1,67 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PLUGINS_SQLITE_QUERY_STATISTICS_H
+#define PLUGINS_SQLITE_QUERY_STATISTICS_H
+
+// Qt
+#include <QSqlQuery>
+
+// Local
+#include <Module.h>
+
+/**
+ * QueryStatistics collects the latencies of the executed SQL statements.
+ *
+ * The statements are identified by their normalized text (the partition
+ * names are replaced by ResourceEvent_*), each having a latency histogram
+ * and the number of affected rows. The statements that take longer than
+ * the configured threshold are logged to errors.log.
+ *
+ * The data is available through the Features interface as the "stats"
+ * module -- stats/db/ lists the statement ids, stats/db/<id> returns
+ * the statement text along with the latency percentiles.
+ */
+class QueryStatistics: public Module {
+    Q_OBJECT
+
+public:
+    explicit QueryStatistics(QObject *parent = nullptr);
+    ~QueryStatistics() override;
+
+    /**
+     * Records the execution of the query that took
+     * the specified time, in nanoseconds
+     */
+    static void record(const QSqlQuery &query, qint64 elapsed);
+
+    /**
+     * Sets the time in milliseconds after which the statements
+     * are logged as slow. Zero disables the logging.
+     */
+    static void setSlowQueryThreshold(int milliseconds);
+
+    bool isFeatureOperational(const QStringList &feature) const override;
+    QStringList listFeatures(const QStringList &feature) const override;
+    QDBusVariant featureValue(const QStringList &property) const override;
+};
+
+#endif // PLUGINS_SQLITE_QUERY_STATISTICS_H
@@ -0,0 +1,287 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Self
+#include <kactivities-features.h>
+#include "ResourceEditTracker.h"
+
+// Qt
+#include <QCoreApplication>
+#include <QHash>
+#include <QPair>
+#include <QSet>
+#include <QSqlQuery>
+#include <QTimer>
+#include <QVector>
+
+// STL
+#include <memory>
+
+// Utils
+#include <utils/d_ptr_implementation.h>
+
+// Local
+#include "DebugResources.h"
+#include "Database.h"
+#include "Utils.h"
+#include "../../MemoryUsage.h"
+
+#include <common/database/schema/ResourcesDatabaseStatements.h>
+
+uint qHash(const ResourceEditTracker::Key &key, uint seed)
+{
+    return qHash(key.activity, seed)
+         ^ qHash(key.agent, seed + 1)
+         ^ qHash(key.resource, seed + 2);
+}
+
+class ResourceEditTracker::Private {
+public:
+    Private()
+        : currentTick(0)
+    {
+    }
+
+    struct Session {
+        // The tick at which the session ends, unless
+        // the resource is modified again
+        quint64 deadline;
+
+        // The time of the last modification, in seconds
+        qint64 lastModified;
+    };
+
+    // The key and the time of the last modification
+    typedef QPair<Key, qint64> EndedSession;
+
+    QSet<Key> &slot(quint64 tick)
+    {
+        return wheel[tick % wheel.size()];
+    }
+
+    void tick();
+    void endSession(const Key &key);
+    void saveEndedSessions();
+
+    QHash<Key, Session> sessions;
+    QVector<QSet<Key>> wheel;
+    quint64 currentTick;
+
+    QVector<EndedSession> endedSessions;
+
+    QTimer tickTimer;
+};
+
+void ResourceEditTracker::Private::tick()
+{
+    ++currentTick;
+
+    // The sessions are moved to a later slot when the resource is
+    // modified, so all the sessions in this slot have ended
+    auto &ending = slot(currentTick);
+
+    for (const auto &key: ending) {
+        endedSessions << EndedSession(key, sessions.take(key).lastModified);
+    }
+    ending.clear();
+
+    if (sessions.isEmpty()) {
+        tickTimer.stop();
+    }
+
+    saveEndedSessions();
+}
+
+void ResourceEditTracker::Private::endSession(const Key &key)
+{
+    const auto it = sessions.find(key);
+
+    if (it == sessions.end()) {
+        return;
+    }
+
+    slot(it->deadline).remove(key);
+    endedSessions << EndedSession(key, it->lastModified);
+    sessions.erase(it);
+}
+
+void ResourceEditTracker::Private::saveEndedSessions()
+{
+    if (endedSessions.isEmpty()) {
+        return;
+    }
+
+    auto database = resourcesDatabase();
+
+    if (!database) {
+        return;
+    }
+
+    static std::unique_ptr<QSqlQuery> updateEditsQuery;
+    static std::unique_ptr<QSqlQuery> insertEditsQuery;
+
+    Utils::prepare(*database, updateEditsQuery,
+                   Common::ResourcesDatabaseStatements::updateEditStats());
+    Utils::prepare(*database, insertEditsQuery,
+                   Common::ResourcesDatabaseStatements::insertEditStats());
+
+    DATABASE_TRANSACTION(*database);
+
+    for (const auto &session: endedSessions) {
+        const auto &key = session.first;
+
+        // The session is counted in the day of its last modification
+        const auto day = (session.second / 86400) * 86400;
+
+        Utils::exec(*database, Utils::FailOnError, *updateEditsQuery,
+            ":usedActivity", key.activity,
+            ":initiatingAgent", key.agent,
+            ":targettedResource", key.resource,
+            ":day", day,
+            ":lastEdit", session.second
+        );
+
+        if (updateEditsQuery->numRowsAffected() > 0) {
+            continue;
+        }
+
+        Utils::exec(*database, Utils::FailOnError, *insertEditsQuery,
+            ":usedActivity", key.activity,
+            ":initiatingAgent", key.agent,
+            ":targettedResource", key.resource,
+            ":day", day,
+            ":lastEdit", session.second
+        );
+    }
+
+    endedSessions.clear();
+}
+
+ResourceEditTracker::ResourceEditTracker(QObject *parent)
+    : QObject(parent)
+{
+    d->wheel.resize(2);
+
+    d->tickTimer.setInterval(1000);
+    connect(&d->tickTimer, &QTimer::timeout,
+            this, [this] { d->tick(); });
+
+    connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit,
+            this, [this] { flush(); });
+
+    MemoryUsage::addReporter(QStringLiteral("sqlite"), QStringLiteral("editSessions"), this, [this] {
+        quint64 bytes = MemoryUsage::bytes(d->sessions)
+                      + d->wheel.capacity() * sizeof(QSet<Key>);
+
+        for (auto it = d->sessions.cbegin(); it != d->sessions.cend(); ++it) {
+            bytes += MemoryUsage::bytes(it.key().activity)
+                   + MemoryUsage::bytes(it.key().agent)
+                   + MemoryUsage::bytes(it.key().resource);
+        }
+
+        for (const auto &slot: d->wheel) {
+            bytes += MemoryUsage::bytes(slot);
+        }
+
+        return MemoryUsage::Usage { quint64(d->sessions.size()), bytes };
+    });
+}
+
+ResourceEditTracker::~ResourceEditTracker()
+{
+}
+
+void ResourceEditTracker::setQuietPeriod(int seconds)
+{
+    // The wheel needs a slot more than the number of ticks
+    // in the quiet period, the current tick is never scheduled
+    const int slots = qMax(seconds, 1) + 1;
+
+    if (d->wheel.size() == slots) {
+        return;
+    }
+
+    flush();
+
+    d->wheel.clear();
+    d->wheel.resize(slots);
+}
+
+void ResourceEditTracker::modified(const Key &key, qint64 time)
+{
+    const auto deadline = d->currentTick + d->wheel.size() - 1;
+    const auto lastModified = time / 1000;
+
+    auto it = d->sessions.find(key);
+
+    if (it == d->sessions.end()) {
+        it = d->sessions.insert(key, Private::Session { deadline, lastModified });
+
+    } else {
+        d->slot(it->deadline).remove(key);
+        it->deadline = deadline;
+        it->lastModified = qMax(it->lastModified, lastModified);
+    }
+
+    d->slot(deadline).insert(key);
+
+    if (!d->tickTimer.isActive()) {
+        d->tickTimer.start();
+    }
+}
+
+void ResourceEditTracker::closed(const Key &key)
+{
+    d->endSession(key);
+    d->saveEndedSessions();
+}
+
+void ResourceEditTracker::flush()
+{
+    const auto keys = d->sessions.keys();
+
+    for (const auto &key: keys) {
+        d->endSession(key);
+    }
+
+    d->tickTimer.stop();
+    d->saveEndedSessions();
+}
+
+void ResourceEditTracker::saveOpenSessions()
+{
+    for (auto it = d->sessions.cbegin(); it != d->sessions.cend(); ++it) {
+        d->endedSessions << Private::EndedSession(it.key(), it->lastModified);
+    }
+
+    d->saveEndedSessions();
+}
+
+void ResourceEditTracker::discardIf(const Predicate &predicate)
+{
+    for (auto it = d->sessions.begin(); it != d->sessions.end(); ) {
+        if (predicate(it.key())) {
+            d->slot(it->deadline).remove(it.key());
+            it = d->sessions.erase(it);
+        } else {
+            ++it;
+        }
+    }
+}
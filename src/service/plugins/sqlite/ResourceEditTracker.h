@@ -0,0 +1,114 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PLUGINS_SQLITE_RESOURCE_EDIT_TRACKER_H
+#define PLUGINS_SQLITE_RESOURCE_EDIT_TRACKER_H
+
+// Qt
+#include <QObject>
+#include <QString>
+
+// STL
+#include <functional>
+
+// Utils
+#include <utils/d_ptr.h>
+
+/**
+ * ResourceEditTracker counts the edit sessions of the resources
+ * from the Modified events.
+ *
+ * The editors can report a modification on every autosave, so the
+ * modifications that come within the quiet period from each other
+ * are collapsed into a single session. The open sessions are kept in
+ * a timer wheel with one slot per second of the quiet period, and
+ * each session is added to the ResourceEditStats table once it ends.
+ *
+ * The sessions do not get the guarantee the journal gives to the
+ * events. The Modified events are committed in the journal as soon as
+ * StatsPlugin has processed them, while the session is stored only when
+ * it ends, so a crash loses the sessions that were still open. At
+ * shutdown, the open sessions are ended and stored.
+ */
+class ResourceEditTracker: public QObject {
+    Q_OBJECT
+
+public:
+    struct Key {
+        QString activity;
+        QString agent;
+        QString resource;
+
+        bool operator==(const Key &other) const
+        {
+            return activity == other.activity
+                && agent    == other.agent
+                && resource == other.resource;
+        }
+    };
+
+    typedef std::function<bool(const Key &key)> Predicate;
+
+    explicit ResourceEditTracker(QObject *parent = nullptr);
+    ~ResourceEditTracker() override;
+
+    /**
+     * Sets the time (in seconds) without modifications after which
+     * the edit session ends. The open sessions are ended when it changes.
+     */
+    void setQuietPeriod(int seconds);
+
+    /**
+     * The resource was modified, this starts a new session or
+     * extends the open one. The time is in milliseconds since the epoch.
+     */
+    void modified(const Key &key, qint64 time);
+
+    /**
+     * The resource was closed, its session ends without waiting
+     * for the quiet period to pass
+     */
+    void closed(const Key &key);
+
+    /**
+     * Ends all the open sessions and saves them
+     */
+    void flush();
+
+    /**
+     * Saves the open sessions as if they ended now, but keeps them open.
+     * Meant to be called inside a transaction that is rolled back,
+     * otherwise the sessions would be counted twice.
+     */
+    void saveOpenSessions();
+
+    /**
+     * Forgets the open sessions for the keys that match the predicate
+     */
+    void discardIf(const Predicate &predicate);
+
+private:
+    D_PTR;
+};
+
+uint qHash(const ResourceEditTracker::Key &key, uint seed = 0);
+
+#endif // PLUGINS_SQLITE_RESOURCE_EDIT_TRACKER_H
@@ -0,0 +1,208 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Self
+#include <kactivities-features.h>
+#include "ResourceEventPartitions.h"
+
+// Qt
+#include <QDateTime>
+#include <QHash>
+
+// Utils
+#include <utils/d_ptr_implementation.h>
+
+// Local
+#include "DebugResources.h"
+#include "Database.h"
+#include "Utils.h"
+
+#include <common/database/schema/ResourcesDatabaseSchema.h>
+
+using namespace Common::ResourcesDatabaseSchema;
+
+class ResourceEventPartitions::Private {
+public:
+    Private()
+        : loaded(false)
+    {
+    }
+
+    void load()
+    {
+        if (loaded) {
+            return;
+        }
+
+        partitions = eventPartitions(*resourcesDatabase());
+        loaded = true;
+    }
+
+    void updateView()
+    {
+        // The view can not be empty
+        if (partitions.isEmpty()) {
+            const auto partition = eventPartitionName(QDateTime::currentSecsSinceEpoch());
+            resourcesDatabase()->execQueries(eventPartitionSchema(partition));
+            partitions << partition;
+        }
+
+        resourcesDatabase()->execQueries(eventViewSchema(partitions));
+    }
+
+    bool loaded;
+
+    // Sorted by name, which means that the oldest one is the first
+    QStringList partitions;
+
+    // Prepared queries for each of the partitions
+    QHash<QString, QHash<QString, QSqlQuery>> queries;
+};
+
+ResourceEventPartitions *ResourceEventPartitions::self()
+{
+    static ResourceEventPartitions instance;
+    return &instance;
+}
+
+ResourceEventPartitions::ResourceEventPartitions()
+{
+}
+
+ResourceEventPartitions::~ResourceEventPartitions()
+{
+}
+
+QString ResourceEventPartitions::partitionFor(qint64 start)
+{
+    d->load();
+
+    const auto partition = eventPartitionName(start);
+
+    if (!d->partitions.contains(partition)) {
+        DATABASE_TRANSACTION(*resourcesDatabase());
+
+        qCDebug(KAMD_LOG_RESOURCES) << "Creating a new event partition:" << partition;
+
+        resourcesDatabase()->execQueries(eventPartitionSchema(partition));
+
+        d->partitions << partition;
+        d->partitions.sort();
+        d->updateView();
+    }
+
+    return partition;
+}
+
+QStringList ResourceEventPartitions::partitions() const
+{
+    d->load();
+
+    return d->partitions;
+}
+
+QStringList ResourceEventPartitions::partitionsSince(qint64 start) const
+{
+    d->load();
+
+    QStringList result;
+
+    for (const auto &partition: d->partitions) {
+        if (eventPartitionEnd(partition) > start) {
+            result << partition;
+        }
+    }
+
+    return result;
+}
+
+QStringList ResourceEventPartitions::partitionsBefore(qint64 time) const
+{
+    d->load();
+
+    QStringList result;
+
+    for (const auto &partition: d->partitions) {
+        if (eventPartitionEnd(partition) <= time) {
+            result << partition;
+        }
+    }
+
+    return result;
+}
+
+void ResourceEventPartitions::dropPartition(const QString &partition)
+{
+    d->load();
+
+    if (!d->partitions.contains(partition)) {
+        return;
+    }
+
+    // The prepared statements for the table need to be
+    // released before it can be dropped
+    d->queries.remove(partition);
+
+    DATABASE_TRANSACTION(*resourcesDatabase());
+
+    auto dropQuery = resourcesDatabase()->createQuery();
+    dropQuery.prepare(QStringLiteral("DROP TABLE %1").arg(partition));
+
+    if (Utils::exec(*resourcesDatabase(), Utils::IgnoreError, dropQuery)) {
+        d->partitions.removeAll(partition);
+        d->updateView();
+
+    } else {
+        // If something is still reading from the table, we can not
+        // drop it. Deleting the events is slower, but it has the
+        // same effect
+        qCDebug(KAMD_LOG_RESOURCES) << "Can not drop the partition, deleting the events instead:"
+                                    << partition << dropQuery.lastError();
+
+        auto deleteQuery = resourcesDatabase()->createQuery();
+        deleteQuery.prepare(QStringLiteral("DELETE FROM %1").arg(partition));
+
+        Utils::exec(*resourcesDatabase(), Utils::FailOnError, deleteQuery);
+    }
+}
+
+QSqlQuery &ResourceEventPartitions::query(const QString &partition,
+                                          const QString &queryTemplate)
+{
+    auto &queries = d->queries[partition];
+
+    auto query = queries.find(queryTemplate);
+
+    if (query == queries.end()) {
+        query = queries.insert(queryTemplate, resourcesDatabase()->createQuery());
+        Utils::prepare(*resourcesDatabase(), *query, queryTemplate.arg(partition));
+    }
+
+    return *query;
+}
+
+void ResourceEventPartitions::reload()
+{
+    // The prepared statements might refer to the tables
+    // that do not exist any more
+    d->queries.clear();
+    d->partitions.clear();
+    d->loaded = false;
+}
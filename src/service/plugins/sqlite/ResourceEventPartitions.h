@@ -0,0 +1,94 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PLUGINS_SQLITE_RESOURCE_EVENT_PARTITIONS_H
+#define PLUGINS_SQLITE_RESOURCE_EVENT_PARTITIONS_H
+
+// Qt
+#include <QString>
+#include <QStringList>
+#include <QSqlQuery>
+
+// Utils
+#include <utils/d_ptr.h>
+
+/**
+ * ResourceEventPartitions routes the queries on the recorded events
+ * to the monthly partition tables.
+ *
+ * The events are stored in ResourceEvent_yyyy_MM tables, based on
+ * the (UTC) month in which they started. The ResourceEvent view
+ * is kept in sync with the list of partitions for the readers
+ * outside of the daemon.
+ */
+class ResourceEventPartitions {
+public:
+    static ResourceEventPartitions *self();
+
+    ~ResourceEventPartitions();
+
+    /**
+     * Returns the partition for the events started at the specified
+     * time. The partition is created if it does not exist.
+     */
+    QString partitionFor(qint64 start);
+
+    /**
+     * Returns all partitions, the oldest one first
+     */
+    QStringList partitions() const;
+
+    /**
+     * Returns the partitions that can contain events started
+     * at the specified time or later, the oldest one first
+     */
+    QStringList partitionsSince(qint64 start) const;
+
+    /**
+     * Returns the partitions that contain only the events started
+     * before the specified time
+     */
+    QStringList partitionsBefore(qint64 time) const;
+
+    /**
+     * Removes the partition, and all the events in it
+     */
+    void dropPartition(const QString &partition);
+
+    /**
+     * Returns the prepared query for the specified partition.
+     * The query text should use %1 as the name of the table.
+     */
+    QSqlQuery &query(const QString &partition, const QString &queryTemplate);
+
+    /**
+     * Forgets the cached list of partitions, it is read from the
+     * database again when needed. Used after a rolled back transaction
+     * which might have created new partitions.
+     */
+    void reload();
+
+private:
+    ResourceEventPartitions();
+
+    D_PTR;
+};
+
+#endif // PLUGINS_SQLITE_RESOURCE_EVENT_PARTITIONS_H
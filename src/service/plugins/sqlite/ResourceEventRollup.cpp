@@ -0,0 +1,181 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Self
+#include <kactivities-features.h>
+#include "ResourceEventRollup.h"
+
+// Qt
+#include <QDateTime>
+#include <QStringList>
+#include <QTimer>
+
+// Utils
+#include <utils/d_ptr_implementation.h>
+
+// Local
+#include "DebugResources.h"
+#include "Database.h"
+#include "ResourceEventPartitions.h"
+#include "Utils.h"
+
+#include <common/database/schema/ResourcesDatabaseSchema.h>
+
+class ResourceEventRollup::Private {
+public:
+    Private()
+        : rollupAge(0)
+        , cutoff(0)
+    {
+    }
+
+    void rollupNextPartition();
+    void rollupPartition(const QString &partition);
+
+    int rollupAge;
+
+    // Events started before this time are being rolled up
+    qint64 cutoff;
+    QStringList pendingPartitions;
+
+    QTimer rollupTimer;
+};
+
+void ResourceEventRollup::Private::rollupNextPartition()
+{
+    if (pendingPartitions.isEmpty()) {
+        return;
+    }
+
+    rollupPartition(pendingPartitions.takeFirst());
+
+    if (!pendingPartitions.isEmpty()) {
+        rollupTimer.start();
+    }
+}
+
+void ResourceEventRollup::Private::rollupPartition(const QString &partition)
+{
+    qCDebug(KAMD_LOG_RESOURCES) << "Rolling up the events from" << partition;
+
+    auto partitions = ResourceEventPartitions::self();
+
+    {
+        DATABASE_TRANSACTION(*resourcesDatabase());
+
+        // The events that are still open can not be aggregated,
+        // we do not know how long they will last
+        auto &rollupQuery = partitions->query(partition, QStringLiteral(
+            "INSERT OR REPLACE INTO ResourceEventDaily "
+            "    (usedActivity, initiatingAgent, targettedResource, day, "
+            "     eventCount, accessCount, totalDuration) "
+            "SELECT "
+                "e.usedActivity, e.initiatingAgent, e.targettedResource, e.day, "
+                "COALESCE(d.eventCount, 0)    + e.eventCount, "
+                "COALESCE(d.accessCount, 0)   + e.accessCount, "
+                "COALESCE(d.totalDuration, 0) + e.totalDuration "
+            "FROM ("
+                "SELECT "
+                    "usedActivity, initiatingAgent, targettedResource, "
+                    "start - start % 86400 AS day, "
+                    "count(*)          AS eventCount, "
+                    "sum(end = start)  AS accessCount, "
+                    "sum(end - start)  AS totalDuration "
+                "FROM %1 "
+                "WHERE start < :cutoff AND end IS NOT NULL "
+                "GROUP BY usedActivity, initiatingAgent, targettedResource, day"
+            ") AS e "
+            "LEFT JOIN ResourceEventDaily AS d ON "
+                "d.usedActivity      = e.usedActivity AND "
+                "d.initiatingAgent   = e.initiatingAgent AND "
+                "d.targettedResource = e.targettedResource AND "
+                "d.day               = e.day"
+        ));
+
+        auto &removeEventsQuery = partitions->query(partition, QStringLiteral(
+            "DELETE FROM %1 "
+            "WHERE start < :cutoff AND end IS NOT NULL"
+        ));
+
+        if (!Utils::exec(*resourcesDatabase(), Utils::FailOnError, rollupQuery,
+                         ":cutoff", cutoff)) {
+            return;
+        }
+
+        Utils::exec(*resourcesDatabase(), Utils::FailOnError, removeEventsQuery,
+                    ":cutoff", cutoff);
+    }
+
+    // If nothing is left in the partition, we can get rid of it
+    if (Common::ResourcesDatabaseSchema::eventPartitionEnd(partition) <= cutoff) {
+        auto &countQuery = partitions->query(partition, QStringLiteral(
+            "SELECT count(*) FROM %1"
+        ));
+
+        Utils::exec(*resourcesDatabase(), Utils::FailOnError, countQuery);
+
+        const bool isEmpty = countQuery.next() && countQuery.value(0).toInt() == 0;
+        countQuery.finish();
+
+        if (isEmpty) {
+            partitions->dropPartition(partition);
+        }
+    }
+}
+
+ResourceEventRollup::ResourceEventRollup(QObject *parent)
+    : QObject(parent)
+{
+    d->rollupTimer.setInterval(0);
+    d->rollupTimer.setSingleShot(true);
+    connect(&d->rollupTimer, &QTimer::timeout,
+            this, [=] { d->rollupNextPartition(); });
+}
+
+ResourceEventRollup::~ResourceEventRollup()
+{
+}
+
+void ResourceEventRollup::setRollupAge(int days)
+{
+    d->rollupAge = days;
+}
+
+void ResourceEventRollup::scheduleRollup()
+{
+    if (d->rollupAge <= 0) {
+        return;
+    }
+
+    d->cutoff = QDateTime::currentSecsSinceEpoch()
+                    - static_cast<qint64>(d->rollupAge) * 24 * 60 * 60;
+
+    // Rolling up whole days only
+    d->cutoff -= d->cutoff % 86400;
+
+    d->pendingPartitions.clear();
+    for (const auto &partition: ResourceEventPartitions::self()->partitions()) {
+        if (Common::ResourcesDatabaseSchema::eventPartitionStart(partition) < d->cutoff) {
+            d->pendingPartitions << partition;
+        }
+    }
+
+    d->rollupTimer.start();
+}
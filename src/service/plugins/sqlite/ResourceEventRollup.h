@@ -0,0 +1,62 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PLUGINS_SQLITE_RESOURCE_EVENT_ROLLUP_H
+#define PLUGINS_SQLITE_RESOURCE_EVENT_ROLLUP_H
+
+// Qt
+#include <QObject>
+
+// Utils
+#include <utils/d_ptr.h>
+
+/**
+ * ResourceEventRollup folds the old events into the daily aggregates
+ * stored in the ResourceEventDaily table.
+ *
+ * The scoring does not need the exact times of the old events, so we
+ * can keep one row per activity, agent, resource and day instead.
+ * The job processes one event partition at a time, returning to the
+ * event loop in between.
+ */
+class ResourceEventRollup: public QObject {
+    Q_OBJECT
+
+public:
+    explicit ResourceEventRollup(QObject *parent = nullptr);
+    ~ResourceEventRollup() override;
+
+    /**
+     * Sets the age (in days) after which the events are rolled up.
+     * Zero disables the rollup.
+     */
+    void setRollupAge(int days);
+
+    /**
+     * Schedules the rollup of the events that are older than
+     * the configured age
+     */
+    void scheduleRollup();
+
+private:
+    D_PTR;
+};
+
+#endif // PLUGINS_SQLITE_RESOURCE_EVENT_ROLLUP_H
@@ -0,0 +1,275 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Self
+#include <kactivities-features.h>
+#include "ResourceFocusTime.h"
+
+// Qt
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QHash>
+#include <QPair>
+#include <QSqlQuery>
+#include <QTimer>
+
+// STL
+#include <memory>
+
+// Utils
+#include <utils/d_ptr_implementation.h>
+
+// Local
+#include "DebugResources.h"
+#include "Database.h"
+#include "Utils.h"
+#include "../../MemoryUsage.h"
+
+#include <common/database/schema/ResourcesDatabaseStatements.h>
+
+uint qHash(const ResourceFocusTime::Key &key, uint seed)
+{
+    return qHash(key.activity, seed)
+         ^ qHash(key.agent, seed + 1)
+         ^ qHash(key.resource, seed + 2);
+}
+
+namespace {
+    // How often the accumulated durations are written to the database
+    const int flushInterval = 5 * 60 * 1000;
+
+    const qint64 msecsPerDay = 24 * 60 * 60 * 1000;
+
+    inline qint64 dayOf(qint64 msecs)
+    {
+        return (msecs - msecs % msecsPerDay) / 1000;
+    }
+} // namespace
+
+class ResourceFocusTime::Private {
+public:
+    // The focus of a resource that has not ended yet,
+    // the times are in milliseconds
+    struct Span {
+        QString activity;
+        qint64 start;
+    };
+
+    struct Total {
+        Total()
+            : count(0)
+            , duration(0)
+        {
+        }
+
+        quint64 count;
+        qint64 duration;
+    };
+
+    // The agent and the resource
+    typedef QPair<QString, QString> Resource;
+
+    // The key and the start of the day (in seconds, UTC)
+    typedef QPair<Key, qint64> DayKey;
+
+    void addDuration(const Key &key, qint64 start, qint64 end);
+    void scheduleFlush();
+
+    QHash<Resource, Span> focussed;
+    QHash<DayKey, Total> totals;
+
+    QTimer flushTimer;
+};
+
+void ResourceFocusTime::Private::addDuration(const Key &key, qint64 start, qint64 end)
+{
+    // The durations are split at midnight (UTC), the same
+    // way the events are aggregated in ResourceEventDaily
+    while (start < end) {
+        const auto nextDay = (dayOf(start) * 1000) + msecsPerDay;
+        const auto until = qMin(end, nextDay);
+
+        totals[qMakePair(key, dayOf(start))].duration += until - start;
+
+        start = until;
+    }
+}
+
+void ResourceFocusTime::Private::scheduleFlush()
+{
+    if (!flushTimer.isActive()) {
+        flushTimer.start();
+    }
+}
+
+ResourceFocusTime::ResourceFocusTime(QObject *parent)
+    : QObject(parent)
+{
+    d->flushTimer.setInterval(flushInterval);
+    d->flushTimer.setSingleShot(true);
+    connect(&d->flushTimer, &QTimer::timeout,
+            this, [this] { flush(); });
+
+    connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit,
+            this, [this] { flush(); });
+
+    MemoryUsage::addReporter(QStringLiteral("sqlite"), QStringLiteral("focusTime"), this, [this] {
+        const auto keyBytes = [] (const Key &key) {
+            return MemoryUsage::bytes(key.activity)
+                 + MemoryUsage::bytes(key.agent)
+                 + MemoryUsage::bytes(key.resource);
+        };
+
+        quint64 bytes = MemoryUsage::bytes(d->focussed) + MemoryUsage::bytes(d->totals);
+
+        for (auto it = d->focussed.cbegin(); it != d->focussed.cend(); ++it) {
+            bytes += MemoryUsage::bytes(it.key().first)
+                   + MemoryUsage::bytes(it.key().second)
+                   + MemoryUsage::bytes(it->activity);
+        }
+
+        for (auto it = d->totals.cbegin(); it != d->totals.cend(); ++it) {
+            bytes += keyBytes(it.key().first);
+        }
+
+        return MemoryUsage::Usage {
+            quint64(d->focussed.size() + d->totals.size()), bytes };
+    });
+}
+
+ResourceFocusTime::~ResourceFocusTime()
+{
+}
+
+void ResourceFocusTime::focusIn(const Key &key, qint64 time)
+{
+    const Private::Resource resource(key.agent, key.resource);
+
+    if (d->focussed.contains(resource)) {
+        return;
+    }
+
+    d->focussed.insert(resource, Private::Span { key.activity, time });
+    ++d->totals[qMakePair(key, dayOf(time))].count;
+
+    d->scheduleFlush();
+}
+
+void ResourceFocusTime::focusOut(const QString &agent, const QString &resource,
+                                 qint64 time)
+{
+    const auto it = d->focussed.find(Private::Resource(agent, resource));
+
+    if (it == d->focussed.end()) {
+        return;
+    }
+
+    d->addDuration(Key { it->activity, agent, resource }, it->start, time);
+    d->focussed.erase(it);
+
+    d->scheduleFlush();
+}
+
+void ResourceFocusTime::flush()
+{
+    // The resources that still have the focus are counted up to now,
+    // and the rest of their focus will be added on the next flush
+    const auto now = QDateTime::currentMSecsSinceEpoch();
+
+    for (auto it = d->focussed.begin(); it != d->focussed.end(); ++it) {
+        d->addDuration(Key { it->activity, it.key().first, it.key().second },
+                       it->start, now);
+        it->start = now;
+    }
+
+    if (!d->focussed.isEmpty()) {
+        d->scheduleFlush();
+    }
+
+    if (d->totals.isEmpty()) {
+        return;
+    }
+
+    auto database = resourcesDatabase();
+
+    if (!database) {
+        return;
+    }
+
+    qCDebug(KAMD_LOG_RESOURCES) << "Saving the focus time for" << d->totals.size() << "resources";
+
+    static std::unique_ptr<QSqlQuery> updateFocusQuery;
+    static std::unique_ptr<QSqlQuery> insertFocusQuery;
+
+    Utils::prepare(*database, updateFocusQuery,
+                   Common::ResourcesDatabaseStatements::updateFocusTime());
+    Utils::prepare(*database, insertFocusQuery,
+                   Common::ResourcesDatabaseStatements::insertFocusTime());
+
+    DATABASE_TRANSACTION(*database);
+
+    for (auto it = d->totals.cbegin(); it != d->totals.cend(); ++it) {
+        const auto &key = it.key().first;
+        const auto day = it.key().second;
+
+        Utils::exec(*database, Utils::FailOnError, *updateFocusQuery,
+            ":usedActivity", key.activity,
+            ":initiatingAgent", key.agent,
+            ":targettedResource", key.resource,
+            ":day", day,
+            ":focusCount", it->count,
+            ":focusDuration", it->duration
+        );
+
+        if (updateFocusQuery->numRowsAffected() > 0) {
+            continue;
+        }
+
+        Utils::exec(*database, Utils::FailOnError, *insertFocusQuery,
+            ":usedActivity", key.activity,
+            ":initiatingAgent", key.agent,
+            ":targettedResource", key.resource,
+            ":day", day,
+            ":focusCount", it->count,
+            ":focusDuration", it->duration
+        );
+    }
+
+    d->totals.clear();
+}
+
+void ResourceFocusTime::discardIf(const Predicate &predicate)
+{
+    for (auto it = d->totals.begin(); it != d->totals.end(); ) {
+        if (predicate(it.key().first)) {
+            it = d->totals.erase(it);
+        } else {
+            ++it;
+        }
+    }
+
+    const auto now = QDateTime::currentMSecsSinceEpoch();
+
+    for (auto it = d->focussed.begin(); it != d->focussed.end(); ++it) {
+        if (predicate(Key { it->activity, it.key().first, it.key().second })) {
+            it->start = now;
+        }
+    }
+}
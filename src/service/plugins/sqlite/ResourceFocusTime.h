@@ -0,0 +1,104 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PLUGINS_SQLITE_RESOURCE_FOCUS_TIME_H
+#define PLUGINS_SQLITE_RESOURCE_FOCUS_TIME_H
+
+// Qt
+#include <QObject>
+#include <QString>
+
+// STL
+#include <functional>
+
+// Utils
+#include <utils/d_ptr.h>
+
+/**
+ * ResourceFocusTime measures for how long the resources had the focus,
+ * based on the FocussedIn and FocussedOut events.
+ *
+ * Storing the focus events themselves would make the database grow
+ * quickly, so the durations are summed in memory per activity, agent,
+ * resource and day, and added to the ResourceFocusDaily table
+ * periodically and at shutdown.
+ *
+ * The durations do not get the guarantee the journal gives to the
+ * events. The focus events are committed in the journal as soon as
+ * StatsPlugin has processed them, while their durations can stay in
+ * memory for up to the flush interval, so a crash loses at most that
+ * much of the focus time. The accesses and the scores are not affected.
+ */
+class ResourceFocusTime: public QObject {
+    Q_OBJECT
+
+public:
+    struct Key {
+        QString activity;
+        QString agent;
+        QString resource;
+
+        bool operator==(const Key &other) const
+        {
+            return activity == other.activity
+                && agent    == other.agent
+                && resource == other.resource;
+        }
+    };
+
+    typedef std::function<bool(const Key &key)> Predicate;
+
+    explicit ResourceFocusTime(QObject *parent = nullptr);
+    ~ResourceFocusTime() override;
+
+    /**
+     * The resource got the focus. If it already had it,
+     * the focus is considered to have started earlier.
+     * The time is in milliseconds since the epoch.
+     */
+    void focusIn(const Key &key, qint64 time);
+
+    /**
+     * The resource lost the focus, or it was closed
+     */
+    void focusOut(const QString &agent, const QString &resource,
+                  qint64 time);
+
+    /**
+     * Adds the accumulated durations to the database. The time the
+     * currently focussed resources had the focus so far is included.
+     */
+    void flush();
+
+    /**
+     * Forgets the durations that were not written to the database yet
+     * for the keys that match the predicate. The focussed resources
+     * are counted again from now on.
+     */
+    void discardIf(const Predicate &predicate);
+
+private:
+    D_PTR;
+};
+
+uint qHash(const ResourceFocusTime::Key &key, uint seed = 0);
+
+#endif // PLUGINS_SQLITE_RESOURCE_FOCUS_TIME_H
@@ -41,6 +41,10 @@
 #include "StatsPlugin.h"
 #include "resourcelinkingadaptor.h"
 
+#include <common/database/schema/ResourcesDatabaseStatements.h>
+
+namespace Statements = Common::ResourcesDatabaseStatements;
+
 ResourceLinking::ResourceLinking(QObject *parent)
     : QObject(parent)
 {
@@ -88,15 +92,7 @@ void ResourceLinking::LinkResourceToActivity(QString initiatingAgent,
                "Resource should not be empty");
 
     Utils::prepare(*resourcesDatabase(), linkResourceToActivityQuery,
-        QStringLiteral(
-            "INSERT OR REPLACE INTO ResourceLink"
-            "        (usedActivity,  initiatingAgent,  targettedResource) "
-            "VALUES ( "
-                "COALESCE(:usedActivity,''),"
-                "COALESCE(:initiatingAgent,''),"
-                "COALESCE(:targettedResource,'')"
-            ")"
-        ));
+                   Statements::linkResourceToActivity());
 
     DATABASE_TRANSACTION(*resourcesDatabase());
 
@@ -148,26 +144,11 @@ void ResourceLinking::UnlinkResourceFromActivity(QString initiatingAgent,
 
     if (usedActivity == ":any") {
         Utils::prepare(*resourcesDatabase(), unlinkResourceFromAllActivitiesQuery,
-            QStringLiteral(
-                "DELETE FROM ResourceLink "
-                "WHERE "
-                "initiatingAgent   = COALESCE(:initiatingAgent  , '') AND "
-                "(targettedResource = COALESCE(:targettedResource, '') OR "
-                "(initiatingAgent = 'org.kde.plasma.favorites.applications' "
-                "AND targettedResource = 'applications:' || COALESCE(:targettedResource, '')))"
-            ));
+                       Statements::unlinkResourceFromAllActivities());
         query = unlinkResourceFromAllActivitiesQuery.get();
     } else {
         Utils::prepare(*resourcesDatabase(), unlinkResourceFromActivityQuery,
-            QStringLiteral(
-                "DELETE FROM ResourceLink "
-                "WHERE "
-                "usedActivity      = COALESCE(:usedActivity     , '') AND "
-                "initiatingAgent   = COALESCE(:initiatingAgent  , '') AND "
-                "(targettedResource = COALESCE(:targettedResource, '') OR "
-                "(initiatingAgent = 'org.kde.plasma.favorites.applications'"
-                "AND targettedResource =  'applications:' || COALESCE(:targettedResource, '')))"
-            ));
+                       Statements::unlinkResourceFromActivity());
         query = unlinkResourceFromActivityQuery.get();
     }
 
@@ -223,13 +204,7 @@ bool ResourceLinking::IsResourceLinkedToActivity(QString initiatingAgent,
                "Resource should not be empty");
 
     Utils::prepare(*resourcesDatabase(), isResourceLinkedToActivityQuery,
-        QStringLiteral(
-            "SELECT * FROM ResourceLink "
-            "WHERE "
-            "usedActivity      = COALESCE(:usedActivity     , '') AND "
-            "initiatingAgent   = COALESCE(:initiatingAgent  , '') AND "
-            "targettedResource = COALESCE(:targettedResource, '') "
-        ));
+                   Statements::isResourceLinkedToActivity());
 
     Utils::exec(*resourcesDatabase(), Utils::FailOnError, *isResourceLinkedToActivityQuery,
         ":usedActivity"      , usedActivity,
@@ -237,7 +212,10 @@ bool ResourceLinking::IsResourceLinkedToActivity(QString initiatingAgent,
         ":targettedResource" , targettedResource
     );
 
-    return isResourceLinkedToActivityQuery->next();
+    const bool isLinked = isResourceLinkedToActivityQuery->next();
+    isResourceLinkedToActivityQuery->finish();
+
+    return isLinked;
 }
 
 bool ResourceLinking::validateArguments(QString &initiatingAgent,
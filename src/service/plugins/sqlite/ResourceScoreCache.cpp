@@ -32,66 +32,25 @@
 #include "DebugResources.h"
 #include "StatsPlugin.h"
 #include "Database.h"
+#include "ResourceEventPartitions.h"
+#include "ResourceScoreStore.h"
 #include "Utils.h"
 
+#include <common/database/schema/ResourcesDatabaseStatements.h>
+
+namespace Statements = Common::ResourcesDatabaseStatements;
 
 class ResourceScoreCache::Queries {
 private:
     Queries()
-        : createResourceScoreCacheQuery(resourcesDatabase()->createQuery())
-        , getResourceScoreCacheQuery(resourcesDatabase()->createQuery())
-        , updateResourceScoreCacheQuery(resourcesDatabase()->createQuery())
-        , getScoreAdditionQuery(resourcesDatabase()->createQuery())
+        : getDailyScoreAdditionQuery(resourcesDatabase()->createQuery())
     {
-
-        Utils::prepare(*resourcesDatabase(),
-            createResourceScoreCacheQuery, QStringLiteral(
-            "INSERT INTO ResourceScoreCache "
-            "VALUES (:usedActivity, :initiatingAgent, :targettedResource, "
-                    "0, 0, " // type, score
-                    ":firstUpdate, " // lastUpdate
-                    ":firstUpdate)"
-        ));
-
-        Utils::prepare(*resourcesDatabase(),
-            getResourceScoreCacheQuery, QStringLiteral(
-            "SELECT cachedScore, lastUpdate, firstUpdate FROM ResourceScoreCache "
-            "WHERE "
-                ":usedActivity      = usedActivity AND "
-                ":initiatingAgent   = initiatingAgent AND "
-                ":targettedResource = targettedResource "
-        ));
-
-        Utils::prepare(*resourcesDatabase(),
-            updateResourceScoreCacheQuery, QStringLiteral(
-            "UPDATE ResourceScoreCache SET "
-                "cachedScore = :cachedScore, "
-                "lastUpdate  = :lastUpdate "
-            "WHERE "
-                ":usedActivity      = usedActivity AND "
-                ":initiatingAgent   = initiatingAgent AND "
-                ":targettedResource = targettedResource "
-        ));
-
         Utils::prepare(*resourcesDatabase(),
-            getScoreAdditionQuery, QStringLiteral(
-            "SELECT start, end "
-            "FROM ResourceEvent "
-            "WHERE "
-                ":usedActivity      = usedActivity AND "
-                ":initiatingAgent   = initiatingAgent AND "
-                ":targettedResource = targettedResource AND "
-                "start > :start "
-            "ORDER BY "
-                "start ASC"
-        ));
+            getDailyScoreAdditionQuery, Statements::dailyScoreAddition());
     }
 
 public:
-    QSqlQuery createResourceScoreCacheQuery;
-    QSqlQuery getResourceScoreCacheQuery;
-    QSqlQuery updateResourceScoreCacheQuery;
-    QSqlQuery getScoreAdditionQuery;
+    QSqlQuery getDailyScoreAdditionQuery;
 
     static Queries &self();
 
@@ -110,18 +69,18 @@ public:
     QString application;
     QString resource;
 
-    inline qreal timeFactor(int days) const
-    {
-        // Exp is falling rather quickly, we are slowing it 32 times
-        return std::exp(-days / 32.0);
-    }
-
     inline qreal timeFactor(const QDateTime &fromTime, const QDateTime &toTime) const
     {
-        return timeFactor(fromTime.daysTo(toTime));
+        return ResourceScoreCache::timeFactor(fromTime, toTime);
     }
 };
 
+qreal ResourceScoreCache::timeFactor(const QDateTime &fromTime, const QDateTime &toTime)
+{
+    // Exp is falling rather quickly, we are slowing it 32 times
+    return std::exp(-fromTime.daysTo(toTime) / 32.0);
+}
+
 ResourceScoreCache::ResourceScoreCache(const QString &activity,
                                        const QString &application,
                                        const QString &resource)
@@ -153,48 +112,31 @@ void ResourceScoreCache::update()
     QDateTime currentTime = QDateTime::currentDateTime();
     qreal score = 0;
 
-    DATABASE_TRANSACTION(*resourcesDatabase());
+    // The scores are kept in memory, see ResourceScoreStore
+    const ResourceScoreStore::Key key { d->activity, d->application, d->resource };
+    ResourceScoreStore::Entry entry;
 
-    qCDebug(KAMD_LOG_RESOURCES) << "Creating the cache for: " << d->resource;
+    const bool isCacheNew = !ResourceScoreStore::self()->find(key, entry);
 
-    // This can fail if we have the cache already made
-    auto isCacheNew = Utils::exec(*resourcesDatabase(),
-        Utils::IgnoreError, Queries::self().createResourceScoreCacheQuery,
-        ":usedActivity", d->activity,
-        ":initiatingAgent", d->application,
-        ":targettedResource", d->resource,
-        ":firstUpdate", currentTime.toSecsSinceEpoch()
-    );
+    qCDebug(KAMD_LOG_RESOURCES) << "Already in cache? " << (!isCacheNew);
 
-    // Getting the old score
-    Utils::exec(*resourcesDatabase(),
-        Utils::FailOnError, Queries::self().getResourceScoreCacheQuery,
-        ":usedActivity", d->activity,
-        ":initiatingAgent", d->application,
-        ":targettedResource", d->resource
-    );
-
-    // Only and always one result
-    for (const auto &result: Queries::self().getResourceScoreCacheQuery) {
+    if (isCacheNew) {
+        // If we haven't had the cache before, set the score to 0
+        firstUpdate = currentTime;
+        lastUpdate = currentTime;
+        score = 0;
 
-        lastUpdate.setSecsSinceEpoch(result["lastUpdate"].toUInt());
-        firstUpdate.setSecsSinceEpoch(result["firstUpdate"].toUInt());
+    } else {
+        lastUpdate.setSecsSinceEpoch(entry.lastUpdate);
+        firstUpdate.setSecsSinceEpoch(entry.firstUpdate);
 
-        qCDebug(KAMD_LOG_RESOURCES) << "Already in database? " << (!isCacheNew);
         qCDebug(KAMD_LOG_RESOURCES) << "      First update : " << firstUpdate;
         qCDebug(KAMD_LOG_RESOURCES) << "       Last update : " << lastUpdate;
 
-        if (isCacheNew) {
-            // If we haven't had the cache before, set the score to 0
-            firstUpdate = currentTime;
-            score = 0;
-
-        } else {
-            // Adjusting the score depending on the time that passed since the
-            // last update
-            score = result["cachedScore"].toReal();
-            score *= d->timeFactor(lastUpdate, currentTime);
-        }
+        // Adjusting the score depending on the time that passed since the
+        // last update
+        score = entry.score;
+        score *= d->timeFactor(lastUpdate, currentTime);
     }
 
     // Calculating the updated score
@@ -205,30 +147,62 @@ void ResourceScoreCache::update()
     qCDebug(KAMD_LOG_RESOURCES) << "      First update : " << firstUpdate;
     qCDebug(KAMD_LOG_RESOURCES) << "       Last update : " << lastUpdate;
 
-    Utils::exec(*resourcesDatabase(), Utils::FailOnError, Queries::self().getScoreAdditionQuery,
+    uint lastEventStart = currentTime.toSecsSinceEpoch();
+
+    // The old events have been rolled up into daily aggregates.
+    // They are older than the events in the partitions, so we
+    // are processing them first
+    Utils::exec(*resourcesDatabase(), Utils::FailOnError, Queries::self().getDailyScoreAdditionQuery,
         ":usedActivity", d->activity,
         ":initiatingAgent", d->application,
         ":targettedResource", d->resource,
         ":start", lastUpdate.toSecsSinceEpoch()
     );
 
-    uint lastEventStart = currentTime.toSecsSinceEpoch();
+    for (const auto &result: Queries::self().getDailyScoreAdditionQuery) {
+        lastEventStart = result["day"].toUInt();
+
+        const auto accessCount = result["accessCount"].toUInt();
+        const auto totalDuration = result["totalDuration"].toUInt();
 
-    for (const auto &result: Queries::self().getScoreAdditionQuery) {
-        lastEventStart = result["start"].toUInt();
+        // Same as for the separate events, the accessed ones are
+        // counted as if they were open for a minute
+        score += d->timeFactor(QDateTime::fromSecsSinceEpoch(lastEventStart), currentTime)
+                 * (accessCount + totalDuration / 60.0);
+    }
+
+    // The partitions are sorted by time, so the events will
+    // be processed in the order in which they started
+    auto partitions = ResourceEventPartitions::self();
+    for (const auto &partition:
+             partitions->partitionsSince(lastUpdate.toSecsSinceEpoch())) {
+
+        auto &getScoreAdditionQuery =
+            partitions->query(partition, Statements::scoreAddition());
+
+        Utils::exec(*resourcesDatabase(), Utils::FailOnError, getScoreAdditionQuery,
+            ":usedActivity", d->activity,
+            ":initiatingAgent", d->application,
+            ":targettedResource", d->resource,
+            ":start", lastUpdate.toSecsSinceEpoch()
+        );
+
+        for (const auto &result: getScoreAdditionQuery) {
+            lastEventStart = result["start"].toUInt();
 
-        const auto end = result["end"].toUInt();
-        const auto intervalLength = end - lastEventStart;
+            const auto end = result["end"].toUInt();
+            const auto intervalLength = end - lastEventStart;
 
-        qCDebug(KAMD_LOG_RESOURCES) << "Interval length is " << intervalLength;
+            qCDebug(KAMD_LOG_RESOURCES) << "Interval length is " << intervalLength;
 
-        if (intervalLength == 0) {
-            // We have an Accessed event - otherwise, this wouldn't be 0
-            score += d->timeFactor(QDateTime::fromSecsSinceEpoch(end), currentTime); // like it is open for 1 minute
+            if (intervalLength == 0) {
+                // We have an Accessed event - otherwise, this wouldn't be 0
+                score += d->timeFactor(QDateTime::fromSecsSinceEpoch(end), currentTime); // like it is open for 1 minute
 
-        } else {
-            score += d->timeFactor(QDateTime::fromSecsSinceEpoch(end), currentTime) * intervalLength / 60.0;
+            } else {
+                score += d->timeFactor(QDateTime::fromSecsSinceEpoch(end), currentTime) * intervalLength / 60.0;
 
+            }
         }
     }
 
@@ -236,13 +210,11 @@ void ResourceScoreCache::update()
 
     // Updating the score
 
-    Utils::exec(*resourcesDatabase(), Utils::FailOnError, Queries::self().updateResourceScoreCacheQuery,
-        ":usedActivity", d->activity,
-        ":initiatingAgent", d->application,
-        ":targettedResource", d->resource,
-        ":cachedScore", score,
-        ":lastUpdate", lastEventStart
-    );
+    ResourceScoreStore::self()->update(key, {
+        score,
+        uint(firstUpdate.toSecsSinceEpoch()),
+        lastEventStart
+    });
 
     // Notifying the world
     qCDebug(KAMD_LOG_RESOURCES) << "ResourceScoreUpdated:"
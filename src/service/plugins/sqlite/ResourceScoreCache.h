@@ -21,16 +21,17 @@
 #define PLUGINS_SQLITE_RESOURCE_SCORE_CACHE_H
 
 // Qt
+#include <QDateTime>
 #include <QString>
 
 // Utils
 #include <utils/d_ptr.h>
 
 /**
- * ResourceScoreCache handles the persistence of the usage ratings for
- * the resources.
+ * ResourceScoreCache contains the logic to update the usage rating
+ * (score) of a single resource.
  *
- * It contains the logic to update the score of a single resource.
+ * The scores themselves are kept by ResourceScoreStore.
  */
 class ResourceScoreCache {
 public:
@@ -40,6 +41,13 @@ public:
 
     void update();
 
+    /**
+     * How much a score has decayed between the two moments. The scores
+     * are not updated until the resource is used again, this needs to be
+     * applied to the stored score to get the current one.
+     */
+    static qreal timeFactor(const QDateTime &fromTime, const QDateTime &toTime);
+
 private:
     D_PTR;
     class Queries;
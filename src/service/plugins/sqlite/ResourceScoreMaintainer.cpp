@@ -23,6 +23,7 @@
 // Qt
 #include <QList>
 #include <QMutex>
+#include <QVector>
 
 
 // System
@@ -35,6 +36,9 @@
 // Local
 #include "StatsPlugin.h"
 #include "ResourceScoreCache.h"
+#include "ResourceScoreStore.h"
+#include "../../EventTracing.h"
+#include "../../MemoryUsage.h"
 
 
 class ResourceScoreMaintainer::Private {
@@ -47,7 +51,8 @@ public:
 
     typedef QString ApplicationName;
     typedef QString ActivityID;
-    typedef QList<QString> ResourceList;
+    typedef QVector<quint64> TraceList;
+    typedef QHash<QString, TraceList> ResourceList;
 
     typedef QHash<ApplicationName, ResourceList> Applications;
     typedef QHash<ActivityID, Applications> ResourceTree;
@@ -70,6 +75,13 @@ void ResourceScoreMaintainer::Private::processResources()
 {
     using namespace kamd::utils;
 
+    // The scores need to be loaded before they can be updated,
+    // we will try again later
+    if (!ResourceScoreStore::self()->isLoaded()) {
+        processResourcesTimer.start();
+        return;
+    }
+
     // initial delay before processing the resources
     sleep(1);
 
@@ -92,6 +104,11 @@ void ResourceScoreMaintainer::Private::processResources()
             processActivity(activity, applications);
         }
     );
+
+    // The clients read the scores from ResourceScoreCache when they
+    // get the ResourceScoreUpdated signals queued above, so the batch
+    // needs to be written before they are delivered
+    ResourceScoreStore::self()->checkpoint();
 }
 
 void ResourceScoreMaintainer::Private::processActivity(const ActivityID
@@ -103,9 +120,25 @@ void ResourceScoreMaintainer::Private::processActivity(const ActivityID
 
     for_each_assoc(applications,
         [&](const ApplicationName &application, const ResourceList &resources) {
-            for (const auto &resource : resources) {
-                ResourceScoreCache(activity, application, resource).update();
-            }
+            for_each_assoc(resources,
+                [&](const QString &resource, const TraceList &traces) {
+                    ResourceScoreCache(activity, application, resource).update();
+
+                    for (const auto traceId: traces) {
+                        EventTracing::mark(traceId, EventTracing::ScoreUpdated);
+                    }
+
+                    if (traces.isEmpty()) return;
+
+                    // ResourceScoreUpdated is emitted through a queued
+                    // invocation, this one will be processed right after it
+                    QMetaObject::invokeMethod(StatsPlugin::self(), [traces] {
+                        for (const auto traceId: traces) {
+                            EventTracing::mark(traceId, EventTracing::ScoreAnnounced);
+                        }
+                    }, Qt::QueuedConnection);
+                }
+            );
         }
     );
 }
@@ -122,6 +155,34 @@ ResourceScoreMaintainer::ResourceScoreMaintainer()
     d->processResourcesTimer.setSingleShot(true);
     connect(&d->processResourcesTimer, &QTimer::timeout,
             this, [=] { d->processResources(); });
+
+    MemoryUsage::addReporter(QStringLiteral("sqlite"), QStringLiteral("scheduledScores"), this, [this] {
+        MemoryUsage::Usage usage { 0, MemoryUsage::bytes(d->scheduledResources) };
+
+        for_each_assoc(d->scheduledResources,
+            [&](const QString &activity, const Private::Applications &applications) {
+                usage.bytes += MemoryUsage::bytes(activity)
+                             + MemoryUsage::bytes(applications);
+
+                for_each_assoc(applications,
+                    [&](const QString &application, const Private::ResourceList &resources) {
+                        usage.entries += resources.size();
+                        usage.bytes += MemoryUsage::bytes(application)
+                                     + MemoryUsage::bytes(resources);
+
+                        for_each_assoc(resources,
+                            [&](const QString &resource, const Private::TraceList &traces) {
+                                usage.bytes += MemoryUsage::bytes(resource)
+                                             + traces.capacity() * sizeof(quint64);
+                            }
+                        );
+                    }
+                );
+            }
+        );
+
+        return usage;
+    });
 }
 
 ResourceScoreMaintainer::~ResourceScoreMaintainer()
@@ -129,11 +190,9 @@ ResourceScoreMaintainer::~ResourceScoreMaintainer()
 }
 
 void ResourceScoreMaintainer::processResource(const QString &resource,
-                                              const QString &application)
+                                              const QString &application,
+                                              quint64 traceId)
 {
-    // Checking whether the item is already scheduled for
-    // processing
-
     const auto activity = StatsPlugin::self()->currentActivity();
 
     Q_ASSERT_X(!application.isEmpty(),
@@ -143,14 +202,13 @@ void ResourceScoreMaintainer::processResource(const QString &resource,
                "ResourceScoreMaintainer::processResource",
                "Resource should not be empty");
 
-    if (d->scheduledResources.contains(activity)
-        && d->scheduledResources[activity].contains(application)
-        && d->scheduledResources[activity][application].contains(resource)) {
-
-        // Nothing
+    // If the item is already scheduled, we only need to remember
+    // the trace of the event
+    auto &traces = d->scheduledResources[activity][application][resource];
 
-    } else {
-        d->scheduledResources[activity][application] << resource;
+    if (traceId) {
+        traces << traceId;
+        EventTracing::mark(traceId, EventTracing::ScoreScheduled);
     }
 
     d->processResourcesTimer.start();
@@ -37,7 +37,12 @@ public:
 
     ~ResourceScoreMaintainer() override;
 
-    void processResource(const QString &resource, const QString &application);
+    /**
+     * Schedules the score of the resource to be updated. The trace id
+     * of the event that caused the update is used for the EventTracing
+     */
+    void processResource(const QString &resource, const QString &application,
+                         quint64 traceId = 0);
 
 private:
     ResourceScoreMaintainer();
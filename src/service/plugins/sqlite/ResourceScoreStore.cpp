@@ -0,0 +1,325 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Self
+#include <kactivities-features.h>
+#include "ResourceScoreStore.h"
+
+// Qt
+#include <QCoreApplication>
+#include <QDateTime>
+#include <QHash>
+#include <QSet>
+#include <QSqlQuery>
+#include <QThread>
+#include <QTimer>
+
+// STL
+#include <algorithm>
+#include <memory>
+
+// Utils
+#include <utils/d_ptr_implementation.h>
+
+// Local
+#include "DebugResources.h"
+#include "Database.h"
+#include "ResourceScoreCache.h"
+#include "Utils.h"
+#include "../../MemoryUsage.h"
+
+#include <common/database/schema/ResourcesDatabaseStatements.h>
+
+uint qHash(const ResourceScoreStore::Key &key, uint seed)
+{
+    return qHash(key.activity, seed)
+         ^ qHash(key.agent, seed + 1)
+         ^ qHash(key.resource, seed + 2);
+}
+
+namespace {
+    // How often the changed scores are written to the database
+    const int checkpointInterval = 30 * 1000;
+
+    typedef QHash<ResourceScoreStore::Key, ResourceScoreStore::Entry> Entries;
+
+    // Reads the whole ResourceScoreCache table. It uses its own
+    // read-only connection since the connections can not be shared
+    // between threads.
+    class ScoreLoader: public QThread {
+    public:
+        explicit ScoreLoader(QObject *parent)
+            : QThread(parent)
+        {
+        }
+
+        void run() override
+        {
+            auto database = Common::Database::instance(
+                    Common::Database::ResourcesDatabase,
+                    Common::Database::ReadOnly);
+
+            if (!database) {
+                return;
+            }
+
+            auto query = database->execQuery(QStringLiteral(
+                    "SELECT usedActivity, initiatingAgent, targettedResource, "
+                    "cachedScore, firstUpdate, lastUpdate "
+                    "FROM ResourceScoreCache"));
+
+            while (query.next()) {
+                entries.insert(
+                    { query.value(0).toString(), query.value(1).toString(),
+                      query.value(2).toString() },
+                    { query.value(3).toDouble(), query.value(4).toUInt(),
+                      query.value(5).toUInt() });
+            }
+        }
+
+        Entries entries;
+    };
+} // namespace
+
+class ResourceScoreStore::Private {
+public:
+    Private()
+        : loaded(false)
+        , loader(nullptr)
+    {
+    }
+
+    void loadFinished();
+    void scheduleCheckpoint();
+
+    bool loaded;
+    ScoreLoader *loader;
+
+    Entries entries;
+
+    // Entries that need to be written to the database
+    QSet<Key> dirty;
+
+    // Removals requested while the scores were being loaded
+    QVector<Predicate> pendingRemovals;
+
+    QTimer checkpointTimer;
+};
+
+void ResourceScoreStore::Private::loadFinished()
+{
+    qCDebug(KAMD_LOG_RESOURCES) << "Loaded" << loader->entries.size() << "scores";
+
+    // The entries updated in the meantime are newer
+    // than the ones from the database
+    for (auto it = loader->entries.cbegin(); it != loader->entries.cend(); ++it) {
+        if (!entries.contains(it.key())) {
+            entries.insert(it.key(), it.value());
+        }
+    }
+
+    loader->entries.clear();
+    loader->deleteLater();
+    loader = nullptr;
+
+    loaded = true;
+
+    for (const auto &predicate: pendingRemovals) {
+        ResourceScoreStore::self()->removeIf(predicate);
+    }
+    pendingRemovals.clear();
+}
+
+void ResourceScoreStore::Private::scheduleCheckpoint()
+{
+    if (!checkpointTimer.isActive()) {
+        checkpointTimer.start();
+    }
+}
+
+ResourceScoreStore *ResourceScoreStore::self()
+{
+    static ResourceScoreStore instance;
+    return &instance;
+}
+
+ResourceScoreStore::ResourceScoreStore()
+{
+    d->checkpointTimer.setInterval(checkpointInterval);
+    d->checkpointTimer.setSingleShot(true);
+    connect(&d->checkpointTimer, &QTimer::timeout,
+            this, [this] { checkpoint(); });
+
+    // We can not rely on the destructor of a static object,
+    // the database might already be gone by then
+    connect(QCoreApplication::instance(), &QCoreApplication::aboutToQuit,
+            this, [this] { checkpoint(); });
+
+    MemoryUsage::addReporter(QStringLiteral("sqlite"), QStringLiteral("scores"), this, [this] {
+        const auto keyBytes = [] (const Key &key) {
+            return MemoryUsage::bytes(key.activity)
+                 + MemoryUsage::bytes(key.agent)
+                 + MemoryUsage::bytes(key.resource);
+        };
+
+        quint64 bytes = MemoryUsage::bytes(d->entries)
+                      + MemoryUsage::bytes(d->dirty);
+
+        for (auto it = d->entries.cbegin(); it != d->entries.cend(); ++it) {
+            bytes += keyBytes(it.key());
+        }
+
+        return MemoryUsage::Usage { quint64(d->entries.size()), bytes };
+    });
+}
+
+ResourceScoreStore::~ResourceScoreStore()
+{
+    if (d->loader) {
+        d->loader->wait();
+    }
+}
+
+void ResourceScoreStore::load()
+{
+    if (d->loaded || d->loader) {
+        return;
+    }
+
+    d->loader = new ScoreLoader(this);
+    connect(d->loader, &QThread::finished,
+            this, [this] { d->loadFinished(); });
+    d->loader->start(QThread::LowPriority);
+}
+
+bool ResourceScoreStore::isLoaded() const
+{
+    return d->loaded;
+}
+
+bool ResourceScoreStore::find(const Key &key, Entry &entry) const
+{
+    const auto it = d->entries.constFind(key);
+
+    if (it == d->entries.cend()) {
+        return false;
+    }
+
+    entry = *it;
+    return true;
+}
+
+void ResourceScoreStore::update(const Key &key, const Entry &entry)
+{
+    d->entries[key] = entry;
+    d->dirty.insert(key);
+
+    d->scheduleCheckpoint();
+}
+
+void ResourceScoreStore::removeIf(const Predicate &predicate)
+{
+    if (!d->loaded) {
+        d->pendingRemovals << predicate;
+    }
+
+    for (auto it = d->entries.begin(); it != d->entries.end(); ) {
+        if (predicate(it.key(), it.value())) {
+            d->dirty.remove(it.key());
+            it = d->entries.erase(it);
+
+        } else {
+            ++it;
+        }
+    }
+}
+
+QVector<ResourceScoreStore::Score> ResourceScoreStore::topScores(
+        int count, const Predicate &predicate) const
+{
+    const auto now = QDateTime::currentDateTime();
+
+    // The scores are not updated until the resource is used again,
+    // they need to be decayed the same way ResourceScoreCache does it
+    auto currentScore = [now] (const Entry &entry) {
+        return entry.score * ResourceScoreCache::timeFactor(
+                QDateTime::fromSecsSinceEpoch(entry.lastUpdate), now);
+    };
+
+    QVector<Score> result;
+
+    for (auto it = d->entries.cbegin(); it != d->entries.cend(); ++it) {
+        if (predicate(it.key(), it.value())) {
+            result.append({ it.key(), it.value() });
+            result.last().entry.score = currentScore(it.value());
+        }
+    }
+
+    const auto byScore = [] (const Score &left, const Score &right) {
+        return left.entry.score > right.entry.score;
+    };
+
+    if (count >= 0 && count < result.size()) {
+        std::partial_sort(result.begin(), result.begin() + count, result.end(), byScore);
+        result.resize(count);
+
+    } else {
+        std::sort(result.begin(), result.end(), byScore);
+    }
+
+    return result;
+}
+
+void ResourceScoreStore::checkpoint()
+{
+    if (!d->loaded || d->dirty.isEmpty()) {
+        return;
+    }
+
+    auto database = resourcesDatabase();
+
+    if (!database) {
+        return;
+    }
+
+    qCDebug(KAMD_LOG_RESOURCES) << "Checkpointing the scores, changed:" << d->dirty.size();
+
+    static std::unique_ptr<QSqlQuery> saveScoreQuery;
+
+    Utils::prepare(*database, saveScoreQuery,
+                   Common::ResourcesDatabaseStatements::saveScore());
+
+    DATABASE_TRANSACTION(*database);
+
+    for (const auto &key: d->dirty) {
+        const auto &entry = d->entries[key];
+
+        Utils::exec(*database, Utils::FailOnError, *saveScoreQuery,
+            ":usedActivity", key.activity,
+            ":initiatingAgent", key.agent,
+            ":targettedResource", key.resource,
+            ":cachedScore", entry.score,
+            ":lastUpdate", entry.lastUpdate,
+            ":firstUpdate", entry.firstUpdate
+        );
+    }
+
+    d->dirty.clear();
+}
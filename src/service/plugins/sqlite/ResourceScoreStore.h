@@ -0,0 +1,130 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PLUGINS_SQLITE_RESOURCE_SCORE_STORE_H
+#define PLUGINS_SQLITE_RESOURCE_SCORE_STORE_H
+
+// Qt
+#include <QObject>
+#include <QString>
+#include <QVector>
+
+// STL
+#include <functional>
+
+// Utils
+#include <utils/d_ptr.h>
+
+/**
+ * ResourceScoreStore keeps the contents of the ResourceScoreCache table
+ * in memory, and it is authoritative for them while the daemon runs.
+ *
+ * The table is loaded in the background at startup. The changed entries
+ * are written back (checkpointed) in a single transaction, so the score
+ * updates do not need to read from the database, nor to write each
+ * entry separately. ResourceScoreMaintainer checkpoints after each batch
+ * of updates, before the ResourceScoreUpdated signals for them are
+ * delivered, since the clients read the scores from the table. The other
+ * changes are checkpointed periodically and at shutdown.
+ *
+ * The removed entries are not written back. The rows are deleted
+ * by whoever removes the scores (the stats deletion jobs
+ * and DeleteStatsForResource), in chunks if there are many of them.
+ */
+class ResourceScoreStore: public QObject {
+    Q_OBJECT
+
+public:
+    struct Key {
+        QString activity;
+        QString agent;
+        QString resource;
+
+        bool operator==(const Key &other) const
+        {
+            return activity == other.activity
+                && agent    == other.agent
+                && resource == other.resource;
+        }
+    };
+
+    struct Entry {
+        double score;
+        uint firstUpdate;
+        uint lastUpdate;
+    };
+
+    struct Score {
+        Key key;
+        Entry entry;
+    };
+
+    typedef std::function<bool(const Key &key, const Entry &entry)> Predicate;
+
+    static ResourceScoreStore *self();
+
+    ~ResourceScoreStore() override;
+
+    /**
+     * Starts loading the scores from the database in the background
+     */
+    void load();
+
+    bool isLoaded() const;
+
+    /**
+     * Returns the entry for the key, if it exists
+     */
+    bool find(const Key &key, Entry &entry) const;
+
+    /**
+     * Creates or updates the entry
+     */
+    void update(const Key &key, const Entry &entry);
+
+    /**
+     * Removes the entries that match the predicate from memory. The caller
+     * needs to delete the corresponding rows from the database. If the
+     * scores are still being loaded, the predicate is applied to them
+     * once they are.
+     */
+    void removeIf(const Predicate &predicate);
+
+    /**
+     * Returns the entries with the highest scores
+     * (for the current time) that match the predicate
+     */
+    QVector<Score> topScores(int count, const Predicate &predicate) const;
+
+    /**
+     * Writes the changed entries to the database
+     */
+    void checkpoint();
+
+private:
+    ResourceScoreStore();
+
+    D_PTR;
+};
+
+uint qHash(const ResourceScoreStore::Key &key, uint seed = 0);
+
+#endif // PLUGINS_SQLITE_RESOURCE_SCORE_STORE_H
@@ -0,0 +1,234 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Self
+#include <kactivities-features.h>
+#include "ResourceStatsDeletion.h"
+
+// Qt
+#include <QQueue>
+#include <QSqlQuery>
+#include <QTimer>
+
+// STL
+#include <memory>
+
+// Utils
+#include <utils/d_ptr_implementation.h>
+
+// Common
+#include <common/database/schema/ResourcesDatabaseStatements.h>
+
+// Local
+#include "DebugResources.h"
+#include "Database.h"
+#include "ResourceEventPartitions.h"
+#include "Utils.h"
+
+namespace {
+    // Number of rowids covered by a single chunk
+    const qint64 rowsPerChunk = 2000;
+} // namespace
+
+ResourceStatsDeletion::Step ResourceStatsDeletion::Step::deleteRows(
+        const QString &table, const QString &condition, const QVariantHash &values)
+{
+    return Step { DeleteRows, table, condition, values };
+}
+
+ResourceStatsDeletion::Step ResourceStatsDeletion::Step::dropPartition(
+        const QString &partition)
+{
+    return Step { DropPartition, partition, QString(), QVariantHash() };
+}
+
+class ResourceStatsDeletion::Private {
+public:
+    struct Job {
+        uint id;
+        QVector<Step> steps;
+        std::function<void()> finished;
+    };
+
+    Private(ResourceStatsDeletion *parent)
+        : q(parent)
+        , lastJobId(0)
+    {
+        resetStep();
+    }
+
+    void processChunk();
+    bool startStep(const Step &step);
+    bool deleteChunk(const Step &step);
+    void resetStep();
+
+    ResourceStatsDeletion *const q;
+
+    uint lastJobId;
+    QQueue<Job> jobs;
+
+    // The state of the step that is currently being executed
+    int currentStep;
+    bool stepStarted;
+    qint64 firstRowId;
+    qint64 nextRowId;
+    qint64 lastRowId;
+    std::unique_ptr<QSqlQuery> deleteQuery;
+
+    QTimer chunkTimer;
+};
+
+void ResourceStatsDeletion::Private::resetStep()
+{
+    currentStep = 0;
+    stepStarted = false;
+    firstRowId = nextRowId = lastRowId = 0;
+    deleteQuery.reset();
+}
+
+bool ResourceStatsDeletion::Private::startStep(const Step &step)
+{
+    // The table might have been dropped in the meantime
+    // if it was an event partition
+    auto rangeQuery = resourcesDatabase()->createQuery();
+    rangeQuery.prepare(QStringLiteral(
+            "SELECT min(rowid), max(rowid) FROM %1").arg(step.table));
+
+    if (!Utils::exec(*resourcesDatabase(), Utils::IgnoreError, rangeQuery)
+            || !rangeQuery.next() || rangeQuery.value(0).isNull()) {
+        return false;
+    }
+
+    firstRowId = nextRowId = rangeQuery.value(0).toLongLong();
+    lastRowId = rangeQuery.value(1).toLongLong();
+    rangeQuery.finish();
+
+    deleteQuery.reset(new QSqlQuery(resourcesDatabase()->createQuery()));
+    deleteQuery->prepare(
+            Common::ResourcesDatabaseStatements::deleteChunk(step.table, step.condition));
+
+    stepStarted = true;
+    return true;
+}
+
+bool ResourceStatsDeletion::Private::deleteChunk(const Step &step)
+{
+    DATABASE_TRANSACTION(*resourcesDatabase());
+
+    for (auto it = step.values.cbegin(); it != step.values.cend(); ++it) {
+        deleteQuery->bindValue(it.key(), it.value());
+    }
+
+    deleteQuery->bindValue(QStringLiteral(":firstRowId"), nextRowId);
+    deleteQuery->bindValue(QStringLiteral(":lastRowId"), nextRowId + rowsPerChunk);
+
+    if (!Utils::exec(*resourcesDatabase(), Utils::IgnoreError, *deleteQuery)) {
+        qCWarning(KAMD_LOG_RESOURCES) << "Failed to delete the stats from"
+                                      << step.table << deleteQuery->lastError();
+        return false;
+    }
+
+    nextRowId += rowsPerChunk;
+    return nextRowId <= lastRowId;
+}
+
+void ResourceStatsDeletion::Private::processChunk()
+{
+    if (jobs.isEmpty()) {
+        return;
+    }
+
+    auto &job = jobs.head();
+
+    if (currentStep < job.steps.size()) {
+        const auto &step = job.steps[currentStep];
+        bool stepFinished = true;
+
+        if (step.type == Step::DropPartition) {
+            ResourceEventPartitions::self()->dropPartition(step.table);
+
+        } else if (stepStarted || startStep(step)) {
+            stepFinished = !deleteChunk(step);
+        }
+
+        double stepProgress = 1.0;
+
+        if (stepFinished) {
+            deleteQuery.reset();
+            stepStarted = false;
+            ++currentStep;
+
+        } else {
+            stepProgress = double(nextRowId - firstRowId)
+                           / (lastRowId - firstRowId + 1);
+        }
+
+        // The final progress is reported once the job is finished
+        if (currentStep < job.steps.size()) {
+            emit q->progress(job.id, (currentStep + (stepFinished ? 0 : stepProgress))
+                                          / job.steps.size());
+        }
+
+    } else {
+        qCDebug(KAMD_LOG_RESOURCES) << "Deletion job finished:" << job.id;
+
+        const auto finishedJob = jobs.dequeue();
+        resetStep();
+
+        emit q->progress(finishedJob.id, 1.0);
+
+        if (finishedJob.finished) {
+            finishedJob.finished();
+        }
+    }
+
+    if (!jobs.isEmpty()) {
+        chunkTimer.start();
+    }
+}
+
+ResourceStatsDeletion::ResourceStatsDeletion(QObject *parent)
+    : QObject(parent)
+    , d(this)
+{
+    // Yielding to the event loop between the chunks
+    d->chunkTimer.setInterval(0);
+    d->chunkTimer.setSingleShot(true);
+    connect(&d->chunkTimer, &QTimer::timeout,
+            this, [=] { d->processChunk(); });
+}
+
+ResourceStatsDeletion::~ResourceStatsDeletion()
+{
+}
+
+uint ResourceStatsDeletion::schedule(const QVector<Step> &steps,
+                                     const std::function<void()> &finished)
+{
+    const auto id = ++d->lastJobId;
+
+    qCDebug(KAMD_LOG_RESOURCES) << "Scheduling the deletion job:" << id
+                                << "steps:" << steps.size();
+
+    d->jobs.enqueue(Private::Job { id, steps, finished });
+    d->chunkTimer.start();
+
+    return id;
+}
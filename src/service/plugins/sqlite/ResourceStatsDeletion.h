@@ -0,0 +1,98 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PLUGINS_SQLITE_RESOURCE_STATS_DELETION_H
+#define PLUGINS_SQLITE_RESOURCE_STATS_DELETION_H
+
+// Qt
+#include <QObject>
+#include <QString>
+#include <QVariantHash>
+#include <QVector>
+
+// STL
+#include <functional>
+
+// Utils
+#include <utils/d_ptr.h>
+
+/**
+ * ResourceStatsDeletion runs the bulk deletions of the recorded stats
+ * as background jobs.
+ *
+ * Each job is a list of steps. The rows are deleted in bounded rowid
+ * ranges, each chunk in its own transaction, returning to the event
+ * loop in between so that the new events can still be recorded and
+ * the D-Bus calls answered. The jobs are processed one at a time,
+ * in the order in which they were scheduled.
+ */
+class ResourceStatsDeletion: public QObject {
+    Q_OBJECT
+
+public:
+    struct Step {
+        enum Type {
+            DeleteRows,
+            DropPartition
+        };
+
+        /**
+         * Deletes the rows of the table that match the condition,
+         * the values are bound to the placeholders in it
+         */
+        static Step deleteRows(const QString &table,
+                               const QString &condition = QString(),
+                               const QVariantHash &values = QVariantHash());
+
+        /**
+         * Drops the event partition, see ResourceEventPartitions
+         */
+        static Step dropPartition(const QString &partition);
+
+        Type type;
+        QString table;
+        QString condition;
+        QVariantHash values;
+    };
+
+    explicit ResourceStatsDeletion(QObject *parent = nullptr);
+    ~ResourceStatsDeletion() override;
+
+    /**
+     * Schedules the deletion job.
+     * @returns the id of the job
+     * @arg finished called once all the steps have been executed
+     */
+    uint schedule(const QVector<Step> &steps,
+                  const std::function<void()> &finished);
+
+Q_SIGNALS:
+    /**
+     * Reports the progress of a job, from 0 to 1.
+     * The progress of 1 means the job has finished.
+     */
+    void progress(uint job, double progress);
+
+private:
+    D_PTR;
+};
+
+#endif // PLUGINS_SQLITE_RESOURCE_STATS_DELETION_H
@@ -0,0 +1,943 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Self
+#include <kactivities-features.h>
+#include "ResourcesDatabaseExport.h"
+
+// Qt
+#include <QByteArray>
+#include <QFile>
+#include <QSaveFile>
+#include <QSqlQuery>
+#include <QVector>
+#include <QtEndian>
+
+// STL
+#include <cstring>
+
+// Local
+#include "DebugResources.h"
+#include "Database.h"
+#include "ResourceEventPartitions.h"
+#include "ResourceScoreStore.h"
+#include "Utils.h"
+
+#include <common/database/schema/ResourcesDatabaseSchema.h>
+
+namespace ResourcesDatabaseExport {
+
+namespace {
+    const char magic[] = "KAMDEXP";
+    const char formatVersion = 1;
+
+    enum Section {
+        EndOfFile   = 0,
+        Events      = 1,
+        DailyEvents = 2,
+        Scores      = 3,
+        Links       = 4,
+        Info        = 5,
+        FocusDaily  = 6,
+        EditStats   = 7
+    };
+
+    // Bits of the first field of the records
+    enum RecordFlags {
+        SameActivity = 1,
+        SameAgent    = 2,
+        SameResource = 4,
+        NullValue    = 8 // the optional value of the record is NULL
+    };
+
+    const int flushSize = 1024 * 1024;
+
+    class Writer {
+    public:
+        explicit Writer(QSaveFile &file)
+            : m_file(file)
+            , m_ok(true)
+        {
+            m_buffer.reserve(flushSize + 4096);
+        }
+
+        void writeVarint(quint64 value)
+        {
+            while (value >= 0x80) {
+                m_record.append(char(value | 0x80));
+                value >>= 7;
+            }
+            m_record.append(char(value));
+        }
+
+        void writeSigned(qint64 value)
+        {
+            writeVarint((quint64(value) << 1) ^ quint64(value >> 63));
+        }
+
+        void writeString(const QString &value)
+        {
+            const auto utf8 = value.toUtf8();
+            writeVarint(quint64(utf8.size()));
+            m_record.append(utf8);
+        }
+
+        void writeDouble(double value)
+        {
+            quint64 bits;
+            std::memcpy(&bits, &value, sizeof(bits));
+
+            char bytes[sizeof(bits)];
+            qToLittleEndian(bits, bytes);
+            m_record.append(bytes, sizeof(bytes));
+        }
+
+        // Writes the activity, agent and resource, skipping
+        // the ones that are the same as in the previous record
+        void writeTriple(const QString &activity, const QString &agent,
+                         const QString &resource, quint64 flags = 0)
+        {
+            if (activity == m_activity) flags |= SameActivity;
+            if (agent    == m_agent)    flags |= SameAgent;
+            if (resource == m_resource) flags |= SameResource;
+
+            writeVarint(flags);
+            if (!(flags & SameActivity)) writeString(m_activity = activity);
+            if (!(flags & SameAgent))    writeString(m_agent    = agent);
+            if (!(flags & SameResource)) writeString(m_resource = resource);
+        }
+
+        void beginSection(Section section)
+        {
+            writeVarint(section);
+            endRecord(false);
+
+            m_activity.clear();
+            m_agent.clear();
+            m_resource.clear();
+        }
+
+        void endSection()
+        {
+            // Empty record
+            writeVarint(0);
+            endRecord(false);
+        }
+
+        void endRecord(bool lengthPrefixed = true)
+        {
+            if (lengthPrefixed) {
+                const auto record = m_record;
+                m_record.clear();
+                writeVarint(quint64(record.size()));
+                m_record.append(record);
+            }
+
+            m_buffer.append(m_record);
+            m_record.clear();
+
+            if (m_buffer.size() >= flushSize) {
+                flush();
+            }
+        }
+
+        bool flush()
+        {
+            if (m_ok && !m_buffer.isEmpty()) {
+                m_ok = m_file.write(m_buffer) == m_buffer.size();
+            }
+
+            m_buffer.clear();
+            return m_ok;
+        }
+
+    private:
+        QSaveFile &m_file;
+        bool m_ok;
+
+        QByteArray m_buffer;
+        QByteArray m_record;
+
+        QString m_activity;
+        QString m_agent;
+        QString m_resource;
+    };
+
+    class Reader {
+    public:
+        Reader(const uchar *begin, const uchar *end)
+            : m_pos(begin)
+            , m_end(end)
+            , m_ok(true)
+        {
+        }
+
+        bool ok() const { return m_ok; }
+        bool atEnd() const { return m_pos >= m_end; }
+
+        quint64 readVarint()
+        {
+            quint64 result = 0;
+
+            for (int shift = 0; shift < 64; shift += 7) {
+                if (m_pos >= m_end) {
+                    break;
+                }
+
+                const uchar byte = *m_pos++;
+                result |= quint64(byte & 0x7f) << shift;
+
+                if (!(byte & 0x80)) {
+                    return result;
+                }
+            }
+
+            m_ok = false;
+            return 0;
+        }
+
+        qint64 readSigned()
+        {
+            const auto value = readVarint();
+            return qint64(value >> 1) ^ -qint64(value & 1);
+        }
+
+        QString readString()
+        {
+            const auto size = readVarint();
+
+            if (!m_ok || size > quint64(m_end - m_pos)) {
+                m_ok = false;
+                return QString();
+            }
+
+            const auto result = QString::fromUtf8(reinterpret_cast<const char *>(m_pos), int(size));
+            m_pos += size;
+            return result;
+        }
+
+        double readDouble()
+        {
+            if (m_end - m_pos < 8) {
+                m_ok = false;
+                return 0;
+            }
+
+            const quint64 bits = qFromLittleEndian<quint64>(m_pos);
+            m_pos += 8;
+
+            double result;
+            std::memcpy(&result, &bits, sizeof(result));
+            return result;
+        }
+
+        quint64 readTriple()
+        {
+            const auto flags = readVarint();
+            if (!(flags & SameActivity)) m_activity = readString();
+            if (!(flags & SameAgent))    m_agent    = readString();
+            if (!(flags & SameResource)) m_resource = readString();
+            return flags;
+        }
+
+        const QString &activity() const { return m_activity; }
+        const QString &agent() const    { return m_agent; }
+        const QString &resource() const { return m_resource; }
+
+        // Returns a reader for the next record, an empty one
+        // means the end of the section
+        Reader nextRecord()
+        {
+            const auto size = readVarint();
+
+            if (!m_ok || size > quint64(m_end - m_pos)) {
+                m_ok = false;
+                return Reader(m_end, m_end);
+            }
+
+            Reader record(m_pos, m_pos + size);
+            m_pos += size;
+
+            // The strings that are the same as in the previous
+            // record are not stored in the record
+            record.m_activity = m_activity;
+            record.m_agent    = m_agent;
+            record.m_resource = m_resource;
+
+            return record;
+        }
+
+        void finishRecord(const Reader &record)
+        {
+            m_activity = record.m_activity;
+            m_agent    = record.m_agent;
+            m_resource = record.m_resource;
+
+            if (!record.ok()) {
+                m_ok = false;
+            }
+        }
+
+        void resetTriple()
+        {
+            m_activity.clear();
+            m_agent.clear();
+            m_resource.clear();
+        }
+
+    private:
+        const uchar *m_pos;
+        const uchar *m_end;
+        bool m_ok;
+
+        QString m_activity;
+        QString m_agent;
+        QString m_resource;
+    };
+
+    // The query needs to be forward-only not to have Qt
+    // keep all the results in memory
+    QSqlQuery streamingQuery(const QString &queryString)
+    {
+        auto query = resourcesDatabase()->createQuery();
+        query.setForwardOnly(true);
+        query.prepare(queryString);
+        Utils::exec(*resourcesDatabase(), Utils::FailOnError, query);
+        return query;
+    }
+
+    void exportEvents(Writer &writer)
+    {
+        writer.beginSection(Events);
+
+        // The start times are relative to the previous event
+        qint64 previousStart = 0;
+
+        // The partitions are sorted by time, so the events are sorted
+        // by the (month, activity, agent, resource, start) key. Sorting
+        // by the index of the partition does not need a temporary b-tree
+        for (const auto &partition: ResourceEventPartitions::self()->partitions()) {
+            auto query = streamingQuery(QStringLiteral(
+                    "SELECT usedActivity, initiatingAgent, targettedResource, start, end "
+                    "FROM %1 "
+                    "ORDER BY usedActivity, initiatingAgent, targettedResource, start"
+                ).arg(partition));
+
+            while (query.next()) {
+                const auto start = query.value(3).toLongLong();
+                const auto end = query.value(4);
+
+                writer.writeTriple(query.value(0).toString(), query.value(1).toString(),
+                                   query.value(2).toString(),
+                                   end.isNull() ? NullValue : 0);
+
+                writer.writeSigned(start - previousStart);
+                if (!end.isNull()) {
+                    writer.writeSigned(end.toLongLong() - start);
+                }
+                writer.endRecord();
+
+                previousStart = start;
+            }
+        }
+
+        writer.endSection();
+    }
+
+    void exportDailyEvents(Writer &writer)
+    {
+        writer.beginSection(DailyEvents);
+
+        auto query = streamingQuery(QStringLiteral(
+                "SELECT usedActivity, initiatingAgent, targettedResource, day, "
+                "eventCount, accessCount, totalDuration "
+                "FROM ResourceEventDaily "
+                "ORDER BY usedActivity, initiatingAgent, targettedResource, day"));
+
+        qint64 previousDay = 0;
+
+        while (query.next()) {
+            const auto day = query.value(3).toLongLong();
+
+            writer.writeTriple(query.value(0).toString(), query.value(1).toString(),
+                               query.value(2).toString());
+            writer.writeSigned(day - previousDay);
+            writer.writeVarint(query.value(4).toULongLong());
+            writer.writeVarint(query.value(5).toULongLong());
+            writer.writeVarint(query.value(6).toULongLong());
+            writer.endRecord();
+
+            previousDay = day;
+        }
+
+        writer.endSection();
+    }
+
+    void exportFocusTime(Writer &writer)
+    {
+        writer.beginSection(FocusDaily);
+
+        auto query = streamingQuery(QStringLiteral(
+                "SELECT usedActivity, initiatingAgent, targettedResource, day, "
+                "focusCount, focusDuration "
+                "FROM ResourceFocusDaily "
+                "ORDER BY usedActivity, initiatingAgent, targettedResource, day"));
+
+        qint64 previousDay = 0;
+
+        while (query.next()) {
+            const auto day = query.value(3).toLongLong();
+
+            writer.writeTriple(query.value(0).toString(), query.value(1).toString(),
+                               query.value(2).toString());
+            writer.writeSigned(day - previousDay);
+            writer.writeVarint(query.value(4).toULongLong());
+            writer.writeVarint(query.value(5).toULongLong());
+            writer.endRecord();
+
+            previousDay = day;
+        }
+
+        writer.endSection();
+    }
+
+    void exportEditStats(Writer &writer)
+    {
+        writer.beginSection(EditStats);
+
+        auto query = streamingQuery(QStringLiteral(
+                "SELECT usedActivity, initiatingAgent, targettedResource, "
+                "editCount, lastEdit "
+                "FROM ResourceEditStats "
+                "ORDER BY usedActivity, initiatingAgent, targettedResource, day"));
+
+        // The day is not written, it is the day of the last edit
+        while (query.next()) {
+            writer.writeTriple(query.value(0).toString(), query.value(1).toString(),
+                               query.value(2).toString());
+            writer.writeVarint(query.value(3).toULongLong());
+            writer.writeSigned(query.value(4).toLongLong());
+            writer.endRecord();
+        }
+
+        writer.endSection();
+    }
+
+    void exportScores(Writer &writer)
+    {
+        writer.beginSection(Scores);
+
+        auto query = streamingQuery(QStringLiteral(
+                "SELECT usedActivity, initiatingAgent, targettedResource, "
+                "cachedScore, firstUpdate, lastUpdate "
+                "FROM ResourceScoreCache "
+                "ORDER BY usedActivity, initiatingAgent, targettedResource"));
+
+        while (query.next()) {
+            writer.writeTriple(query.value(0).toString(), query.value(1).toString(),
+                               query.value(2).toString());
+            writer.writeDouble(query.value(3).toDouble());
+            writer.writeSigned(query.value(4).toLongLong());
+            writer.writeSigned(query.value(5).toLongLong());
+            writer.endRecord();
+        }
+
+        writer.endSection();
+    }
+
+    void exportLinks(Writer &writer)
+    {
+        writer.beginSection(Links);
+
+        auto query = streamingQuery(QStringLiteral(
+                "SELECT usedActivity, initiatingAgent, targettedResource "
+                "FROM ResourceLink "
+                "ORDER BY usedActivity, initiatingAgent, targettedResource"));
+
+        while (query.next()) {
+            writer.writeTriple(query.value(0).toString(), query.value(1).toString(),
+                               query.value(2).toString());
+            writer.endRecord();
+        }
+
+        writer.endSection();
+    }
+
+    void exportInfo(Writer &writer)
+    {
+        writer.beginSection(Info);
+
+        auto query = streamingQuery(QStringLiteral(
+                "SELECT targettedResource, title, mimetype, autoTitle, autoMimetype "
+                "FROM ResourceInfo "
+                "ORDER BY targettedResource"));
+
+        while (query.next()) {
+            // The title and the mime type are both optional,
+            // we are storing them with the NullValue flag
+            const auto title = query.value(1);
+            const auto mimetype = query.value(2);
+
+            writer.writeVarint((title.isNull() ? 1 : 0) | (mimetype.isNull() ? 2 : 0));
+            writer.writeString(query.value(0).toString());
+            if (!title.isNull())    writer.writeString(title.toString());
+            if (!mimetype.isNull()) writer.writeString(mimetype.toString());
+            writer.writeVarint(query.value(3).toULongLong());
+            writer.writeVarint(query.value(4).toULongLong());
+            writer.endRecord();
+        }
+
+        writer.endSection();
+    }
+
+    // The file is read twice. The first pass only checks that all
+    // the records can be read, the second one writes them. This way
+    // a broken file does not leave a partial import behind.
+    enum Pass {
+        Validate,
+        Import
+    };
+
+    bool importEvents(Reader &reader, Pass pass)
+    {
+        auto partitions = ResourceEventPartitions::self();
+
+        QString partition;
+        qint64 partitionStart = 0;
+        qint64 partitionEnd = 0;
+        QSqlQuery *insertQuery = nullptr;
+
+        // The start times are relative to the previous event
+        qint64 previousStart = 0;
+
+        for (auto record = reader.nextRecord(); !record.atEnd(); record = reader.nextRecord()) {
+            const auto flags = record.readTriple();
+            const auto start = previousStart + record.readSigned();
+            const auto end = (flags & NullValue) ? QVariant()
+                                                 : QVariant(start + record.readSigned());
+
+            reader.finishRecord(record);
+            if (!reader.ok()) {
+                return false;
+            }
+
+            if (pass == Import) {
+                // The export is sorted by month, so we need to look up
+                // the partition only when the month changes
+                if (!insertQuery || start < partitionStart || start >= partitionEnd) {
+                    partition = partitions->partitionFor(start);
+                    partitionStart = Common::ResourcesDatabaseSchema::eventPartitionStart(partition);
+                    partitionEnd = Common::ResourcesDatabaseSchema::eventPartitionEnd(partition);
+                    insertQuery = &partitions->query(partition, QStringLiteral(
+                        "INSERT INTO %1"
+                        "        (usedActivity,  initiatingAgent,  targettedResource,  start,  end) "
+                        "VALUES (:usedActivity, :initiatingAgent, :targettedResource, :start, :end)"
+                    ));
+                }
+
+                if (!Utils::exec(*resourcesDatabase(), Utils::FailOnError, *insertQuery,
+                    ":usedActivity"      , reader.activity(),
+                    ":initiatingAgent"   , reader.agent(),
+                    ":targettedResource" , reader.resource(),
+                    ":start"             , start,
+                    ":end"               , end
+                )) {
+                    return false;
+                }
+            }
+
+            previousStart = start;
+        }
+
+        return reader.ok();
+    }
+
+    bool importDailyEvents(Reader &reader, Pass pass)
+    {
+        auto query = resourcesDatabase()->createQuery();
+        query.prepare(QStringLiteral(
+            "INSERT OR REPLACE INTO ResourceEventDaily "
+            "    (usedActivity, initiatingAgent, targettedResource, day, "
+            "     eventCount, accessCount, totalDuration) "
+            "VALUES (:usedActivity, :initiatingAgent, :targettedResource, :day, "
+            "        :eventCount, :accessCount, :totalDuration)"));
+
+        qint64 previousDay = 0;
+
+        for (auto record = reader.nextRecord(); !record.atEnd(); record = reader.nextRecord()) {
+            record.readTriple();
+            const auto day = previousDay + record.readSigned();
+            const auto eventCount = record.readVarint();
+            const auto accessCount = record.readVarint();
+            const auto totalDuration = record.readVarint();
+
+            reader.finishRecord(record);
+            if (!reader.ok()) {
+                return false;
+            }
+
+            if (pass == Import) {
+                if (!Utils::exec(*resourcesDatabase(), Utils::FailOnError, query,
+                    ":usedActivity"      , reader.activity(),
+                    ":initiatingAgent"   , reader.agent(),
+                    ":targettedResource" , reader.resource(),
+                    ":day"               , day,
+                    ":eventCount"        , eventCount,
+                    ":accessCount"       , accessCount,
+                    ":totalDuration"     , totalDuration
+                )) {
+                    return false;
+                }
+            }
+
+            previousDay = day;
+        }
+
+        return reader.ok();
+    }
+
+    bool importFocusTime(Reader &reader, Pass pass)
+    {
+        auto query = resourcesDatabase()->createQuery();
+        query.prepare(QStringLiteral(
+            "INSERT OR REPLACE INTO ResourceFocusDaily "
+            "    (usedActivity, initiatingAgent, targettedResource, day, "
+            "     focusCount, focusDuration) "
+            "VALUES (:usedActivity, :initiatingAgent, :targettedResource, :day, "
+            "        :focusCount, :focusDuration)"));
+
+        qint64 previousDay = 0;
+
+        for (auto record = reader.nextRecord(); !record.atEnd(); record = reader.nextRecord()) {
+            record.readTriple();
+            const auto day = previousDay + record.readSigned();
+            const auto focusCount = record.readVarint();
+            const auto focusDuration = record.readVarint();
+
+            reader.finishRecord(record);
+            if (!reader.ok()) {
+                return false;
+            }
+
+            if (pass == Import) {
+                if (!Utils::exec(*resourcesDatabase(), Utils::FailOnError, query,
+                    ":usedActivity"      , reader.activity(),
+                    ":initiatingAgent"   , reader.agent(),
+                    ":targettedResource" , reader.resource(),
+                    ":day"               , day,
+                    ":focusCount"        , focusCount,
+                    ":focusDuration"     , focusDuration
+                )) {
+                    return false;
+                }
+            }
+
+            previousDay = day;
+        }
+
+        return reader.ok();
+    }
+
+    bool importEditStats(Reader &reader, Pass pass)
+    {
+        auto query = resourcesDatabase()->createQuery();
+        query.prepare(QStringLiteral(
+            "INSERT OR REPLACE INTO ResourceEditStats "
+            "    (usedActivity, initiatingAgent, targettedResource, day, editCount, lastEdit) "
+            "VALUES (:usedActivity, :initiatingAgent, :targettedResource, "
+            "        :day, :editCount, :lastEdit)"));
+
+        for (auto record = reader.nextRecord(); !record.atEnd(); record = reader.nextRecord()) {
+            record.readTriple();
+            const auto editCount = record.readVarint();
+            const auto lastEdit = record.readSigned();
+
+            reader.finishRecord(record);
+            if (!reader.ok()) {
+                return false;
+            }
+
+            if (pass == Import) {
+                if (!Utils::exec(*resourcesDatabase(), Utils::FailOnError, query,
+                    ":usedActivity"      , reader.activity(),
+                    ":initiatingAgent"   , reader.agent(),
+                    ":targettedResource" , reader.resource(),
+                    ":day"               , (lastEdit / 86400) * 86400,
+                    ":editCount"         , editCount,
+                    ":lastEdit"          , lastEdit
+                )) {
+                    return false;
+                }
+            }
+        }
+
+        return reader.ok();
+    }
+
+    // The scores are kept in memory, and written to the database by the
+    // store. They are collected here and passed to the store only when
+    // the rest of the import has been written successfully.
+    bool importScores(Reader &reader, Pass pass, QVector<ResourceScoreStore::Score> &scores)
+    {
+        for (auto record = reader.nextRecord(); !record.atEnd(); record = reader.nextRecord()) {
+            record.readTriple();
+            const auto score = record.readDouble();
+            const auto firstUpdate = record.readSigned();
+            const auto lastUpdate = record.readSigned();
+
+            reader.finishRecord(record);
+            if (!reader.ok()) {
+                return false;
+            }
+
+            if (pass == Import) {
+                scores.append({ { reader.activity(), reader.agent(), reader.resource() },
+                                { score, uint(firstUpdate), uint(lastUpdate) } });
+            }
+        }
+
+        return reader.ok();
+    }
+
+    bool importLinks(Reader &reader, Pass pass)
+    {
+        auto query = resourcesDatabase()->createQuery();
+        query.prepare(QStringLiteral(
+            "INSERT OR IGNORE INTO ResourceLink "
+            "        (usedActivity,  initiatingAgent,  targettedResource) "
+            "VALUES (:usedActivity, :initiatingAgent, :targettedResource)"));
+
+        for (auto record = reader.nextRecord(); !record.atEnd(); record = reader.nextRecord()) {
+            record.readTriple();
+
+            reader.finishRecord(record);
+            if (!reader.ok()) {
+                return false;
+            }
+
+            if (pass == Import) {
+                if (!Utils::exec(*resourcesDatabase(), Utils::FailOnError, query,
+                    ":usedActivity"      , reader.activity(),
+                    ":initiatingAgent"   , reader.agent(),
+                    ":targettedResource" , reader.resource()
+                )) {
+                    return false;
+                }
+            }
+        }
+
+        return reader.ok();
+    }
+
+    bool importInfo(Reader &reader, Pass pass)
+    {
+        auto query = resourcesDatabase()->createQuery();
+        query.prepare(QStringLiteral(
+            "INSERT OR REPLACE INTO ResourceInfo "
+            "        (targettedResource,  title,  mimetype,  autoTitle,  autoMimetype) "
+            "VALUES (:targettedResource, :title, :mimetype, :autoTitle, :autoMimetype)"));
+
+        for (auto record = reader.nextRecord(); !record.atEnd(); record = reader.nextRecord()) {
+            const auto flags = record.readVarint();
+            const auto resource = record.readString();
+            const auto title = (flags & 1) ? QVariant() : QVariant(record.readString());
+            const auto mimetype = (flags & 2) ? QVariant() : QVariant(record.readString());
+            const auto autoTitle = record.readVarint();
+            const auto autoMimetype = record.readVarint();
+
+            if (!record.ok()) {
+                return false;
+            }
+
+            if (pass == Import) {
+                if (!Utils::exec(*resourcesDatabase(), Utils::FailOnError, query,
+                    ":targettedResource" , resource,
+                    ":title"             , title,
+                    ":mimetype"          , mimetype,
+                    ":autoTitle"         , autoTitle,
+                    ":autoMimetype"      , autoMimetype
+                )) {
+                    return false;
+                }
+            }
+        }
+
+        return reader.ok();
+    }
+
+    // Skips the records of an unknown section
+    bool skipSection(Reader &reader)
+    {
+        for (auto record = reader.nextRecord(); !record.atEnd(); record = reader.nextRecord()) {
+        }
+
+        return reader.ok();
+    }
+
+    bool importSections(const uchar *begin, const uchar *end, Pass pass,
+                        QVector<ResourceScoreStore::Score> &scores)
+    {
+        Reader reader(begin, end);
+
+        bool success = true;
+
+        for (auto section = reader.readVarint();
+                success && reader.ok() && section != EndOfFile;
+                section = reader.readVarint()) {
+
+            reader.resetTriple();
+
+            switch (section) {
+                case Events:      success = importEvents(reader, pass);      break;
+                case DailyEvents: success = importDailyEvents(reader, pass); break;
+                case FocusDaily:  success = importFocusTime(reader, pass);   break;
+                case EditStats:   success = importEditStats(reader, pass);   break;
+                case Scores:      success = importScores(reader, pass, scores); break;
+                case Links:       success = importLinks(reader, pass);       break;
+                case Info:        success = importInfo(reader, pass);        break;
+                default:          success = skipSection(reader);             break;
+            }
+        }
+
+        return success && reader.ok();
+    }
+} // namespace
+
+bool exportTo(const QString &path, const std::function<void()> &addPendingChanges)
+{
+    // The scores might not have been written to the database yet
+    ResourceScoreStore::self()->checkpoint();
+
+    QSaveFile file(path);
+
+    if (!file.open(QIODevice::WriteOnly)) {
+        qCWarning(KAMD_LOG_RESOURCES) << "Can not open the export file" << path;
+        return false;
+    }
+
+    file.write(magic, sizeof(magic) - 1);
+    file.write(&formatVersion, 1);
+
+    Writer writer(file);
+
+    // We want a consistent snapshot of the database
+    {
+        DATABASE_TRANSACTION(*resourcesDatabase());
+
+        if (addPendingChanges) {
+            addPendingChanges();
+        }
+
+        exportEvents(writer);
+        exportDailyEvents(writer);
+        exportFocusTime(writer);
+        exportEditStats(writer);
+        exportScores(writer);
+        exportLinks(writer);
+        exportInfo(writer);
+
+        // We were only reading, the pending changes
+        // are not meant to be stored yet
+        lock.rollback();
+    }
+
+    writer.writeVarint(EndOfFile);
+    writer.endRecord(false);
+
+    if (!writer.flush() || !file.commit()) {
+        qCWarning(KAMD_LOG_RESOURCES) << "Failed to write the export file" << path;
+        return false;
+    }
+
+    return true;
+}
+
+bool importFrom(const QString &path)
+{
+    // The scores are imported into the in-memory store
+    if (!ResourceScoreStore::self()->isLoaded()) {
+        qCWarning(KAMD_LOG_RESOURCES) << "Can not import while the scores are being loaded";
+        return false;
+    }
+
+    QFile file(path);
+
+    if (!file.open(QIODevice::ReadOnly)) {
+        qCWarning(KAMD_LOG_RESOURCES) << "Can not open the import file" << path;
+        return false;
+    }
+
+    const auto size = file.size();
+    const uchar *data = size > 0 ? file.map(0, size) : nullptr;
+
+    if (!data) {
+        qCWarning(KAMD_LOG_RESOURCES) << "Can not map the import file" << path;
+        return false;
+    }
+
+    const int headerSize = sizeof(magic);
+
+    if (size < headerSize
+            || std::memcmp(data, magic, sizeof(magic) - 1) != 0
+            || data[sizeof(magic) - 1] != formatVersion) {
+        qCWarning(KAMD_LOG_RESOURCES) << "Not a resources database export" << path;
+        return false;
+    }
+
+    QVector<ResourceScoreStore::Score> scores;
+
+    if (!importSections(data + headerSize, data + size, Validate, scores)) {
+        qCWarning(KAMD_LOG_RESOURCES) << "The import file is corrupted" << path;
+        return false;
+    }
+
+    bool imported = false;
+
+    {
+        DATABASE_TRANSACTION(*resourcesDatabase());
+
+        imported = importSections(data + headerSize, data + size, Import, scores);
+
+        if (!imported) {
+            lock.rollback();
+        }
+    }
+
+    if (!imported) {
+        // The rollback might have removed the partitions
+        // created for the imported events
+        ResourceEventPartitions::self()->reload();
+
+        qCWarning(KAMD_LOG_RESOURCES) << "Failed to write the import, nothing was imported" << path;
+        return false;
+    }
+
+    auto store = ResourceScoreStore::self();
+
+    for (const auto &score: scores) {
+        store->update(score.key, score.entry);
+    }
+
+    store->checkpoint();
+
+    return true;
+}
+
+} // namespace ResourcesDatabaseExport
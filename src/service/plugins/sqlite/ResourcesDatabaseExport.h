@@ -0,0 +1,79 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PLUGINS_SQLITE_RESOURCES_DATABASE_EXPORT_H
+#define PLUGINS_SQLITE_RESOURCES_DATABASE_EXPORT_H
+
+// Qt
+#include <QString>
+
+// STL
+#include <functional>
+
+/**
+ * Export and import of the resources database in a compact binary format.
+ *
+ * The file starts with the "KAMDEXP" magic and the format version byte,
+ * followed by sections. Each section starts with its id (a varint) and
+ * contains length-prefixed records, terminated by an empty record.
+ * The section id of zero marks the end of the file. The readers can
+ * skip the sections they do not know about.
+ *
+ * The integers are stored as varints (LEB128, zig-zag encoded when they
+ * can be negative), the strings as the varint length of the UTF-8 data
+ * followed by the data, and the doubles as 8 little-endian bytes.
+ *
+ * The records in each section are sorted by their key. The activity,
+ * agent and resource are stored only when they differ from the previous
+ * record -- the first field of each record is a bit set telling which
+ * of them are the same.
+ *
+ * The file is written sequentially, and read through a memory mapping.
+ */
+namespace ResourcesDatabaseExport {
+
+    /**
+     * Writes the events, the daily aggregates, the focus time, the edit
+     * sessions, scores, links and resource information into the
+     * specified file.
+     *
+     * The addPendingChanges function is called inside the transaction
+     * the export is read in. The changes it makes to the database are
+     * exported, and rolled back afterwards.
+     */
+    bool exportTo(const QString &path,
+                  const std::function<void()> &addPendingChanges = std::function<void()>());
+
+    /**
+     * Imports the data from the file into the current database,
+     * in a single transaction. The imported events are added to the
+     * existing ones, the existing scores and resource information
+     * are replaced by the imported ones.
+     *
+     * The whole file is checked before anything is written. If it is
+     * broken, or writing it fails, false is returned and the database
+     * is left unchanged.
+     */
+    bool importFrom(const QString &path);
+
+} // namespace ResourcesDatabaseExport
+
+#endif // PLUGINS_SQLITE_RESOURCES_DATABASE_EXPORT_H
@@ -0,0 +1,211 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+// Self
+#include <kactivities-features.h>
+#include "ResourcesDatabaseMaintenance.h"
+
+// Qt
+#include <QElapsedTimer>
+#include <QTimer>
+
+// Utils
+#include <utils/d_ptr_implementation.h>
+
+// Local
+#include "DebugResources.h"
+#include "Database.h"
+
+namespace {
+    // How long the database needs not to be written to
+    // for us to consider the daemon idle
+    const int idleInterval = 60 * 1000;
+
+    // Pause between the vacuum steps
+    const int stepInterval = 500;
+
+    // Number of pages reclaimed in one step
+    const int pagesPerStep = 200;
+
+    // How many reclaimed pages warrant refreshing the statistics
+    const qint64 analyzeAfterPages = 5000;
+
+    // How often we refresh the statistics regardless of the above
+    const qint64 analyzeInterval = 24 * 60 * 60 * 1000;
+} // namespace
+
+class ResourcesDatabaseMaintenance::Private {
+public:
+    Private()
+        : freePages(0)
+        , reclaimedPages(0)
+        , reclaimedPagesSinceAnalyze(0)
+        , pageSize(0)
+        , running(false)
+        , incrementalVacuum(-1)
+    {
+    }
+
+    void step();
+    void analyze();
+
+    qint64 freePages;
+    qint64 reclaimedPages;
+    qint64 reclaimedPagesSinceAnalyze;
+    qint64 pageSize;
+    bool running;
+
+    // Whether the database uses the incremental auto-vacuum,
+    // -1 until we check it
+    int incrementalVacuum;
+
+    QDateTime lastAnalyze;
+    QElapsedTimer sinceAnalyze;
+
+    QTimer maintenanceTimer;
+};
+
+void ResourcesDatabaseMaintenance::Private::step()
+{
+    auto database = resourcesDatabase();
+
+    if (!database) {
+        return;
+    }
+
+    if (pageSize == 0) {
+        pageSize = database->pragma(QStringLiteral("page_size")).toLongLong();
+    }
+
+    // The incremental_vacuum pragma does nothing on the databases
+    // created before the incremental auto-vacuum was introduced
+    if (incrementalVacuum == -1) {
+        incrementalVacuum =
+            database->pragma(QStringLiteral("auto_vacuum")).toInt() == 2 ? 1 : 0;
+    }
+
+    freePages = database->pragma(QStringLiteral("freelist_count")).toLongLong();
+
+    if (incrementalVacuum == 1 && freePages > 0) {
+        running = true;
+
+        // SQLite frees one page per step of the pragma,
+        // we need to go through all the (empty) results
+        auto query = database->execQuery(
+            QStringLiteral("PRAGMA incremental_vacuum(%1)").arg(pagesPerStep));
+        while (query.next()) {}
+        query.finish();
+
+        const auto remaining = database->pragma(QStringLiteral("freelist_count")).toLongLong();
+        const auto reclaimed = qMax(qint64(0), freePages - remaining);
+
+        reclaimedPages += reclaimed;
+        reclaimedPagesSinceAnalyze += reclaimed;
+        freePages = remaining;
+
+        qCDebug(KAMD_LOG_RESOURCES) << "Reclaimed" << reclaimed
+                                    << "database pages," << remaining << "left";
+
+        // If the vacuum did not get anywhere, there is no point
+        // in hammering the database
+        if (reclaimed > 0 && remaining > 0) {
+            maintenanceTimer.start(stepInterval);
+            return;
+        }
+    }
+
+    running = false;
+
+    if (reclaimedPagesSinceAnalyze >= analyzeAfterPages
+            || !sinceAnalyze.isValid()
+            || sinceAnalyze.hasExpired(analyzeInterval)) {
+        analyze();
+    }
+
+    // Checking again in a while, unless the events come in
+    maintenanceTimer.start(analyzeInterval);
+}
+
+void ResourcesDatabaseMaintenance::Private::analyze()
+{
+    qCDebug(KAMD_LOG_RESOURCES) << "Refreshing the database statistics";
+
+    resourcesDatabase()->execQuery(QStringLiteral("ANALYZE"));
+
+    reclaimedPagesSinceAnalyze = 0;
+    lastAnalyze = QDateTime::currentDateTime();
+    sinceAnalyze.start();
+}
+
+ResourcesDatabaseMaintenance::ResourcesDatabaseMaintenance(QObject *parent)
+    : QObject(parent)
+{
+    d->maintenanceTimer.setSingleShot(true);
+    connect(&d->maintenanceTimer, &QTimer::timeout,
+            this, [=] { d->step(); });
+
+    // We do not want to analyze the database on each startup
+    d->sinceAnalyze.start();
+
+    d->maintenanceTimer.start(idleInterval);
+}
+
+ResourcesDatabaseMaintenance::~ResourcesDatabaseMaintenance()
+{
+}
+
+void ResourcesDatabaseMaintenance::postpone()
+{
+    // Restarting the timer, the maintenance is continued
+    // when there are no new events for a while
+    if (d->running || d->maintenanceTimer.remainingTime() < idleInterval) {
+        d->maintenanceTimer.start(idleInterval);
+    }
+}
+
+void ResourcesDatabaseMaintenance::scheduleMaintenance()
+{
+    d->maintenanceTimer.start(idleInterval);
+}
+
+qint64 ResourcesDatabaseMaintenance::freePages() const
+{
+    return d->freePages;
+}
+
+qint64 ResourcesDatabaseMaintenance::reclaimedPages() const
+{
+    return d->reclaimedPages;
+}
+
+qint64 ResourcesDatabaseMaintenance::reclaimedBytes() const
+{
+    return d->reclaimedPages * d->pageSize;
+}
+
+bool ResourcesDatabaseMaintenance::isRunning() const
+{
+    return d->running;
+}
+
+QDateTime ResourcesDatabaseMaintenance::lastAnalyze() const
+{
+    return d->lastAnalyze;
+}
@@ -0,0 +1,77 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef PLUGINS_SQLITE_RESOURCES_DATABASE_MAINTENANCE_H
+#define PLUGINS_SQLITE_RESOURCES_DATABASE_MAINTENANCE_H
+
+// Qt
+#include <QObject>
+#include <QDateTime>
+
+// Utils
+#include <utils/d_ptr.h>
+
+/**
+ * ResourcesDatabaseMaintenance reclaims the free pages of the database
+ * file while the daemon is idle.
+ *
+ * The database uses the incremental auto-vacuum, so the pages freed
+ * by deleting the events are reclaimed a few hundred at a time,
+ * returning to the event loop in between. After a bigger cleanup,
+ * or once a day, the query planner statistics are refreshed with ANALYZE.
+ *
+ * The databases created before the incremental auto-vacuum was
+ * introduced are left as they are. Converting them would need a full
+ * VACUUM, which blocks the database for a long time and temporarily
+ * needs twice its size on the disk. Only the statistics are refreshed
+ * for them.
+ */
+class ResourcesDatabaseMaintenance: public QObject {
+    Q_OBJECT
+
+public:
+    explicit ResourcesDatabaseMaintenance(QObject *parent = nullptr);
+    ~ResourcesDatabaseMaintenance() override;
+
+    /**
+     * Notifies the maintenance task that the database is being used,
+     * it will wait for the daemon to become idle again.
+     */
+    void postpone();
+
+    /**
+     * Schedules the maintenance to be run as soon as the daemon is idle.
+     * Meant to be called after a big chunk of data has been deleted.
+     */
+    void scheduleMaintenance();
+
+    // Metrics
+    qint64 freePages() const;
+    qint64 reclaimedPages() const;
+    qint64 reclaimedBytes() const;
+    bool isRunning() const;
+    QDateTime lastAnalyze() const;
+
+private:
+    D_PTR;
+};
+
+#endif // PLUGINS_SQLITE_RESOURCES_DATABASE_MAINTENANCE_H
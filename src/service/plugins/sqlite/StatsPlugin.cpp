@@ -33,30 +33,78 @@
 
 // Boost
 #include <boost/range/algorithm/binary_search.hpp>
+#include <algorithm>
 #include <utils/range.h>
 
+// SQLite
+#include <sqlite3.h>
+
 // Local
 #include "Database.h"
 #include "ResourceScoreMaintainer.h"
 #include "ResourceLinking.h"
+#include "ResourceEventPartitions.h"
+#include "ResourceEventRollup.h"
+#include "ResourceFocusTime.h"
+#include "ResourceEditTracker.h"
+#include "ResourcesDatabaseMaintenance.h"
+#include "ResourceStatsDeletion.h"
+#include "QueryStatistics.h"
+#include "ResourceScoreStore.h"
+#include "ResourcesDatabaseExport.h"
 #include "Utils.h"
 #include "../../Event.h"
+#include "../../EventTracing.h"
+#include "../../MemoryUsage.h"
 #include "resourcescoringadaptor.h"
 #include "common/specialvalues.h"
 
+#include <common/database/schema/ResourcesDatabaseStatements.h>
+
+namespace Statements = Common::ResourcesDatabaseStatements;
+
 KAMD_EXPORT_PLUGIN(sqliteplugin, StatsPlugin, "kactivitymanagerd-plugin-sqlite.json")
 
 StatsPlugin *StatsPlugin::s_instance = nullptr;
 
+namespace {
+    // The deletion steps for the tables derived from the events,
+    // the event partitions are handled separately
+    QVector<ResourceStatsDeletion::Step> deleteDerivedStatsSteps(
+            const Statements::DeletionFilters &filters, const QVariantHash &values)
+    {
+        using Step = ResourceStatsDeletion::Step;
+
+        return {
+            Step::deleteRows(QStringLiteral("ResourceEventDaily"), filters.dailyEvents, values),
+            Step::deleteRows(QStringLiteral("ResourceFocusDaily"), filters.focusDaily, values),
+            Step::deleteRows(QStringLiteral("ResourceEditStats"), filters.editStats, values),
+            Step::deleteRows(QStringLiteral("ResourceScoreCache"), filters.scores, values)
+        };
+    }
+} // namespace
+
 StatsPlugin::StatsPlugin(QObject *parent, const QVariantList &args)
     : Plugin(parent)
     , m_activities(nullptr)
     , m_resources(nullptr)
     , m_resourceLinking(new ResourceLinking(this))
+    , m_eventRollup(new ResourceEventRollup(this))
+    , m_focusTime(new ResourceFocusTime(this))
+    , m_editTracker(new ResourceEditTracker(this))
+    , m_maintenance(new ResourcesDatabaseMaintenance(this))
+    , m_statsDeletion(new ResourceStatsDeletion(this))
+    , m_knownResourcesLoaded(false)
 {
     Q_UNUSED(args);
     s_instance = this;
 
+    connect(m_statsDeletion, &ResourceStatsDeletion::progress,
+            this, &StatsPlugin::StatsDeletionProgress);
+
+    // Exposes the SQL statement latencies as the "stats" module
+    new QueryStatistics(this);
+
     new ResourcesScoringAdaptor(this);
     QDBusConnection::sessionBus().registerObject(
         QStringLiteral("/ActivityManager/Resources/Scoring"), this);
@@ -87,8 +135,50 @@ bool StatsPlugin::init(QHash<QString, QObject *> &modules)
     connect(modules[QStringLiteral("config")], SIGNAL(pluginConfigChanged()),
             this, SLOT(loadConfiguration()));
 
+    // For people who do not restart their computers, we should delete
+    // the old events from time to time. Doing this twice a day should
+    // be more than enough.
+    m_deleteOldEventsTimer.setInterval(12 * 60 * 60 * 1000);
+    connect(&m_deleteOldEventsTimer, &QTimer::timeout,
+            this, &StatsPlugin::deleteOldEvents);
+    m_deleteOldEventsTimer.start();
+
+    MemoryUsage::addReporter(QStringLiteral("sqlite"), QStringLiteral("knownResources"), this, [this] {
+        quint64 bytes = m_knownResources.capacity() * sizeof(QString);
+        for (const auto &resource: m_knownResources) {
+            bytes += MemoryUsage::bytes(resource);
+        }
+
+        return MemoryUsage::Usage { quint64(m_knownResources.size()), bytes };
+    });
+
+    // The page cache and the prepared statements of all the connections.
+    // The counters belong to the SQLite library we are linked against,
+    // they say nothing when the Qt driver uses its own copy of SQLite
+    if (sqliteHandle(*resourcesDatabase())) {
+        MemoryUsage::addReporter(QStringLiteral("sqlite"), QStringLiteral("heap"), this, [] {
+            int allocations = 0;
+            int highwater = 0;
+            sqlite3_status(SQLITE_STATUS_MALLOC_COUNT, &allocations, &highwater, 0);
+
+            return MemoryUsage::Usage { quint64(allocations), quint64(sqlite3_memory_used()) };
+        });
+    }
+
     loadConfiguration();
 
+    // The scores are served from memory, we need to load them first
+    ResourceScoreStore::self()->load();
+
+    // The backup of the database is not needed for the daemon to work,
+    // so we are creating it once the startup is over
+    auto backup = new ResourcesDatabaseBackup(this);
+    connect(backup, &ResourcesDatabaseBackup::backupFinished,
+            this, &StatsPlugin::DatabaseBackupFinished);
+    QTimer::singleShot(10 * 1000, backup, [backup] {
+        backup->start(QThread::IdlePriority);
+    });
+
     return true;
 }
 
@@ -116,13 +206,18 @@ void StatsPlugin::loadConfiguration()
         m_apps.insert(apps.cbegin(), apps.cend());
     }
 
+    // Statements taking longer than this (in milliseconds) are logged
+    QueryStatistics::setSlowQueryThreshold(conf.readEntry("slow-query-threshold", 250));
+
+    // Events older than this (in days) are aggregated per day
+    m_eventRollup->setRollupAge(conf.readEntry("roll-up-events-after", 90));
+
+    // Modifications closer than this (in seconds) to each other
+    // are counted as a single edit session
+    m_editTracker->setQuietPeriod(conf.readEntry("edit-quiet-period", 60));
+
     // Delete old events, as per configuration.
-    // For people who do not restart their computers, we should do this from
-    // time to time. Doing this twice a day should be more than enough.
     deleteOldEvents();
-    m_deleteOldEventsTimer.setInterval(12 * 60 * 60 * 1000);
-    connect(&m_deleteOldEventsTimer, &QTimer::timeout,
-            this, &StatsPlugin::deleteOldEvents);
 
     // Loading URL filters
     m_urlFilters.clear();
@@ -144,7 +239,15 @@ void StatsPlugin::loadConfiguration()
 
 void StatsPlugin::deleteOldEvents()
 {
-    DeleteEarlierStats(QString(), config().readEntry("keep-history-for", 0));
+    // Whatever is left and old enough can be rolled up
+    // once the old events are gone
+    const auto job = deleteEarlierStats(QString(), config().readEntry("keep-history-for", 0),
+                                        [this] { m_eventRollup->scheduleRollup(); });
+
+    if (job == 0) {
+        m_eventRollup->scheduleRollup();
+        m_maintenance->scheduleMaintenance();
+    }
 }
 
 void StatsPlugin::openResourceEvent(const QString &usedActivity,
@@ -165,13 +268,12 @@ void StatsPlugin::openResourceEvent(const QString &usedActivity,
 
     detectResourceInfo(targettedResource);
 
-    Utils::prepare(*resourcesDatabase(), openResourceEventQuery, QStringLiteral(
-        "INSERT INTO ResourceEvent"
-        "        (usedActivity,  initiatingAgent,  targettedResource,  start,  end) "
-        "VALUES (:usedActivity, :initiatingAgent, :targettedResource, :start, :end)"
-    ));
+    auto partitions = ResourceEventPartitions::self();
+    auto &openResourceEventQuery = partitions->query(
+        partitions->partitionFor(start.toSecsSinceEpoch()),
+        Statements::openResourceEvent());
 
-    Utils::exec(*resourcesDatabase(), Utils::FailOnError, *openResourceEventQuery,
+    Utils::exec(*resourcesDatabase(), Utils::FailOnError, openResourceEventQuery,
         ":usedActivity"      , usedActivity      ,
         ":initiatingAgent"   , initiatingAgent   ,
         ":targettedResource" , targettedResource ,
@@ -195,22 +297,19 @@ void StatsPlugin::closeResourceEvent(const QString &usedActivity,
                "StatsPlugin::closeResourceEvent",
                "Resource should not be empty");
 
-    Utils::prepare(*resourcesDatabase(), closeResourceEventQuery, QStringLiteral(
-        "UPDATE ResourceEvent "
-        "SET end = :end "
-        "WHERE "
-            ":usedActivity      = usedActivity AND "
-            ":initiatingAgent   = initiatingAgent AND "
-            ":targettedResource = targettedResource AND "
-            "end IS NULL"
-    ));
-
-    Utils::exec(*resourcesDatabase(), Utils::FailOnError, *closeResourceEventQuery,
-        ":usedActivity"      , usedActivity      ,
-        ":initiatingAgent"   , initiatingAgent   ,
-        ":targettedResource" , targettedResource ,
-        ":end"               , end.toSecsSinceEpoch()
-    );
+    // The event could have been opened in any of the previous months
+    auto partitions = ResourceEventPartitions::self();
+    for (const auto &partition: partitions->partitions()) {
+        auto &closeResourceEventQuery =
+            partitions->query(partition, Statements::closeResourceEvent());
+
+        Utils::exec(*resourcesDatabase(), Utils::FailOnError, closeResourceEventQuery,
+            ":usedActivity"      , usedActivity      ,
+            ":initiatingAgent"   , initiatingAgent   ,
+            ":targettedResource" , targettedResource ,
+            ":end"               , end.toSecsSinceEpoch()
+        );
+    }
 }
 
 void StatsPlugin::detectResourceInfo(const QString &_uri)
@@ -236,33 +335,21 @@ void StatsPlugin::detectResourceInfo(const QString &_uri)
 bool StatsPlugin::insertResourceInfo(const QString &uri)
 {
 
-    Utils::prepare(*resourcesDatabase(), getResourceInfoQuery, QStringLiteral(
-        "SELECT targettedResource FROM ResourceInfo WHERE "
-            "  targettedResource = :targettedResource "
-    ));
+    Utils::prepare(*resourcesDatabase(), getResourceInfoQuery,
+                   Statements::getResourceInfo());
 
     getResourceInfoQuery->bindValue(":targettedResource", uri);
     Utils::exec(*resourcesDatabase(), Utils::FailOnError, *getResourceInfoQuery);
 
-    if (getResourceInfoQuery->next()) {
+    const bool exists = getResourceInfoQuery->next();
+    getResourceInfoQuery->finish();
+
+    if (exists) {
         return false;
     }
 
-    Utils::prepare(*resourcesDatabase(), insertResourceInfoQuery, QStringLiteral(
-        "INSERT INTO ResourceInfo( "
-            "  targettedResource"
-            ", title"
-            ", autoTitle"
-            ", mimetype"
-            ", autoMimetype"
-        ") VALUES ("
-            "  :targettedResource"
-            ", '' "
-            ", 1 "
-            ", '' "
-            ", 1 "
-        ")"
-    ));
+    Utils::prepare(*resourcesDatabase(), insertResourceInfoQuery,
+                   Statements::insertResourceInfo());
 
     Utils::exec(*resourcesDatabase(), Utils::FailOnError, *insertResourceInfoQuery,
         ":targettedResource", uri
@@ -274,17 +361,12 @@ bool StatsPlugin::insertResourceInfo(const QString &uri)
 void StatsPlugin::saveResourceTitle(const QString &uri, const QString &title,
                                     bool autoTitle)
 {
-    insertResourceInfo(uri);
-
     DATABASE_TRANSACTION(*resourcesDatabase());
 
-    Utils::prepare(*resourcesDatabase(), saveResourceTitleQuery, QStringLiteral(
-        "UPDATE ResourceInfo SET "
-            "  title = :title"
-            ", autoTitle = :autoTitle "
-        "WHERE "
-            "targettedResource = :targettedResource "
-    ));
+    insertResourceInfo(uri);
+
+    Utils::prepare(*resourcesDatabase(), saveResourceTitleQuery,
+                   Statements::saveResourceTitle());
 
     Utils::exec(*resourcesDatabase(), Utils::FailOnError, *saveResourceTitleQuery,
         ":targettedResource" , uri                     ,
@@ -297,17 +379,12 @@ void StatsPlugin::saveResourceMimetype(const QString &uri,
                                        const QString &mimetype,
                                        bool autoMimetype)
 {
-    insertResourceInfo(uri);
-
     DATABASE_TRANSACTION(*resourcesDatabase());
 
-    Utils::prepare(*resourcesDatabase(), saveResourceMimetypeQuery, QStringLiteral(
-        "UPDATE ResourceInfo SET "
-            "  mimetype = :mimetype"
-            ", autoMimetype = :autoMimetype "
-        "WHERE "
-            "targettedResource = :targettedResource "
-    ));
+    insertResourceInfo(uri);
+
+    Utils::prepare(*resourcesDatabase(), saveResourceMimetypeQuery,
+                   Statements::saveResourceMimetype());
 
     Utils::exec(*resourcesDatabase(), Utils::FailOnError, *saveResourceMimetypeQuery,
         ":targettedResource" , uri                        ,
@@ -324,10 +401,6 @@ StatsPlugin *StatsPlugin::self()
 
 bool StatsPlugin::acceptedEvent(const Event &event)
 {
-    using std::bind;
-    using std::any_of;
-    using namespace std::placeholders;
-
     return !(
         // If the URI is empty, we do not want to process it
         event.uri.isEmpty() ||
@@ -336,8 +409,7 @@ bool StatsPlugin::acceptedEvent(const Event &event)
         m_otrActivities.contains(currentActivity()) ||
 
         // Exclude URIs that match the ignored patterns
-        any_of(m_urlFilters.cbegin(), m_urlFilters.cend(),
-               bind(&QRegExp::exactMatch, _1, event.uri)) ||
+        Common::matchesAnyFilter(m_urlFilters, event.uri) ||
 
         // if blocked by default, the list contains allowed applications
         //     ignore event if the list doesn't contain the application
@@ -382,6 +454,12 @@ void StatsPlugin::addEvents(const EventList &events)
 {
     using namespace kamd::utils;
 
+    // The events that are not accepted are never finished,
+    // EventTracing forgets them after a while
+    for (const auto &event: events) {
+        EventTracing::mark(event.traceId, EventTracing::Received);
+    }
+
     if (m_blockAll || m_whatToRemember == NoApplications) {
         return;
     }
@@ -392,77 +470,143 @@ void StatsPlugin::addEvents(const EventList &events)
 
     if (eventsToProcess.begin() == eventsToProcess.end()) return;
 
-    DATABASE_TRANSACTION(*resourcesDatabase());
+    // We are not idle any more
+    m_maintenance->postpone();
 
-    for (auto event : eventsToProcess) {
+    // The events whose scores need to be updated
+    QVector<Event> scoredEvents;
 
-        switch (event.type) {
-            case Event::Accessed:
-                openResourceEvent(
-                    currentActivity(), event.application, event.uri,
-                    event.timestamp, event.timestamp);
-                ResourceScoreMaintainer::self()->processResource(
-                    event.uri, event.application);
+    {
+        DATABASE_TRANSACTION(*resourcesDatabase());
 
-                break;
+        for (auto event : eventsToProcess) {
 
-            case Event::Opened:
-                openResourceEvent(
-                    currentActivity(), event.application, event.uri,
-                    event.timestamp);
+            // Each of the events below ends up in one of the tables
+            // the stats are deleted from, be it the events, the focus
+            // time, the edit sessions or the scores
+            rememberResource(event.uri);
 
-                break;
+            switch (event.type) {
+                case Event::Accessed:
+                    openResourceEvent(
+                        currentActivity(), event.application, event.uri,
+                        event.dateTime(), event.dateTime());
+                    scoredEvents << event;
 
-            case Event::Closed:
-                closeResourceEvent(
-                    currentActivity(), event.application, event.uri,
-                    event.timestamp);
-                ResourceScoreMaintainer::self()->processResource(
-                    event.uri, event.application);
+                    break;
 
-                break;
+                case Event::Opened:
+                    openResourceEvent(
+                        currentActivity(), event.application, event.uri,
+                        event.dateTime());
 
-            case Event::UserEventType:
-                ResourceScoreMaintainer::self()->processResource(
-                    event.uri, event.application);
-                break;
+                    break;
 
-            default:
-                // Nothing yet
-                // TODO: Add focus and modification
-                break;
+                case Event::Closed:
+                    closeResourceEvent(
+                        currentActivity(), event.application, event.uri,
+                        event.dateTime());
+                    scoredEvents << event;
+
+                    // The FocussedOut event might have been lost
+                    m_focusTime->focusOut(event.application, event.uri,
+                                          event.timestamp);
+
+                    m_editTracker->closed(
+                        { currentActivity(), event.application, event.uri });
+
+                    break;
+
+                case Event::Modified:
+                    m_editTracker->modified(
+                        { currentActivity(), event.application, event.uri },
+                        event.timestamp);
+
+                    break;
+
+                case Event::FocussedIn:
+                    m_focusTime->focusIn(
+                        { currentActivity(), event.application, event.uri },
+                        event.timestamp);
+
+                    break;
+
+                case Event::FocussedOut:
+                    m_focusTime->focusOut(event.application, event.uri,
+                                          event.timestamp);
+
+                    break;
+
+                case Event::UserEventType:
+                    scoredEvents << event;
+                    break;
+
+                default:
+                    // Nothing yet
+                    break;
+            }
+
+            EventTracing::mark(event.traceId, EventTracing::Stored);
+
+            // The trace ends here if the score is not going to be updated
+            if (scoredEvents.isEmpty()
+                    || scoredEvents.constLast().traceId != event.traceId) {
+                EventTracing::finish(event.traceId);
+            }
         }
     }
+
+    for (const auto &event: scoredEvents) {
+        ResourceScoreMaintainer::self()->processResource(
+            event.uri, event.application, event.traceId);
+    }
 }
 
-void StatsPlugin::DeleteRecentStats(const QString &activity, int count,
+uint StatsPlugin::DeleteRecentStats(const QString &activity, int count,
                                     const QString &what)
 {
+    using Step = ResourceStatsDeletion::Step;
+
     const auto usedActivity = activity.isEmpty() ? QVariant()
                                                  : QVariant(activity);
 
+    auto partitions = ResourceEventPartitions::self();
+
+    QVector<Step> steps;
+    QVariantHash values;
+    Statements::DeletionFilters filters;
+    ResourceScoreStore::Predicate removedScores;
+
     // If we need to delete everything,
     // no need to bother with the count and the date
 
-    DATABASE_TRANSACTION(*resourcesDatabase());
-
     if (what == QStringLiteral("everything")) {
-        // Instantiating these every time is not a big overhead
-        // since this method is rarely executed.
-
-        auto removeEventsQuery = resourcesDatabase()->createQuery();
-        removeEventsQuery.prepare(
-                "DELETE FROM ResourceEvent "
-                "WHERE usedActivity = COALESCE(:usedActivity, usedActivity)"
-            );
-
-        auto removeScoreCachesQuery = resourcesDatabase()->createQuery();
-        removeScoreCachesQuery.prepare(
-                "DELETE FROM ResourceScoreCache "
-                "WHERE usedActivity = COALESCE(:usedActivity, usedActivity)");
+        values = {
+            { QStringLiteral(":usedActivity"), usedActivity }
+        };
+
+        removedScores = [activity] (const ResourceScoreStore::Key &key,
+                                    const ResourceScoreStore::Entry &) {
+            return activity.isEmpty() || key.activity == activity;
+        };
+
+        filters = Statements::deleteActivityFilters();
+
+        if (activity.isEmpty()) {
+            // Dropping a big table would block the database for
+            // a long time, so we are emptying it in chunks first
+            for (const auto &partition: partitions->partitions()) {
+                steps << Step::deleteRows(partition)
+                      << Step::dropPartition(partition);
+            }
+
+        } else {
+            for (const auto &partition: partitions->partitions()) {
+                steps << Step::deleteRows(partition, filters.events, values);
+            }
+        }
 
-        Utils::exec(*resourcesDatabase(), Utils::FailOnError, removeEventsQuery, ":usedActivity", usedActivity);
-        Utils::exec(*resourcesDatabase(), Utils::FailOnError, removeScoreCachesQuery, ":usedActivity", usedActivity);
+        steps << deleteDerivedStatsSteps(filters, values);
 
     } else {
 
@@ -475,76 +619,130 @@ void StatsPlugin::DeleteRecentStats(const QString &activity, int count,
               : (what[0] == QLatin1Char('m')) ? since.addMonths(-count)
               : since;
 
+        values = {
+            { QStringLiteral(":usedActivity"), usedActivity },
+            { QStringLiteral(":since"), since.toSecsSinceEpoch() }
+        };
+
+        removedScores = [activity, since = since.toSecsSinceEpoch()] (
+                const ResourceScoreStore::Key &key,
+                const ResourceScoreStore::Entry &entry) {
+            return (activity.isEmpty() || key.activity == activity)
+                && entry.firstUpdate > since;
+        };
+
         // Maybe we should decrease the scores for the previously
         // cached items. Thinking it is not that important -
         // if something was accessed before, and the user did not
         // remove the history, it is not really a secret.
 
-        auto removeEventsQuery = resourcesDatabase()->createQuery();
-        removeEventsQuery.prepare(
-                "DELETE FROM ResourceEvent "
-                "WHERE usedActivity = COALESCE(:usedActivity, usedActivity) "
-                "AND end > :since"
-            );
-
-        auto removeScoreCachesQuery = resourcesDatabase()->createQuery();
-        removeScoreCachesQuery.prepare(
-                "DELETE FROM ResourceScoreCache "
-                "WHERE usedActivity = COALESCE(:usedActivity, usedActivity) "
-                "AND firstUpdate > :since");
+        filters = Statements::deleteRecentFilters();
 
-        Utils::exec(*resourcesDatabase(), Utils::FailOnError, removeEventsQuery,
-                ":usedActivity", usedActivity,
-                ":since", since.toSecsSinceEpoch()
-            );
+        // We are checking when the events ended, and they could
+        // have been started at any time before that
+        for (const auto &partition: partitions->partitions()) {
+            steps << Step::deleteRows(partition, filters.events, values);
+        }
 
-        Utils::exec(*resourcesDatabase(), Utils::FailOnError, removeScoreCachesQuery,
-                ":usedActivity", usedActivity,
-                ":since", since.toSecsSinceEpoch()
-            );
+        steps << deleteDerivedStatsSteps(filters, values);
     }
 
-    emit RecentStatsDeleted(activity, count, what);
+    // The scores are kept in memory. They are removed again once the
+    // job is done, in case they were updated in the meantime
+    ResourceScoreStore::self()->removeIf(removedScores);
+
+    // The focus time that was not saved yet is recent enough
+    // to be removed in any case
+    m_focusTime->discardIf([activity] (const ResourceFocusTime::Key &key) {
+        return activity.isEmpty() || key.activity == activity;
+    });
+    m_editTracker->discardIf([activity] (const ResourceEditTracker::Key &key) {
+        return activity.isEmpty() || key.activity == activity;
+    });
+
+    return m_statsDeletion->schedule(steps, [=] {
+        removeScores(removedScores, filters.scores, values);
+
+        // The deleted events have left free pages in the database
+        m_maintenance->scheduleMaintenance();
+
+        emit RecentStatsDeleted(activity, count, what);
+    });
+}
+
+uint StatsPlugin::DeleteEarlierStats(const QString &activity, int months)
+{
+    return deleteEarlierStats(activity, months, [=] {
+        emit EarlierStatsDeleted(activity, months);
+    });
 }
 
-void StatsPlugin::DeleteEarlierStats(const QString &activity, int months)
+uint StatsPlugin::deleteEarlierStats(const QString &activity, int months,
+                                     const std::function<void()> &finished)
 {
+    using Step = ResourceStatsDeletion::Step;
+
     if (months == 0) {
-        return;
+        return 0;
     }
 
     // Deleting a specified length of time
 
-    DATABASE_TRANSACTION(*resourcesDatabase());
-
-    const auto time = QDateTime::currentDateTime().addMonths(-months);
+    const auto time = QDateTime::currentDateTime().addMonths(-months).toSecsSinceEpoch();
     const auto usedActivity = activity.isEmpty() ? QVariant()
                                                  : QVariant(activity);
 
-    auto removeEventsQuery = resourcesDatabase()->createQuery();
-    removeEventsQuery.prepare(
-            "DELETE FROM ResourceEvent "
-            "WHERE usedActivity = COALESCE(:usedActivity, usedActivity) "
-            "AND start < :time"
-        );
+    const QVariantHash values {
+        { QStringLiteral(":usedActivity"), usedActivity },
+        { QStringLiteral(":time"), time }
+    };
 
-    auto removeScoreCachesQuery = resourcesDatabase()->createQuery();
-    removeScoreCachesQuery.prepare(
-            "DELETE FROM ResourceScoreCache "
-            "WHERE usedActivity = COALESCE(:usedActivity, usedActivity) "
-            "AND lastUpdate < :time");
+    auto partitions = ResourceEventPartitions::self();
 
-    Utils::exec(*resourcesDatabase(), Utils::FailOnError, removeEventsQuery,
-            ":usedActivity", usedActivity,
-            ":time", time.toSecsSinceEpoch()
-        );
+    const auto expiredPartitions = partitions->partitionsBefore(time);
 
-    Utils::exec(*resourcesDatabase(), Utils::FailOnError, removeScoreCachesQuery,
-            ":usedActivity", usedActivity,
-            ":time", time.toSecsSinceEpoch()
-        );
+    const auto filters = Statements::deleteEarlierFilters();
+
+    QVector<Step> steps;
+
+    for (const auto &partition: partitions->partitions()) {
+        if (activity.isEmpty() && expiredPartitions.contains(partition)) {
+            // The partitions that contain only the old events do not need
+            // to be searched, they can be removed as a whole. They are
+            // emptied in chunks first not to block the database
+            steps << Step::deleteRows(partition)
+                  << Step::dropPartition(partition);
+
+        } else {
+            if (Common::ResourcesDatabaseSchema::eventPartitionStart(partition) >= time) {
+                break;
+            }
 
-    emit EarlierStatsDeleted(activity, months);
+            steps << Step::deleteRows(partition, filters.events, values);
+        }
+    }
+
+    steps << deleteDerivedStatsSteps(filters, values);
+
+    const ResourceScoreStore::Predicate removedScores =
+        [activity, time] (const ResourceScoreStore::Key &key,
+                          const ResourceScoreStore::Entry &entry) {
+            return (activity.isEmpty() || key.activity == activity)
+                && entry.lastUpdate < time;
+        };
+
+    // The scores are kept in memory. They are removed again once the
+    // job is done, in case they were updated in the meantime
+    ResourceScoreStore::self()->removeIf(removedScores);
+
+    return m_statsDeletion->schedule(steps, [=] {
+        removeScores(removedScores, filters.scores, values);
+
+        // The deleted events have left free pages in the database
+        m_maintenance->scheduleMaintenance();
+
+        finished();
+    });
 }
 
 void StatsPlugin::DeleteStatsForResource(const QString &activity,
@@ -566,47 +764,236 @@ void StatsPlugin::DeleteStatsForResource(const QString &activity,
 
     DATABASE_TRANSACTION(*resourcesDatabase());
 
-    // Check against sql injection
-    if (activity.contains('\'') || client.contains('\'')) return;
-
-    const auto activityFilter =
-            activity == ANY_ACTIVITY_TAG ? " 1 " :
-                QStringLiteral(" usedActivity = '%1' ").arg(
-                    activity == CURRENT_ACTIVITY_TAG ?
-                            currentActivity() : activity
-                );
-
-    const auto clientFilter =
-            client == ANY_AGENT_TAG ? " 1 " :
-                QStringLiteral(" initiatingAgent = '%1' ").arg(client);
-
-    auto removeEventsQuery = resourcesDatabase()->createQuery();
-    removeEventsQuery.prepare(
-            "DELETE FROM ResourceEvent "
-            "WHERE "
-                + activityFilter + " AND "
-                + clientFilter + " AND "
-                + "targettedResource LIKE :targettedResource ESCAPE '\\'"
-        );
+    const auto usedActivity =
+            activity == ANY_ACTIVITY_TAG ? QVariant() :
+            activity == CURRENT_ACTIVITY_TAG ? QVariant(currentActivity()) :
+                                                QVariant(activity);
+
+    const auto initiatingAgent =
+            client == ANY_AGENT_TAG ? QVariant() : QVariant(client);
+
+    const Common::StarPattern pattern(resource);
+
+    switch (pattern.type()) {
+        case Common::StarPattern::Exact:
+            deleteResourceStats(usedActivity, initiatingAgent, pattern.prefix());
+            break;
+
+        case Common::StarPattern::Prefix:
+            deleteResourceStats(usedActivity, initiatingAgent, pattern.prefix(),
+                                pattern.prefixSuccessor());
+            break;
+
+        case Common::StarPattern::Glob:
+        {
+            // We are checking the pattern against the known resources
+            // instead of making SQLite scan all the tables with LIKE.
+            // The literal prefix of the pattern limits the resources
+            // we need to check. The resources are ordered ignoring
+            // the ASCII case, so the ones that start with the prefix
+            // are next to each other
+            loadKnownResources();
+
+            const auto prefix = pattern.prefix();
+            QStringList matchingResources;
+
+            auto it = std::lower_bound(m_knownResources.begin(), m_knownResources.end(),
+                    prefix, [] (const QString &resource, const QString &prefix) {
+                        return Common::compareIgnoringAsciiCase(resource, prefix) < 0;
+                    });
+
+            for (; it != m_knownResources.end()
+                    && Common::compareIgnoringAsciiCase(it->left(prefix.size()), prefix) == 0;
+                    ++it) {
+                if (pattern.matches(*it)) {
+                    matchingResources << *it;
+                }
+            }
+
+            for (const auto &matchingResource: matchingResources) {
+                deleteResourceStats(usedActivity, initiatingAgent, matchingResource);
+
+                // Other activities and agents might still use the resource
+                if (usedActivity.isNull() && initiatingAgent.isNull()) {
+                    m_knownResources.erase(matchingResource);
+                }
+            }
+
+            break;
+        }
+    }
 
-    auto removeScoreCachesQuery = resourcesDatabase()->createQuery();
-    removeScoreCachesQuery.prepare(
-            "DELETE FROM ResourceScoreCache "
-            "WHERE "
-                + activityFilter + " AND "
-                + clientFilter + " AND "
-                + "targettedResource LIKE :targettedResource ESCAPE '\\'"
-        );
+    // The predicate might be kept until the scores are loaded
+    ResourceScoreStore::self()->removeIf(
+        [usedActivity, initiatingAgent, pattern] (const ResourceScoreStore::Key &key,
+                                                  const ResourceScoreStore::Entry &) {
+            return (usedActivity.isNull() || key.activity == usedActivity.toString())
+                && (initiatingAgent.isNull() || key.agent == initiatingAgent.toString())
+                && pattern.matches(key.resource);
+        });
+
+    m_focusTime->discardIf(
+        [usedActivity, initiatingAgent, pattern] (const ResourceFocusTime::Key &key) {
+            return (usedActivity.isNull() || key.activity == usedActivity.toString())
+                && (initiatingAgent.isNull() || key.agent == initiatingAgent.toString())
+                && pattern.matches(key.resource);
+        });
+
+    m_editTracker->discardIf(
+        [usedActivity, initiatingAgent, pattern] (const ResourceEditTracker::Key &key) {
+            return (usedActivity.isNull() || key.activity == usedActivity.toString())
+                && (initiatingAgent.isNull() || key.agent == initiatingAgent.toString())
+                && pattern.matches(key.resource);
+        });
+
+    // The deleted events have left free pages in the database
+    m_maintenance->scheduleMaintenance();
 
-    const auto pattern = Common::starPatternToLike(resource);
+    emit ResourceScoreDeleted(activity, client, resource);
+}
 
-    Utils::exec(*resourcesDatabase(), Utils::FailOnError, removeEventsQuery,
-                ":targettedResource", pattern);
+bool StatsPlugin::ExportDatabase(const QString &path)
+{
+    // The focus time might not have been written to the database yet
+    m_focusTime->flush();
+
+    // The open edit sessions are exported as if they ended now,
+    // but they stay open, so that they are not counted twice
+    return ResourcesDatabaseExport::exportTo(path, [this] {
+        m_editTracker->saveOpenSessions();
+    });
+}
 
-    Utils::exec(*resourcesDatabase(), Utils::FailOnError, removeScoreCachesQuery,
-                ":targettedResource", pattern);
+bool StatsPlugin::ImportDatabase(const QString &path)
+{
+    const bool result = ResourcesDatabaseExport::importFrom(path);
 
-    emit ResourceScoreDeleted(activity, client, resource);
+    // The imported events might contain resources we have not seen
+    m_knownResourcesLoaded = false;
+    m_knownResources.clear();
+
+    return result;
+}
+
+void StatsPlugin::deleteResourceStats(const QVariant &usedActivity,
+                                      const QVariant &initiatingAgent,
+                                      const QString &resource,
+                                      const QString &resourceSuccessor)
+{
+    // Without the successor, we are deleting a single resource,
+    // otherwise all the resources in [resource, resourceSuccessor).
+    // The resources are compared ignoring the case of ASCII letters,
+    // like the LIKE conditions that were used before. The indices
+    // on targettedResource use the same collation.
+    const bool isRange = !resourceSuccessor.isNull();
+
+    const auto filters = Statements::deleteResourceFilters(isRange);
+
+    auto exec = [&] (QSqlQuery &query) {
+        query.bindValue(QStringLiteral(":usedActivity"), usedActivity);
+        query.bindValue(QStringLiteral(":initiatingAgent"), initiatingAgent);
+        query.bindValue(QStringLiteral(":resource"), resource);
+
+        if (isRange) {
+            query.bindValue(QStringLiteral(":resourceSuccessor"), resourceSuccessor);
+        }
+
+        Utils::exec(*resourcesDatabase(), Utils::FailOnError, query);
+    };
+
+    auto partitions = ResourceEventPartitions::self();
+
+    // The %1 is replaced with the partition name by the query cache
+    for (const auto &partition: partitions->partitions()) {
+        exec(partitions->query(partition,
+                Statements::deleteRows(QStringLiteral("%1"), filters.events)));
+    }
+
+    auto &deleteDailyEventsQuery =
+            isRange ? deleteResourceRangeDailyEventsQuery : deleteResourceDailyEventsQuery;
+    Utils::prepare(*resourcesDatabase(), deleteDailyEventsQuery,
+            Statements::deleteRows(QStringLiteral("ResourceEventDaily"), filters.dailyEvents));
+    exec(*deleteDailyEventsQuery);
+
+    auto &deleteFocusQuery =
+            isRange ? deleteResourceRangeFocusQuery : deleteResourceFocusQuery;
+    Utils::prepare(*resourcesDatabase(), deleteFocusQuery,
+            Statements::deleteRows(QStringLiteral("ResourceFocusDaily"), filters.focusDaily));
+    exec(*deleteFocusQuery);
+
+    auto &deleteEditsQuery =
+            isRange ? deleteResourceRangeEditsQuery : deleteResourceEditsQuery;
+    Utils::prepare(*resourcesDatabase(), deleteEditsQuery,
+            Statements::deleteRows(QStringLiteral("ResourceEditStats"), filters.editStats));
+    exec(*deleteEditsQuery);
+
+    auto &deleteScoreCachesQuery =
+            isRange ? deleteResourceRangeScoreCachesQuery : deleteResourceScoreCachesQuery;
+    Utils::prepare(*resourcesDatabase(), deleteScoreCachesQuery,
+            Statements::deleteRows(QStringLiteral("ResourceScoreCache"), filters.scores));
+    exec(*deleteScoreCachesQuery);
+}
+
+void StatsPlugin::removeScores(const ResourceScoreStore::Predicate &predicate,
+                               const QString &filter, const QVariantHash &values)
+{
+    // The steps of the deletion job only cover the rows that existed
+    // when they started. The scores that were checkpointed while the
+    // job was running would stay in the database after they are removed
+    // from memory, and would come back after a restart.
+    ResourceScoreStore::self()->removeIf(predicate);
+
+    // The filter depends on the kind of the deletion, and the deletions
+    // are rare, so the query is not cached
+    auto deleteScoresQuery = resourcesDatabase()->createQuery();
+
+    Utils::prepare(*resourcesDatabase(), deleteScoresQuery,
+            Statements::deleteRows(QStringLiteral("ResourceScoreCache"), filter));
+
+    for (auto it = values.cbegin(); it != values.cend(); ++it) {
+        deleteScoresQuery.bindValue(it.key(), it.value());
+    }
+
+    Utils::exec(*resourcesDatabase(), Utils::FailOnError, deleteScoresQuery);
+}
+
+void StatsPlugin::rememberResource(const QString &resource)
+{
+    // If the resources are not loaded yet, they will
+    // be read from the database when they are needed
+    if (m_knownResourcesLoaded) {
+        m_knownResources.insert(resource);
+    }
+}
+
+void StatsPlugin::loadKnownResources()
+{
+    if (m_knownResourcesLoaded) {
+        return;
+    }
+
+    // These are the tables the stats are deleted from. ResourceLink
+    // and ResourceInfo are not included, DeleteStatsForResource does
+    // not touch them, and the resources that only appear there
+    // will not be matched against the glob patterns
+    auto query = resourcesDatabase()->execQuery(QStringLiteral(
+            "SELECT targettedResource FROM ResourceEvent "
+            "UNION SELECT targettedResource FROM ResourceEventDaily "
+            "UNION SELECT targettedResource FROM ResourceFocusDaily "
+            "UNION SELECT targettedResource FROM ResourceEditStats "
+            "UNION SELECT targettedResource FROM ResourceScoreCache"));
+
+    std::vector<QString> resources;
+    while (query.next()) {
+        resources.push_back(query.value(0).toString());
+    }
+
+    // The results of UNION are unique, but not necessarily sorted,
+    // and SQLite does not compare the strings the way QString does
+    std::sort(resources.begin(), resources.end(), m_knownResources.value_comp());
+    m_knownResources.insert(boost::container::ordered_unique_range,
+                            resources.begin(), resources.end());
+    m_knownResourcesLoaded = true;
 }
 
 bool StatsPlugin::isFeatureOperational(const QStringList &feature) const
@@ -621,6 +1008,15 @@ bool StatsPlugin::isFeatureOperational(const QStringList &feature) const
             || listActivities().contains(activity);
 
         return true;
+
+    } else if (feature[0] == "maintenance") {
+        return true;
+
+    } else if (feature[0] == "database") {
+        return true;
+
+    } else if (feature[0] == "topScores") {
+        return ResourceScoreStore::self()->isLoaded();
     }
 
     return false;
@@ -674,6 +1070,68 @@ QDBusVariant StatsPlugin::featureValue(const QStringList &feature) const
         }
 
         return QDBusVariant(m_otrActivities.contains(activity));
+
+    } else if (feature[0] == "maintenance") {
+        if (feature.size() != 2) return QDBusVariant(false);
+
+        const auto &metric = feature[1];
+
+        if (metric == "running") {
+            return QDBusVariant(m_maintenance->isRunning());
+
+        } else if (metric == "freePages") {
+            return QDBusVariant(m_maintenance->freePages());
+
+        } else if (metric == "reclaimedPages") {
+            return QDBusVariant(m_maintenance->reclaimedPages());
+
+        } else if (metric == "reclaimedBytes") {
+            return QDBusVariant(m_maintenance->reclaimedBytes());
+
+        } else if (metric == "lastAnalyze") {
+            const auto lastAnalyze = m_maintenance->lastAnalyze();
+            return QDBusVariant(lastAnalyze.isValid() ? lastAnalyze.toSecsSinceEpoch() : 0);
+        }
+
+    } else if (feature[0] == "database") {
+        if (feature.size() != 2) return QDBusVariant(false);
+
+        // Reporting the values that are in effect, not the configured ones
+        if (databaseTuningPragmas().contains(feature[1])) {
+            return QDBusVariant(resourcesDatabase()->pragma(feature[1]));
+        }
+
+    } else if (feature[0] == "topScores") {
+        // topScores/<activity>/<agent>/<count>, served from memory
+        if (feature.size() != 4) return QDBusVariant(false);
+
+        auto activity = feature[1];
+        const auto agent = feature[2];
+        const auto count = feature[3].toInt();
+
+        if (activity == CURRENT_ACTIVITY_TAG) {
+            activity = currentActivity();
+        }
+
+        const auto scores = ResourceScoreStore::self()->topScores(count,
+            [&] (const ResourceScoreStore::Key &key, const ResourceScoreStore::Entry &) {
+                return (activity == ANY_ACTIVITY_TAG || key.activity == activity)
+                    && (agent == ANY_AGENT_TAG || key.agent == agent);
+            });
+
+        QVariantList result;
+        for (const auto &score: scores) {
+            result << QVariantMap {
+                { QStringLiteral("activity"),    score.key.activity },
+                { QStringLiteral("agent"),       score.key.agent },
+                { QStringLiteral("resource"),    score.key.resource },
+                { QStringLiteral("score"),       score.entry.score },
+                { QStringLiteral("firstUpdate"), score.entry.firstUpdate },
+                { QStringLiteral("lastUpdate"),  score.entry.lastUpdate }
+            };
+        }
+
+        return QDBusVariant(result);
     }
 
     return QDBusVariant(false);
@@ -710,10 +1168,17 @@ void StatsPlugin::setFeatureValue(const QStringList &feature, const QDBusVariant
 QStringList StatsPlugin::listFeatures(const QStringList &feature) const
 {
     if (feature.isEmpty() || feature[0].isEmpty()) {
-        return { "isOTR/" };
+        return { "isOTR/", "maintenance/", "database/", "topScores/" };
 
     } else if (feature[0] == "isOTR") {
         return listActivities();
+
+    } else if (feature[0] == "maintenance") {
+        return { "running", "freePages", "reclaimedPages",
+                 "reclaimedBytes", "lastAnalyze" };
+
+    } else if (feature[0] == "database") {
+        return databaseTuningPragmas();
     }
 
     return QStringList();
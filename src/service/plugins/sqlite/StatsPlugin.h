@@ -25,12 +25,20 @@
 
 // Boost and STL
 #include <memory>
+#include <functional>
 #include <boost/container/flat_set.hpp>
 
 // Local
 #include <Plugin.h>
+#include <common/database/Database.h>
+#include "ResourceScoreStore.h"
 
 class ResourceLinking;
+class ResourceEventRollup;
+class ResourceFocusTime;
+class ResourceEditTracker;
+class ResourcesDatabaseMaintenance;
+class ResourceStatsDeletion;
 
 /**
  * Communication with the outer world.
@@ -68,15 +76,22 @@ public:
 //
 
 public Q_SLOTS:
-    void DeleteRecentStats(const QString &activity, int count,
+    // The bulk deletions are executed in the background, these return
+    // the id of the deletion job which is reported by StatsDeletionProgress
+    uint DeleteRecentStats(const QString &activity, int count,
                            const QString &what);
 
-    void DeleteEarlierStats(const QString &activity, int months);
+    uint DeleteEarlierStats(const QString &activity, int months);
 
+    // The resource is a star pattern, matched ignoring
+    // the case of ASCII letters
     void DeleteStatsForResource(const QString &activity,
                                 const QString &client,
                                 const QString &resource);
 
+    bool ExportDatabase(const QString &path);
+    bool ImportDatabase(const QString &path);
+
 Q_SIGNALS:
     void ResourceScoreUpdated(const QString &activity, const QString &client,
                               const QString &resource, double score,
@@ -89,6 +104,10 @@ Q_SIGNALS:
 
     void EarlierStatsDeleted(const QString &activity, int months);
 
+    void DatabaseBackupFinished(bool success);
+
+    void StatsDeletionProgress(uint job, double progress);
+
 //
 // End D-BUS Interface methods
 //
@@ -122,6 +141,18 @@ private:
     inline bool acceptedEvent(const Event &event);
     inline Event validateEvent(Event event);
 
+    void deleteResourceStats(const QVariant &usedActivity,
+                             const QVariant &initiatingAgent,
+                             const QString &resource,
+                             const QString &resourceSuccessor = QString());
+    void loadKnownResources();
+    void rememberResource(const QString &resource);
+    void removeScores(const ResourceScoreStore::Predicate &predicate,
+                      const QString &filter, const QVariantHash &values);
+
+    uint deleteEarlierStats(const QString &activity, int months,
+                            const std::function<void()> &finished);
+
 
     enum WhatToRemember {
         AllApplications = 0,
@@ -136,13 +167,18 @@ private:
     QList<QRegExp> m_urlFilters;
     QStringList m_otrActivities;
 
-    std::unique_ptr<QSqlQuery> openResourceEventQuery;
-    std::unique_ptr<QSqlQuery> closeResourceEventQuery;
-
     std::unique_ptr<QSqlQuery> insertResourceInfoQuery;
     std::unique_ptr<QSqlQuery> getResourceInfoQuery;
     std::unique_ptr<QSqlQuery> saveResourceTitleQuery;
     std::unique_ptr<QSqlQuery> saveResourceMimetypeQuery;
+    std::unique_ptr<QSqlQuery> deleteResourceDailyEventsQuery;
+    std::unique_ptr<QSqlQuery> deleteResourceRangeDailyEventsQuery;
+    std::unique_ptr<QSqlQuery> deleteResourceScoreCachesQuery;
+    std::unique_ptr<QSqlQuery> deleteResourceRangeScoreCachesQuery;
+    std::unique_ptr<QSqlQuery> deleteResourceFocusQuery;
+    std::unique_ptr<QSqlQuery> deleteResourceRangeFocusQuery;
+    std::unique_ptr<QSqlQuery> deleteResourceEditsQuery;
+    std::unique_ptr<QSqlQuery> deleteResourceRangeEditsQuery;
 
     QTimer m_deleteOldEventsTimer;
 
@@ -151,6 +187,18 @@ private:
     WhatToRemember m_whatToRemember : 2;
 
     ResourceLinking *m_resourceLinking;
+    ResourceEventRollup *m_eventRollup;
+    ResourceFocusTime *m_focusTime;
+    ResourceEditTracker *m_editTracker;
+    ResourcesDatabaseMaintenance *m_maintenance;
+    ResourceStatsDeletion *m_statsDeletion;
+
+    // Resources that have been used, loaded only when needed
+    // for deleting the stats for a glob pattern. The glob patterns
+    // ignore the case of ASCII letters, and so does the order of the set.
+    // See loadKnownResources for the tables the resources come from.
+    bool m_knownResourcesLoaded;
+    boost::container::flat_set<QString, Common::AsciiCaseInsensitiveLess> m_knownResources;
 
     static StatsPlugin *s_instance;
 };
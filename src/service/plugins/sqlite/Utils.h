@@ -22,10 +22,12 @@
 
 #include <QSqlQuery>
 #include <QSqlError>
+#include <QElapsedTimer>
 #include <common/database/schema/ResourcesDatabaseSchema.h>
 #include <memory>
 
 #include "DebugResources.h"
+#include "QueryStatistics.h"
 
 namespace Utils {
 
@@ -60,8 +62,13 @@ namespace Utils {
 
     inline bool exec(Common::Database &database, ErrorHandling eh, QSqlQuery &query)
     {
+        QElapsedTimer timer;
+        timer.start();
+
         bool success = query.exec();
 
+        QueryStatistics::record(query, timer.nsecsElapsed());
+
         if (eh == FailOnError) {
             if ((!success) && (errorCount++ < 2)) {
                 qCWarning(KAMD_LOG_RESOURCES) << query.lastQuery();
@@ -0,0 +1,127 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UTILS_LATENCY_HISTOGRAM_H
+#define UTILS_LATENCY_HISTOGRAM_H
+
+#include <QtGlobal>
+#include <QtAlgorithms>
+
+#include <algorithm>
+#include <array>
+
+namespace kamd {
+namespace utils {
+
+/**
+ * Histogram with log-linear buckets, in the spirit of the HDR histograms.
+ *
+ * The values smaller than sub_bucket_count are recorded exactly, and
+ * each following power of two is split into sub_bucket_count buckets,
+ * which means that the recorded values have the relative precision
+ * of 1 / sub_bucket_count, with a fixed memory footprint.
+ */
+class latency_histogram {
+public:
+    enum {
+        sub_bucket_bits  = 3,
+        sub_bucket_count = 1 << sub_bucket_bits,
+        bucket_count     = sub_bucket_count * (64 - sub_bucket_bits + 1)
+    };
+
+    latency_histogram()
+        : m_count(0)
+        , m_total(0)
+        , m_max(0)
+    {
+        m_buckets.fill(0);
+    }
+
+    void record(quint64 value)
+    {
+        ++m_buckets[bucket_index(value)];
+        ++m_count;
+        m_total += value;
+        m_max = std::max(m_max, value);
+    }
+
+    quint64 count() const { return m_count; }
+    quint64 total() const { return m_total; }
+    quint64 max()   const { return m_max; }
+
+    /**
+     * Returns the (upper bound of the) value below which
+     * the specified fraction (0 to 1) of the recorded values fall
+     */
+    quint64 percentile(double fraction) const
+    {
+        if (m_count == 0) {
+            return 0;
+        }
+
+        const quint64 wanted = std::max<quint64>(1, quint64(fraction * m_count + 0.5));
+        quint64 seen = 0;
+
+        for (int i = 0; i < bucket_count; ++i) {
+            seen += m_buckets[i];
+            if (seen >= wanted) {
+                return std::min(bucket_upper_bound(i), m_max);
+            }
+        }
+
+        return m_max;
+    }
+
+private:
+    static int bucket_index(quint64 value)
+    {
+        if (value < sub_bucket_count) {
+            return int(value);
+        }
+
+        const int msb = 63 - qCountLeadingZeroBits(value);
+        const int shift = msb - sub_bucket_bits;
+        const int sub_bucket = int(value >> shift) & (sub_bucket_count - 1);
+
+        return sub_bucket_count * (shift + 1) + sub_bucket;
+    }
+
+    static quint64 bucket_upper_bound(int index)
+    {
+        if (index < sub_bucket_count) {
+            return quint64(index);
+        }
+
+        const int shift = index / sub_bucket_count - 1;
+        const quint64 sub_bucket = quint64(index % sub_bucket_count);
+
+        return ((sub_bucket_count + sub_bucket + 1) << shift) - 1;
+    }
+
+    std::array<quint64, bucket_count> m_buckets;
+    quint64 m_count;
+    quint64 m_total;
+    quint64 m_max;
+};
+
+} // namespace utils
+} // namespace kamd
+
+#endif // UTILS_LATENCY_HISTOGRAM_H
@@ -0,0 +1,78 @@
+/*
+ *   Copyright (C) 2026 KActivities contributors
+ *
+ *   This program is free software; you can redistribute it and/or
+ *   modify it under the terms of the GNU General Public License as
+ *   published by the Free Software Foundation; either version 2 of
+ *   the License or (at your option) version 3 or any later version
+ *   accepted by the membership of KDE e.V. (or its successor approved
+ *   by the membership of KDE e.V.), which shall act as a proxy
+ *   defined in Section 14 of version 3 of the license.
+ *
+ *   This program is distributed in the hope that it will be useful,
+ *   but WITHOUT ANY WARRANTY; without even the implied warranty of
+ *   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ *   GNU General Public License for more details.
+ *
+ *   You should have received a copy of the GNU General Public License
+ *   along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef UTILS_STRING_POOL_H
+#define UTILS_STRING_POOL_H
+
+#include <QSet>
+#include <QString>
+
+namespace kamd {
+namespace utils {
+
+/**
+ * Interns the strings, so that the equal ones share their data.
+ *
+ * Each string that comes in a D-Bus message has its own copy of the
+ * data, even when the same few application names and resources are
+ * sent over and over. The pool returns the copy it already knows,
+ * and the one that came with the message can be released.
+ *
+ * The pool is emptied when it is full. The strings that are still
+ * in use somewhere else are not affected by that.
+ */
+class string_pool {
+public:
+    explicit string_pool(int capacity = 4096)
+        : m_capacity(capacity)
+    {
+    }
+
+    QString intern(const QString &value)
+    {
+        const auto it = m_strings.constFind(value);
+
+        if (it != m_strings.cend()) {
+            return *it;
+        }
+
+        if (m_strings.size() >= m_capacity) {
+            m_strings.clear();
+        }
+
+        m_strings.insert(value);
+
+        return value;
+    }
+
+    const QSet<QString> &strings() const
+    {
+        return m_strings;
+    }
+
+private:
+    QSet<QString> m_strings;
+    int m_capacity;
+};
+
+} // namespace utils
+} // namespace kamd
+
+#endif // UTILS_STRING_POOL_H